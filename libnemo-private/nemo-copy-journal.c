@@ -0,0 +1,697 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   nemo-copy-journal.c: Progress records of long copy and move jobs.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street - Suite 500,
+   Boston, MA 02110-1335, USA.
+*/
+
+#include <config.h>
+#include "nemo-copy-journal.h"
+
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* A journal is a text file, one record per line, only ever appended to:
+ *
+ *   icarus-fm copy journal 1
+ *   operation copy|move
+ *   destination <uri>
+ *   source <uri>                 once per file the user picked
+ *   created <src uri> <dest uri> the job created dest
+ *   replaced <src uri> <dest uri> the user chose to replace dest
+ *   partial <src uri> <offset> <src size> <src mtime> <dest mtime>
+ *                                bytes of the last created dest on disk
+ *   done <src uri> <size>
+ *   skipped <src uri>
+ *   all skip|replace|merge|auto-rename
+ *
+ * URIs are escaped, so they never contain spaces or newlines. A line
+ * cut short by a crash is ignored.
+ */
+
+#define JOURNAL_MAGIC "icarus-fm copy journal 1"
+
+/* Records other than partial offsets and user decisions may be lost if
+ * we crash within this many microseconds of writing them.
+ */
+#define JOURNAL_FLUSH_INTERVAL G_USEC_PER_SEC
+
+/* Journals nobody resumed for this long are deleted, in seconds */
+#define JOURNAL_MAX_AGE (14 * 24 * 60 * 60)
+
+typedef struct {
+	char *created;
+	char *replaced;
+	goffset partial;
+	goffset src_size;
+	gint64 src_mtime;
+	gint64 dest_mtime;
+	goffset size;
+	guint has_partial : 1;
+	guint done : 1;
+	guint skipped : 1;
+} JournalEntry;
+
+struct NemoCopyJournal {
+	char *path;
+	GMutex mutex; /* copy workers write records too */
+	FILE *file;
+	gint64 last_flush;
+	gboolean is_move;
+	GList *sources;
+	GFile *destination;
+	guint apply_to_all;
+	GHashTable *entries; /* source uri -> JournalEntry, as of opening */
+};
+
+static const struct {
+	NemoCopyJournalApplyToAll flag;
+	const char *name;
+} apply_to_all_names[] = {
+	{ NEMO_COPY_JOURNAL_SKIP_ALL, "skip" },
+	{ NEMO_COPY_JOURNAL_REPLACE_ALL, "replace" },
+	{ NEMO_COPY_JOURNAL_MERGE_ALL, "merge" },
+	{ NEMO_COPY_JOURNAL_AUTO_RENAME_ALL, "auto-rename" },
+};
+
+static char *
+get_journal_dir (void)
+{
+	return g_build_filename (g_get_user_cache_dir (),
+				 "icarus-fm", "copy-journals", NULL);
+}
+
+static void
+journal_entry_free (JournalEntry *entry)
+{
+	g_free (entry->created);
+	g_free (entry->replaced);
+	g_free (entry);
+}
+
+static NemoCopyJournal *
+journal_new (const char *path)
+{
+	NemoCopyJournal *journal;
+
+	journal = g_new0 (NemoCopyJournal, 1);
+	journal->path = g_strdup (path);
+	g_mutex_init (&journal->mutex);
+	journal->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+						  g_free, (GDestroyNotify) journal_entry_free);
+
+	return journal;
+}
+
+static void
+journal_free (NemoCopyJournal *journal)
+{
+	if (journal->file != NULL) {
+		/* Also drops the lock */
+		fclose (journal->file);
+	}
+
+	g_list_free_full (journal->sources, g_object_unref);
+	g_clear_object (&journal->destination);
+	g_hash_table_destroy (journal->entries);
+	g_mutex_clear (&journal->mutex);
+	g_free (journal->path);
+	g_free (journal);
+}
+
+static void
+journal_flush (NemoCopyJournal *journal,
+	       gboolean         force)
+{
+	gint64 now;
+
+	now = g_get_monotonic_time ();
+
+	if (force || now - journal->last_flush >= JOURNAL_FLUSH_INTERVAL) {
+		fflush (journal->file);
+		journal->last_flush = now;
+	}
+}
+
+static void
+journal_write (NemoCopyJournal *journal,
+	       gboolean         force_flush,
+	       const char      *format,
+	       ...)
+{
+	va_list args;
+
+	g_mutex_lock (&journal->mutex);
+
+	va_start (args, format);
+	vfprintf (journal->file, format, args);
+	va_end (args);
+
+	journal_flush (journal, force_flush);
+
+	g_mutex_unlock (&journal->mutex);
+}
+
+static JournalEntry *
+get_entry (NemoCopyJournal *journal,
+	   const char      *uri)
+{
+	JournalEntry *entry;
+
+	entry = g_hash_table_lookup (journal->entries, uri);
+	if (entry == NULL) {
+		entry = g_new0 (JournalEntry, 1);
+		g_hash_table_insert (journal->entries, g_strdup (uri), entry);
+	}
+
+	return entry;
+}
+
+static JournalEntry *
+lookup_entry (NemoCopyJournal *journal,
+	      GFile           *src)
+{
+	JournalEntry *entry;
+	char *uri;
+
+	uri = g_file_get_uri (src);
+	entry = g_hash_table_lookup (journal->entries, uri);
+	g_free (uri);
+
+	return entry;
+}
+
+static void
+parse_record (NemoCopyJournal *journal,
+	      char           **fields)
+{
+	JournalEntry *entry;
+	guint n_fields, i;
+
+	n_fields = g_strv_length (fields);
+	if (n_fields < 2) {
+		return;
+	}
+
+	if (strcmp (fields[0], "operation") == 0) {
+		journal->is_move = strcmp (fields[1], "move") == 0;
+	} else if (strcmp (fields[0], "destination") == 0) {
+		g_clear_object (&journal->destination);
+		journal->destination = g_file_new_for_uri (fields[1]);
+	} else if (strcmp (fields[0], "source") == 0) {
+		journal->sources = g_list_prepend (journal->sources,
+						   g_file_new_for_uri (fields[1]));
+	} else if (strcmp (fields[0], "skipped") == 0) {
+		get_entry (journal, fields[1])->skipped = TRUE;
+	} else if (strcmp (fields[0], "all") == 0) {
+		for (i = 0; i < G_N_ELEMENTS (apply_to_all_names); i++) {
+			if (strcmp (fields[1], apply_to_all_names[i].name) == 0) {
+				journal->apply_to_all |= apply_to_all_names[i].flag;
+			}
+		}
+	} else if (n_fields < 3) {
+		return;
+	} else if (strcmp (fields[0], "created") == 0) {
+		entry = get_entry (journal, fields[1]);
+		g_free (entry->created);
+		entry->created = g_strdup (fields[2]);
+		entry->partial = 0;
+		entry->has_partial = FALSE;
+	} else if (strcmp (fields[0], "replaced") == 0) {
+		entry = get_entry (journal, fields[1]);
+		g_free (entry->replaced);
+		entry->replaced = g_strdup (fields[2]);
+	} else if (strcmp (fields[0], "partial") == 0) {
+		char *end;
+
+		entry = get_entry (journal, fields[1]);
+		entry->partial = g_ascii_strtoll (fields[2], &end, 10);
+		entry->src_size = g_ascii_strtoll (end, &end, 10);
+		entry->src_mtime = g_ascii_strtoll (end, &end, 10);
+		entry->dest_mtime = g_ascii_strtoll (end, NULL, 10);
+		entry->has_partial = TRUE;
+	} else if (strcmp (fields[0], "done") == 0) {
+		entry = get_entry (journal, fields[1]);
+		entry->done = TRUE;
+		entry->size = g_ascii_strtoll (fields[2], NULL, 10);
+	}
+}
+
+static gboolean
+parse_journal (NemoCopyJournal *journal,
+	       const char      *contents)
+{
+	char **lines, **fields;
+	guint n_lines, i;
+
+	lines = g_strsplit (contents, "\n", -1);
+	n_lines = g_strv_length (lines);
+
+	if (n_lines < 2 || strcmp (lines[0], JOURNAL_MAGIC) != 0) {
+		g_strfreev (lines);
+		return FALSE;
+	}
+
+	/* The last piece is either empty or a record we didn't finish writing */
+	for (i = 1; i + 1 < n_lines; i++) {
+		fields = g_strsplit (lines[i], " ", 3);
+		parse_record (journal, fields);
+		g_strfreev (fields);
+	}
+
+	g_strfreev (lines);
+
+	journal->sources = g_list_reverse (journal->sources);
+
+	return journal->destination != NULL && journal->sources != NULL;
+}
+
+NemoCopyJournal *
+nemo_copy_journal_new (gboolean  is_move,
+		       GList    *sources,
+		       GFile    *destination)
+{
+	static guint counter = 0;
+	NemoCopyJournal *journal;
+	char *dir, *name, *path, *uri;
+	GList *l;
+	int fd;
+
+	dir = get_journal_dir ();
+	if (g_mkdir_with_parents (dir, 0700) != 0) {
+		g_free (dir);
+		return NULL;
+	}
+
+	name = g_strdup_printf ("%" G_GINT64_FORMAT "-%d-%u.journal",
+				g_get_real_time (), (int) getpid (),
+				(guint) g_atomic_int_add (&counter, 1));
+	path = g_build_filename (dir, name, NULL);
+	g_free (name);
+	g_free (dir);
+
+	fd = g_open (path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (fd < 0 || flock (fd, LOCK_EX | LOCK_NB) != 0) {
+		if (fd >= 0) {
+			close (fd);
+		}
+		g_free (path);
+		return NULL;
+	}
+
+	journal = journal_new (path);
+	g_free (path);
+
+	journal->file = fdopen (fd, "a");
+	if (journal->file == NULL) {
+		close (fd);
+		g_unlink (journal->path);
+		journal_free (journal);
+		return NULL;
+	}
+
+	journal->is_move = is_move;
+	journal->sources = g_list_copy_deep (sources, (GCopyFunc) g_object_ref, NULL);
+	journal->destination = g_object_ref (destination);
+
+	uri = g_file_get_uri (destination);
+	fprintf (journal->file, "%s\noperation %s\ndestination %s\n",
+		 JOURNAL_MAGIC, is_move ? "move" : "copy", uri);
+	g_free (uri);
+
+	for (l = sources; l != NULL; l = l->next) {
+		uri = g_file_get_uri (l->data);
+		fprintf (journal->file, "source %s\n", uri);
+		g_free (uri);
+	}
+
+	journal_flush (journal, TRUE);
+
+	return journal;
+}
+
+GList *
+nemo_copy_journal_list_pending (void)
+{
+	NemoCopyJournal *journal;
+	GList *paths;
+	GDir *dir;
+	const char *name;
+	char *dir_path, *path;
+	GStatBuf buf;
+	gint64 now;
+
+	dir_path = get_journal_dir ();
+	dir = g_dir_open (dir_path, 0, NULL);
+	if (dir == NULL) {
+		g_free (dir_path);
+		return NULL;
+	}
+
+	paths = NULL;
+	now = g_get_real_time () / G_USEC_PER_SEC;
+
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		if (!g_str_has_suffix (name, ".journal")) {
+			continue;
+		}
+
+		path = g_build_filename (dir_path, name, NULL);
+
+		if (g_stat (path, &buf) == 0 && now - buf.st_mtime > JOURNAL_MAX_AGE) {
+			/* Skips journals of jobs still running elsewhere. Nobody
+			 * asked us to, so the files stay where they are.
+			 */
+			journal = nemo_copy_journal_open (path);
+			if (journal != NULL) {
+				nemo_copy_journal_discard (journal);
+			}
+			g_free (path);
+			continue;
+		}
+
+		paths = g_list_prepend (paths, path);
+	}
+
+	g_dir_close (dir);
+	g_free (dir_path);
+
+	/* Names start with the creation time */
+	return g_list_sort (paths, (GCompareFunc) g_strcmp0);
+}
+
+NemoCopyJournal *
+nemo_copy_journal_open (const char *path)
+{
+	NemoCopyJournal *journal;
+	char *contents;
+	gsize length;
+	int fd;
+
+	fd = g_open (path, O_WRONLY | O_APPEND | O_CLOEXEC, 0);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	/* The job that wrote it may still be running in another process */
+	if (flock (fd, LOCK_EX | LOCK_NB) != 0 ||
+	    !g_file_get_contents (path, &contents, &length, NULL)) {
+		close (fd);
+		return NULL;
+	}
+
+	journal = journal_new (path);
+
+	if (!parse_journal (journal, contents) ||
+	    (journal->file = fdopen (fd, "a")) == NULL) {
+		close (fd);
+		journal_free (journal);
+		g_free (contents);
+		return NULL;
+	}
+
+	/* Start our records on a line of their own */
+	if (length > 0 && contents[length - 1] != '\n') {
+		journal_write (journal, TRUE, "\n");
+	}
+
+	g_free (contents);
+
+	return journal;
+}
+
+void
+nemo_copy_journal_close (NemoCopyJournal *journal)
+{
+	journal_free (journal);
+}
+
+void
+nemo_copy_journal_discard (NemoCopyJournal *journal)
+{
+	/* Unlink while we still hold the lock, nobody may pick it up */
+	g_unlink (journal->path);
+	journal_free (journal);
+}
+
+void
+nemo_copy_journal_abandon (NemoCopyJournal *journal)
+{
+	GHashTableIter iter;
+	JournalEntry *entry;
+	gpointer value;
+	char *path;
+	GStatBuf buf;
+	gint64 mtime;
+
+	g_hash_table_iter_init (&iter, journal->entries);
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		entry = value;
+
+		/* Folders may hold finished files, and were never checkpointed */
+		if (entry->created == NULL || entry->done || !entry->has_partial) {
+			continue;
+		}
+
+		path = g_filename_from_uri (entry->created, NULL, NULL);
+		if (path == NULL) {
+			continue;
+		}
+
+		/* Leave it alone if anything wrote to it since the checkpoint,
+		 * including the job itself before it crashed.
+		 */
+		if (g_lstat (path, &buf) == 0 && S_ISREG (buf.st_mode)) {
+			mtime = (gint64) buf.st_mtim.tv_sec * G_USEC_PER_SEC + buf.st_mtim.tv_nsec / 1000;
+			if (buf.st_size == entry->partial && mtime == entry->dest_mtime) {
+				g_unlink (path);
+			}
+		}
+		g_free (path);
+	}
+
+	nemo_copy_journal_discard (journal);
+}
+
+gboolean
+nemo_copy_journal_is_move (NemoCopyJournal *journal)
+{
+	return journal->is_move;
+}
+
+GList *
+nemo_copy_journal_get_sources (NemoCopyJournal *journal)
+{
+	return journal->sources;
+}
+
+GFile *
+nemo_copy_journal_get_destination (NemoCopyJournal *journal)
+{
+	return journal->destination;
+}
+
+guint
+nemo_copy_journal_get_apply_to_all (NemoCopyJournal *journal)
+{
+	return journal->apply_to_all;
+}
+
+gboolean
+nemo_copy_journal_has_record (NemoCopyJournal *journal,
+			      GFile           *src)
+{
+	return lookup_entry (journal, src) != NULL;
+}
+
+gboolean
+nemo_copy_journal_lookup_done (NemoCopyJournal *journal,
+			       GFile           *src,
+			       goffset         *size)
+{
+	JournalEntry *entry;
+
+	entry = lookup_entry (journal, src);
+	if (entry == NULL || !entry->done) {
+		return FALSE;
+	}
+
+	if (size != NULL) {
+		*size = entry->size;
+	}
+
+	return TRUE;
+}
+
+gboolean
+nemo_copy_journal_was_skipped (NemoCopyJournal *journal,
+			       GFile           *src)
+{
+	JournalEntry *entry;
+
+	entry = lookup_entry (journal, src);
+
+	return entry != NULL && entry->skipped;
+}
+
+GFile *
+nemo_copy_journal_lookup_created (NemoCopyJournal *journal,
+				  GFile           *src)
+{
+	JournalEntry *entry;
+
+	entry = lookup_entry (journal, src);
+	if (entry == NULL || entry->created == NULL) {
+		return NULL;
+	}
+
+	return g_file_new_for_uri (entry->created);
+}
+
+gboolean
+nemo_copy_journal_was_replaced (NemoCopyJournal *journal,
+				GFile           *src,
+				GFile           *dest)
+{
+	JournalEntry *entry;
+	char *uri;
+	gboolean ret;
+
+	entry = lookup_entry (journal, src);
+	if (entry == NULL || entry->replaced == NULL) {
+		return FALSE;
+	}
+
+	uri = g_file_get_uri (dest);
+	ret = strcmp (uri, entry->replaced) == 0;
+	g_free (uri);
+
+	return ret;
+}
+
+goffset
+nemo_copy_journal_get_partial (NemoCopyJournal *journal,
+			       GFile           *src,
+			       GFile           *dest,
+			       goffset         *src_size,
+			       gint64          *src_mtime)
+{
+	JournalEntry *entry;
+	char *uri;
+	goffset partial;
+
+	entry = lookup_entry (journal, src);
+	if (entry == NULL || entry->created == NULL || entry->partial <= 0) {
+		return 0;
+	}
+
+	uri = g_file_get_uri (dest);
+	partial = strcmp (uri, entry->created) == 0 ? entry->partial : 0;
+	g_free (uri);
+
+	*src_size = entry->src_size;
+	*src_mtime = entry->src_mtime;
+
+	return partial;
+}
+
+void
+nemo_copy_journal_add_created (NemoCopyJournal *journal,
+			       GFile           *src,
+			       GFile           *dest)
+{
+	char *src_uri, *dest_uri;
+
+	src_uri = g_file_get_uri (src);
+	dest_uri = g_file_get_uri (dest);
+	journal_write (journal, FALSE, "created %s %s\n", src_uri, dest_uri);
+	g_free (dest_uri);
+	g_free (src_uri);
+}
+
+void
+nemo_copy_journal_add_replaced (NemoCopyJournal *journal,
+				GFile           *src,
+				GFile           *dest)
+{
+	char *src_uri, *dest_uri;
+
+	src_uri = g_file_get_uri (src);
+	dest_uri = g_file_get_uri (dest);
+	journal_write (journal, FALSE, "replaced %s %s\n", src_uri, dest_uri);
+	g_free (dest_uri);
+	g_free (src_uri);
+}
+
+void
+nemo_copy_journal_add_partial (NemoCopyJournal *journal,
+			       GFile           *src,
+			       goffset          offset,
+			       goffset          src_size,
+			       gint64           src_mtime,
+			       gint64           dest_mtime)
+{
+	char *uri;
+
+	uri = g_file_get_uri (src);
+	journal_write (journal, TRUE,
+		       "partial %s %" G_GOFFSET_FORMAT " %" G_GOFFSET_FORMAT " %" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n",
+		       uri, offset, src_size, src_mtime, dest_mtime);
+	g_free (uri);
+}
+
+void
+nemo_copy_journal_add_done (NemoCopyJournal *journal,
+			    GFile           *src,
+			    goffset          size)
+{
+	char *uri;
+
+	uri = g_file_get_uri (src);
+	journal_write (journal, FALSE, "done %s %" G_GOFFSET_FORMAT "\n", uri, size);
+	g_free (uri);
+}
+
+void
+nemo_copy_journal_add_skipped (NemoCopyJournal *journal,
+			       GFile           *src)
+{
+	char *uri;
+
+	uri = g_file_get_uri (src);
+	journal_write (journal, TRUE, "skipped %s\n", uri);
+	g_free (uri);
+}
+
+void
+nemo_copy_journal_add_apply_to_all (NemoCopyJournal           *journal,
+				    NemoCopyJournalApplyToAll  flag)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (apply_to_all_names); i++) {
+		if (apply_to_all_names[i].flag == flag) {
+			journal_write (journal, TRUE, "all %s\n", apply_to_all_names[i].name);
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   nemo-copy-journal.h: Progress records of long copy and move jobs.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street - Suite 500,
+   Boston, MA 02110-1335, USA.
+*/
+
+#ifndef NEMO_COPY_JOURNAL_H
+#define NEMO_COPY_JOURNAL_H
+
+#include <gio/gio.h>
+
+/* A journal lives under the user cache for as long as its copy or move
+ * job runs, and stays there if the job is cancelled or never finishes.
+ * It records which files were finished, which destination files the job
+ * created, how far large files got and the user's answers to conflicts,
+ * so the job can be picked up again in a later session.
+ *
+ * Lookups only see what was recorded before the journal was opened,
+ * never what the current run adds. Records can be added from any thread.
+ */
+typedef struct NemoCopyJournal NemoCopyJournal;
+
+typedef enum {
+	NEMO_COPY_JOURNAL_SKIP_ALL = 1 << 0,
+	NEMO_COPY_JOURNAL_REPLACE_ALL = 1 << 1,
+	NEMO_COPY_JOURNAL_MERGE_ALL = 1 << 2,
+	NEMO_COPY_JOURNAL_AUTO_RENAME_ALL = 1 << 3
+} NemoCopyJournalApplyToAll;
+
+/* Returns NULL if the journal can't be written. */
+NemoCopyJournal *nemo_copy_journal_new             (gboolean         is_move,
+						    GList           *sources,
+						    GFile           *destination);
+
+/* Paths of the journals of jobs that didn't finish, oldest first */
+GList *          nemo_copy_journal_list_pending    (void);
+
+/* Returns NULL if the journal can't be read or another job owns it. */
+NemoCopyJournal *nemo_copy_journal_open            (const char      *path);
+
+/* Keeps the journal on disk for a later resume */
+void             nemo_copy_journal_close           (NemoCopyJournal *journal);
+/* Deletes the journal of a finished job */
+void             nemo_copy_journal_discard         (NemoCopyJournal *journal);
+/* Deletes the journal of a job that won't be resumed, and the files
+ * it created but didn't finish, as long as they are still exactly as
+ * the last checkpoint left them.
+ */
+void             nemo_copy_journal_abandon         (NemoCopyJournal *journal);
+
+gboolean         nemo_copy_journal_is_move         (NemoCopyJournal *journal);
+GList *          nemo_copy_journal_get_sources     (NemoCopyJournal *journal);
+GFile *          nemo_copy_journal_get_destination (NemoCopyJournal *journal);
+guint            nemo_copy_journal_get_apply_to_all (NemoCopyJournal *journal);
+
+gboolean         nemo_copy_journal_has_record      (NemoCopyJournal *journal,
+						    GFile           *src);
+gboolean         nemo_copy_journal_lookup_done     (NemoCopyJournal *journal,
+						    GFile           *src,
+						    goffset         *size);
+gboolean         nemo_copy_journal_was_skipped     (NemoCopyJournal *journal,
+						    GFile           *src);
+/* Returns the destination the job created for @src, or NULL */
+GFile *          nemo_copy_journal_lookup_created  (NemoCopyJournal *journal,
+						    GFile           *src);
+/* Whether the user chose to replace @dest with @src */
+gboolean         nemo_copy_journal_was_replaced    (NemoCopyJournal *journal,
+						    GFile           *src,
+						    GFile           *dest);
+/* Returns how many bytes of @dest are known to be on disk, and the
+ * size and mtime (in microseconds) @src had when they were written.
+ */
+goffset          nemo_copy_journal_get_partial     (NemoCopyJournal *journal,
+						    GFile           *src,
+						    GFile           *dest,
+						    goffset         *src_size,
+						    gint64          *src_mtime);
+
+/* Only for destinations the job created itself, never for ones it
+ * replaces.
+ */
+void             nemo_copy_journal_add_created     (NemoCopyJournal *journal,
+						    GFile           *src,
+						    GFile           *dest);
+void             nemo_copy_journal_add_replaced    (NemoCopyJournal *journal,
+						    GFile           *src,
+						    GFile           *dest);
+/* Only call once the first @offset bytes of the destination are synced.
+ * @dest_mtime is the destination's mtime at that point, in microseconds.
+ */
+void             nemo_copy_journal_add_partial     (NemoCopyJournal *journal,
+						    GFile           *src,
+						    goffset          offset,
+						    goffset          src_size,
+						    gint64           src_mtime,
+						    gint64           dest_mtime);
+void             nemo_copy_journal_add_done        (NemoCopyJournal *journal,
+						    GFile           *src,
+						    goffset          size);
+void             nemo_copy_journal_add_skipped     (NemoCopyJournal *journal,
+						    GFile           *src);
+void             nemo_copy_journal_add_apply_to_all (NemoCopyJournal *journal,
+						     NemoCopyJournalApplyToAll flag);
+
+#endif /* NEMO_COPY_JOURNAL_H */
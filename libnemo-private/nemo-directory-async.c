@@ -58,6 +58,20 @@
 /* Keep async. jobs down to this number for all directories. */
 #define MAX_ASYNC_JOBS 10
 
+/* Cached thumbnails being read and decoded at once, per directory.
+ * All of a directory's loads count as a single async. job.
+ */
+#define MAX_THUMBNAIL_LOADS 8
+
+/* Seconds to wait for more thumbnails before writing a directory's atlas,
+ * and the longest a stream of thumbnails can put the write off
+ */
+#define THUMBNAIL_ATLAS_SAVE_DELAY 2
+#define THUMBNAIL_ATLAS_SAVE_MAX_DELAY 30
+
+/* How long a directory load latency sample stays relevant, in microseconds */
+#define LOAD_LATENCY_LIFETIME (2 * G_USEC_PER_SEC)
+
 struct LinkInfoReadState {
 	NemoDirectory *directory;
 	GCancellable *cancellable;
@@ -68,8 +82,12 @@ struct ThumbnailState {
 	NemoDirectory *directory;
 	GCancellable *cancellable;
 	NemoFile *file;
+	GFile *original_location;
+	char *thumbnail_path;
 	gboolean trying_original;
 	gboolean tried_original;
+	gboolean from_atlas;
+	GdkPixbuf *pixbuf; /* set by the loader thread */
 };
 
 struct MountState {
@@ -91,6 +109,8 @@ struct DirectoryLoadState {
 	GHashTable *load_mime_list_hash;
 	NemoFile *load_directory_file;
 	int load_file_count;
+	gboolean sample_latency;
+	guint64 device; /* 0 until the first batch was read */
 };
 
 struct MimeListState {
@@ -514,17 +534,46 @@ link_info_cancel (NemoDirectory *directory)
 	}
 }
 
+static ThumbnailState *
+thumbnail_state_for_file (NemoDirectory *directory,
+			  NemoFile *file)
+{
+	GList *node;
+	ThumbnailState *state;
+
+	for (node = directory->details->thumbnail_states; node != NULL; node = node->next) {
+		state = node->data;
+		if (state->file == file) {
+			return state;
+		}
+	}
+
+	return NULL;
+}
+
 static void
-thumbnail_cancel (NemoDirectory *directory)
+thumbnail_cancel_one (NemoDirectory *directory,
+		      ThumbnailState *state)
 {
-	if (directory->details->thumbnail_state != NULL) {
-		g_cancellable_cancel (directory->details->thumbnail_state->cancellable);
-		directory->details->thumbnail_state->directory = NULL;
-		directory->details->thumbnail_state = NULL;
+	g_cancellable_cancel (state->cancellable);
+	state->directory = NULL;
+
+	directory->details->thumbnail_states =
+		g_list_remove (directory->details->thumbnail_states, state);
+	if (directory->details->thumbnail_states == NULL) {
 		async_job_end (directory, "thumbnail");
 	}
 }
 
+static void
+thumbnail_cancel (NemoDirectory *directory)
+{
+	while (directory->details->thumbnail_states != NULL) {
+		thumbnail_cancel_one (directory,
+				      directory->details->thumbnail_states->data);
+	}
+}
+
 static void
 mount_cancel (NemoDirectory *directory)
 {
@@ -1601,10 +1650,13 @@ nemo_async_destroying_file (NemoFile *file)
 		changed = TRUE;
 	}
 
-	if (directory->details->thumbnail_state != NULL &&
-	    directory->details->thumbnail_state->file ==  file) {
-		directory->details->thumbnail_state->file = NULL;
-		changed = TRUE;
+	for (node = directory->details->thumbnail_states; node != NULL; node = node->next) {
+		ThumbnailState *thumbnail_state = node->data;
+
+		if (thumbnail_state->file == file) {
+			thumbnail_state->file = NULL;
+			changed = TRUE;
+		}
 	}
 	
 	if (directory->details->mount_state != NULL &&
@@ -1981,6 +2033,147 @@ directory_load_state_free (DirectoryLoadState *state)
 	g_free (state);
 }
 
+/* How long the last read of a local directory took on the enumerator's
+ * worker thread, per device, so file operations can tell when they are
+ * getting in the way of browsing. Only the readdir () and stat () calls
+ * are timed, not the wait for the main loop to dispatch the files.
+ */
+typedef struct {
+	gint64 latency;
+	gint64 time;
+} LoadLatencySample;
+
+static GMutex load_latency_mutex;
+static GHashTable *load_latencies; /* device -> LoadLatencySample */
+
+static void
+note_load_latency (guint64 device,
+		   gint64  latency)
+{
+	LoadLatencySample *sample;
+	guint64 *key;
+
+	g_mutex_lock (&load_latency_mutex);
+	if (load_latencies == NULL) {
+		load_latencies = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+							g_free, g_free);
+	}
+	sample = g_hash_table_lookup (load_latencies, &device);
+	if (sample == NULL) {
+		key = g_new (guint64, 1);
+		*key = device;
+		sample = g_new (LoadLatencySample, 1);
+		g_hash_table_insert (load_latencies, key, sample);
+	}
+	sample->latency = latency;
+	sample->time = g_get_monotonic_time ();
+	g_mutex_unlock (&load_latency_mutex);
+}
+
+gint64
+nemo_directory_get_recent_load_latency (guint64 device)
+{
+	LoadLatencySample *sample;
+	gint64 latency;
+
+	g_mutex_lock (&load_latency_mutex);
+	latency = 0;
+	sample = load_latencies != NULL ?
+		g_hash_table_lookup (load_latencies, &device) : NULL;
+	if (sample != NULL &&
+	    g_get_monotonic_time () - sample->time < LOAD_LATENCY_LIFETIME) {
+		latency = sample->latency;
+	}
+	g_mutex_unlock (&load_latency_mutex);
+
+	return latency;
+}
+
+static void
+free_file_info_list (gpointer data)
+{
+	g_list_free_full (data, g_object_unref);
+}
+
+/* Reads the next batch of a local directory in a thread, like
+ * g_file_enumerator_next_files_async () does, and times the read.
+ */
+static void
+next_files_thread (GTask        *task,
+		   gpointer      source_object,
+		   gpointer      task_data,
+		   GCancellable *cancellable)
+{
+	DirectoryLoadState *state;
+	GFileInfo *info;
+	GList *files;
+	GError *error;
+	gint64 start;
+
+	state = task_data;
+
+	error = NULL;
+	start = g_get_monotonic_time ();
+	files = g_file_enumerator_next_files (G_FILE_ENUMERATOR (source_object),
+					      DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
+					      cancellable, &error);
+
+	if (state->device == 0) {
+		/* Only this thread touches the device, one batch at a time */
+		info = g_file_query_info (g_file_enumerator_get_container (G_FILE_ENUMERATOR (source_object)),
+					  G_FILE_ATTRIBUTE_UNIX_DEVICE,
+					  G_FILE_QUERY_INFO_NONE, cancellable, NULL);
+		if (info != NULL) {
+			state->device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+			g_object_unref (info);
+		}
+	}
+	if (state->device != 0 && files != NULL) {
+		note_load_latency (state->device, g_get_monotonic_time () - start);
+	}
+
+	if (error != NULL) {
+		g_task_return_error (task, error);
+	} else {
+		g_task_return_pointer (task, files, free_file_info_list);
+	}
+}
+
+static void
+load_next_files (DirectoryLoadState *state,
+		 GAsyncReadyCallback callback)
+{
+	GTask *task;
+
+	if (!state->sample_latency) {
+		g_file_enumerator_next_files_async (state->enumerator,
+						    DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
+						    G_PRIORITY_DEFAULT,
+						    state->cancellable,
+						    callback,
+						    state);
+		return;
+	}
+
+	task = g_task_new (state->enumerator, state->cancellable, callback, state);
+	g_task_set_task_data (task, state, NULL);
+	g_task_run_in_thread (task, next_files_thread);
+	g_object_unref (task);
+}
+
+static GList *
+load_next_files_finish (DirectoryLoadState *state,
+			GAsyncResult *res,
+			GError **error)
+{
+	if (!state->sample_latency) {
+		return g_file_enumerator_next_files_finish (state->enumerator,
+							    res, error);
+	}
+
+	return g_task_propagate_pointer (G_TASK (res), error);
+}
+
 static void
 more_files_callback (GObject *source_object,
 		     GAsyncResult *res,
@@ -2006,8 +2199,7 @@ more_files_callback (GObject *source_object,
 	g_assert (directory->details->directory_load_in_progress == state);
 
 	error = NULL;
-	files = g_file_enumerator_next_files_finish (state->enumerator,
-						     res, &error);
+	files = load_next_files_finish (state, res, &error);
 
 	for (l = files; l != NULL; l = l->next) {
 		info = l->data;
@@ -2019,12 +2211,7 @@ more_files_callback (GObject *source_object,
 		directory_load_done (directory, error);
 		directory_load_state_free (state);
 	} else {
-		g_file_enumerator_next_files_async (state->enumerator,
-						    DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
-						    G_PRIORITY_DEFAULT,
-						    state->cancellable,
-						    more_files_callback,
-						    state);
+		load_next_files (state, more_files_callback);
 	}
 
 	nemo_directory_unref (directory);
@@ -2064,12 +2251,7 @@ enumerate_children_callback (GObject *source_object,
 		return;
 	} else {
 		state->enumerator = enumerator;
-		g_file_enumerator_next_files_async (state->enumerator,
-						    DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
-						    G_PRIORITY_DEFAULT,
-						    state->cancellable,
-						    more_files_callback,
-						    state);
+		load_next_files (state, more_files_callback);
 	}
 }
 
@@ -2114,6 +2296,7 @@ start_monitoring_file_list (NemoDirectory *directory)
 	
 	directory->details->directory_load_in_progress = state;
 	
+	state->sample_latency = g_file_is_native (directory->details->location);
 	g_file_enumerate_children_async (directory->details->location,
 					 NEMO_FILE_DEFAULT_ATTRIBUTES,
 					 0, /* flags */
@@ -2568,6 +2751,7 @@ deep_count_one (DeepCountState *state,
 		GFileInfo *info)
 {
 	NemoFile *file;
+	NemoFileRareDetails *rare;
 	GFile *subdir;
 	gboolean is_seen_inode;
 	const char *id;
@@ -2578,15 +2762,16 @@ deep_count_one (DeepCountState *state,
 	}
 
 	file = state->directory->details->deep_count_file;
+	rare = nemo_file_get_rare_details (file);
 
     hidden = should_skip_file (NULL, info);
 
 	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
 		/* Count the directory. */
         if (hidden) {
-            file->details->deep_hidden_count += 1;
+            rare->deep_hidden_count += 1;
         } else {
-            file->details->deep_directory_count += 1;
+            rare->deep_directory_count += 1;
         }
 		/* Record the fact that we have to descend into this directory. */
 		id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
@@ -2599,15 +2784,15 @@ deep_count_one (DeepCountState *state,
 	} else {
 		/* Even non-regular files count as files. */
         if (hidden) {
-            file->details->deep_hidden_count += 1;
+            rare->deep_hidden_count += 1;
         } else {
-            file->details->deep_file_count += 1;
+            rare->deep_file_count += 1;
         }
 	}
 
 	/* Count the size, hidden or not */
 	if (!is_seen_inode && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE)) {
-		file->details->deep_size += g_file_info_get_size (info);
+		rare->deep_size += g_file_info_get_size (info);
 	}
 }
 
@@ -2745,7 +2930,7 @@ deep_count_callback (GObject *source_object,
 	enumerator = g_file_enumerate_children_finish  (G_FILE (source_object),	res, NULL);
 	
 	if (enumerator == NULL) {
-		file->details->deep_unreadable_count += 1;
+		nemo_file_get_rare_details (file)->deep_unreadable_count += 1;
 		
 		deep_count_next_dir (state);
 	} else {
@@ -2833,6 +3018,7 @@ deep_count_start (NemoDirectory *directory,
 {
 	GFile *location;
 	DeepCountState *state;
+	NemoFileRareDetails *rare;
 	
 	if (directory->details->deep_count_in_progress != NULL) {
 		*doing_io = TRUE;
@@ -2859,11 +3045,12 @@ deep_count_start (NemoDirectory *directory,
 
 	/* Start counting. */
 	file->details->deep_counts_status = NEMO_REQUEST_IN_PROGRESS;
-	file->details->deep_directory_count = 0;
-	file->details->deep_file_count = 0;
-	file->details->deep_unreadable_count = 0;
-    file->details->deep_hidden_count = 0;
-	file->details->deep_size = 0;
+	rare = nemo_file_get_rare_details (file);
+	rare->deep_directory_count = 0;
+	rare->deep_file_count = 0;
+	rare->deep_unreadable_count = 0;
+	rare->deep_hidden_count = 0;
+	rare->deep_size = 0;
 	directory->details->deep_count_file = file;
 
 	state = g_new0 (DeepCountState, 1);
@@ -3659,17 +3846,19 @@ thumbnail_done (NemoDirectory *directory,
 		}
 
 	}
-	
-	nemo_directory_async_state_changed (directory);
 }
 
 static void
 thumbnail_stop (NemoDirectory *directory)
 {
+	GList *node, *next;
+	ThumbnailState *state;
 	NemoFile *file;
 
-	if (directory->details->thumbnail_state != NULL) {
-		file = directory->details->thumbnail_state->file;
+	for (node = directory->details->thumbnail_states; node != NULL; node = next) {
+		next = node->next;
+		state = node->data;
+		file = state->file;
 
 		if (file != NULL) {
 			g_assert (NEMO_IS_FILE (file));
@@ -3677,44 +3866,34 @@ thumbnail_stop (NemoDirectory *directory)
 			if (is_needy (file,
 				      lacks_thumbnail,
 				      REQUEST_THUMBNAIL)) {
-				return;
+				continue;
 			}
 		}
 
-		/* The link info is not wanted, so stop it. */
-		thumbnail_cancel (directory);
-	}
-}
-
-static void
-thumbnail_got_pixbuf (NemoDirectory *directory,
-		      NemoFile *file,
-		      GdkPixbuf *pixbuf,
-		      gboolean tried_original)
-{
-	nemo_directory_ref (directory);
-
-	nemo_file_ref (file);
-	thumbnail_done (directory, file, pixbuf, tried_original);
-	nemo_file_changed (file);
-	nemo_file_unref (file);
-	
-	if (pixbuf) {
-		g_object_unref (pixbuf);
+		/* The thumbnail is not wanted, so stop it. */
+		thumbnail_cancel_one (directory, state);
 	}
-
-	nemo_directory_unref (directory);
 }
 
 static void
 thumbnail_state_free (ThumbnailState *state)
 {
 	g_object_unref (state->cancellable);
+	g_clear_object (&state->original_location);
+	g_clear_object (&state->pixbuf);
+	g_free (state->thumbnail_path);
 	g_free (state);
 }
 
 extern int cached_thumbnail_size;
 
+static int
+get_max_thumbnail_size (void)
+{
+	/* cf. nemo_file_get_icon() */
+	return NEMO_ICON_SIZE_LARGEST * cached_thumbnail_size / NEMO_ICON_SIZE_STANDARD;
+}
+
 /* scale very large images down to the max. size we need */
 static void
 thumbnail_loader_size_prepared (GdkPixbufLoader *loader,
@@ -3727,8 +3906,7 @@ thumbnail_loader_size_prepared (GdkPixbufLoader *loader,
 
 	aspect_ratio = ((double) width) / height;
 
-	/* cf. nemo_file_get_icon() */
-	max_thumbnail_size = NEMO_ICON_SIZE_LARGEST * cached_thumbnail_size / NEMO_ICON_SIZE_STANDARD;
+	max_thumbnail_size = get_max_thumbnail_size ();
 	if (MAX (width, height) > max_thumbnail_size) {
 		if (width > height) {
 			width = max_thumbnail_size;
@@ -3781,61 +3959,300 @@ get_pixbuf_for_content (goffset file_len,
 	return pixbuf;
 }
 
+/* Thumbnails are read and decoded on a small pool of worker threads.
+ * Finished loads are queued up and handed back to the main loop in
+ * batches by a single idle callback, so a directory full of images
+ * gets one change notification per batch instead of one per file.
+ */
+static GThreadPool *thumbnail_load_pool;
+static GAsyncQueue *thumbnail_load_results;
+static gint thumbnail_load_results_scheduled;
+
+/* Thumbnails that were decoded from the cache are also packed into a
+ * per-directory atlas (see nemo-thumbnail-atlas.h), so the next visit
+ * gets them without reading and decoding a PNG for each file.
+ */
+static NemoThumbnailAtlas *
+get_thumbnail_atlas (NemoDirectory *directory)
+{
+	if (!directory->details->thumbnail_atlas_opened) {
+		directory->details->thumbnail_atlas_opened = TRUE;
+
+		if (g_file_is_native (directory->details->location)) {
+			directory->details->thumbnail_atlas =
+				nemo_thumbnail_atlas_open (directory->details->location,
+							   get_max_thumbnail_size ());
+		}
+	}
+
+	return directory->details->thumbnail_atlas;
+}
 
+/* The atlas opened at load time stays the base of every save, so the
+ * tiles added since then are kept and written out again each time.
+ */
 static void
-thumbnail_read_callback (GObject *source_object,
-			 GAsyncResult *res,
-			 gpointer user_data)
+thumbnail_atlas_save (NemoDirectory *directory)
+{
+	NemoThumbnailAtlasTile *tile;
+	GHashTableIter iter;
+	GList *tiles;
+	gpointer value;
+
+	if (directory->details->thumbnail_atlas_tiles == NULL ||
+	    g_hash_table_size (directory->details->thumbnail_atlas_tiles) == 0) {
+		return;
+	}
+
+	tiles = NULL;
+	g_hash_table_iter_init (&iter, directory->details->thumbnail_atlas_tiles);
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		tile = value;
+
+		if (directory->details->directory_loaded &&
+		    !g_hash_table_contains (directory->details->file_hash, tile->name)) {
+			g_hash_table_iter_remove (&iter);
+			continue;
+		}
+
+		tiles = g_list_prepend (tiles,
+					nemo_thumbnail_atlas_tile_new (tile->name,
+								       tile->mtime,
+								       tile->thumb_mtime,
+								       tile->pixbuf));
+	}
+
+	/* Only a complete listing tells which files are gone */
+	nemo_thumbnail_atlas_save_async (directory->details->location,
+					 get_max_thumbnail_size (),
+					 tiles,
+					 directory->details->thumbnail_atlas,
+					 directory->details->directory_loaded ?
+					 directory->details->file_hash : NULL);
+}
+
+static gboolean
+thumbnail_atlas_save_timeout (gpointer user_data)
+{
+	NemoDirectory *directory = user_data;
+
+	directory->details->thumbnail_atlas_save_id = 0;
+	thumbnail_atlas_save (directory);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+thumbnail_atlas_add (NemoDirectory *directory,
+		     NemoFile *file)
+{
+	NemoThumbnailAtlasTile *tile;
+	gint64 now;
+
+	if (file->details->thumbnail == NULL ||
+	    file->details->thumbnail_tried_original ||
+	    !g_file_is_native (directory->details->location)) {
+		return;
+	}
+
+	if (directory->details->thumbnail_atlas_tiles == NULL) {
+		directory->details->thumbnail_atlas_tiles =
+			g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+					       (GDestroyNotify) nemo_thumbnail_atlas_tile_free);
+	}
+
+	tile = nemo_thumbnail_atlas_tile_new (file->details->name,
+					      file->details->mtime,
+					      file->details->thumbnail_mtime,
+					      file->details->thumbnail);
+	g_hash_table_replace (directory->details->thumbnail_atlas_tiles, tile->name, tile);
+
+	/* Every save rewrites the whole atlas, so wait for the thumbnails
+	 * to stop coming, but not forever.
+	 */
+	now = g_get_monotonic_time ();
+	if (directory->details->thumbnail_atlas_save_id == 0) {
+		directory->details->thumbnail_atlas_save_first = now;
+	} else if (now + THUMBNAIL_ATLAS_SAVE_DELAY * G_USEC_PER_SEC <
+		   directory->details->thumbnail_atlas_save_first + THUMBNAIL_ATLAS_SAVE_MAX_DELAY * G_USEC_PER_SEC) {
+		g_source_remove (directory->details->thumbnail_atlas_save_id);
+		directory->details->thumbnail_atlas_save_id = 0;
+	}
+
+	if (directory->details->thumbnail_atlas_save_id == 0) {
+		directory->details->thumbnail_atlas_save_id =
+			g_timeout_add_seconds (THUMBNAIL_ATLAS_SAVE_DELAY,
+					       thumbnail_atlas_save_timeout,
+					       directory);
+	}
+}
+
+/* Called when the directory goes away; writes out anything pending. */
+static void
+thumbnail_atlas_cancel (NemoDirectory *directory)
+{
+	if (directory->details->thumbnail_atlas_save_id != 0) {
+		g_source_remove (directory->details->thumbnail_atlas_save_id);
+		directory->details->thumbnail_atlas_save_id = 0;
+	}
+
+	thumbnail_atlas_save (directory);
+
+	g_clear_pointer (&directory->details->thumbnail_atlas_tiles, g_hash_table_destroy);
+	g_clear_pointer (&directory->details->thumbnail_atlas, nemo_thumbnail_atlas_free);
+	directory->details->thumbnail_atlas_opened = FALSE;
+}
+
+static gboolean
+thumbnail_load_results_idle (gpointer user_data)
 {
 	ThumbnailState *state;
-	gsize file_size;
-	char *file_contents;
-	gboolean result;
 	NemoDirectory *directory;
-	GdkPixbuf *pixbuf;
-	GFile *location;
+	NemoFile *file;
+	GHashTable *changed_files;
+	GHashTableIter iter;
+	gpointer key, value;
+	GList *files, *node;
 
-	state = user_data;
+	g_atomic_int_set (&thumbnail_load_results_scheduled, FALSE);
+
+	changed_files = g_hash_table_new (NULL, NULL);
+
+	while ((state = g_async_queue_try_pop (thumbnail_load_results)) != NULL) {
+		directory = state->directory;
+
+		if (directory == NULL) {
+			/* Operation was cancelled. */
+			thumbnail_state_free (state);
+			continue;
+		}
+
+		directory->details->thumbnail_states =
+			g_list_remove (directory->details->thumbnail_states, state);
+		if (directory->details->thumbnail_states == NULL) {
+			async_job_end (directory, "thumbnail");
+		}
+
+		file = state->file;
+		if (file != NULL) {
+			thumbnail_done (directory, file, state->pixbuf, state->tried_original);
+
+			if (!state->from_atlas) {
+				thumbnail_atlas_add (directory, file);
+			}
+
+			if (!g_hash_table_lookup_extended (changed_files, directory, NULL, &value)) {
+				nemo_directory_ref (directory);
+				value = NULL;
+			}
+			g_hash_table_insert (changed_files, directory,
+					     g_list_prepend (value, nemo_file_ref (file)));
+		}
 
-	if (state->directory == NULL) {
-		/* Operation was cancelled. Bail out */
 		thumbnail_state_free (state);
-		return;
 	}
 
-	directory = nemo_directory_ref (state->directory);
+	g_hash_table_iter_init (&iter, changed_files);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		directory = key;
+		files = NULL;
 
-	result = g_file_load_contents_finish (G_FILE (source_object),
-					      res,
-					      &file_contents, &file_size,
-					      NULL, NULL);
+		for (node = value; node != NULL; node = node->next) {
+			file = node->data;
+			if (nemo_file_is_self_owned (file)) {
+				nemo_file_changed (file);
+			} else {
+				files = g_list_prepend (files, file);
+			}
+		}
+
+		if (files != NULL) {
+			nemo_directory_emit_change_signals (directory, files);
+			g_list_free (files);
+		}
+
+		nemo_directory_async_state_changed (directory);
+
+		nemo_file_list_free (value);
+		nemo_directory_unref (directory);
+	}
+
+	g_hash_table_destroy (changed_files);
+
+	return G_SOURCE_REMOVE;
+}
+
+static GdkPixbuf *
+thumbnail_load_location (GFile *location,
+			 GCancellable *cancellable)
+{
+	GdkPixbuf *pixbuf;
+	char *file_contents;
+	gsize file_size;
 
 	pixbuf = NULL;
-	if (result) {
+	if (g_file_load_contents (location, cancellable,
+				  &file_contents, &file_size,
+				  NULL, NULL)) {
 		pixbuf = get_pixbuf_for_content (file_size, file_contents);
 		g_free (file_contents);
 	}
-	
-	if (pixbuf == NULL && state->trying_original) {
+
+	return pixbuf;
+}
+
+/* Any thread */
+static void
+thumbnail_load_deliver (ThumbnailState *state)
+{
+	g_async_queue_push (thumbnail_load_results, state);
+
+	if (g_atomic_int_compare_and_exchange (&thumbnail_load_results_scheduled, FALSE, TRUE)) {
+		g_idle_add (thumbnail_load_results_idle, NULL);
+	}
+}
+
+/* Loader thread */
+static void
+thumbnail_load_thread (gpointer data,
+		       gpointer user_data)
+{
+	ThumbnailState *state;
+	char *file_contents;
+	gsize file_size;
+
+	state = data;
+
+	if (state->trying_original &&
+	    !g_cancellable_is_cancelled (state->cancellable)) {
+		state->pixbuf = thumbnail_load_location (state->original_location,
+							 state->cancellable);
 		state->trying_original = FALSE;
+	}
 
-		location = g_file_new_for_path (state->file->details->thumbnail_path);
+	/* The thumbnail cache is always local, skip GFile for it. */
+	if (state->pixbuf == NULL &&
+	    !g_cancellable_is_cancelled (state->cancellable) &&
+	    g_file_get_contents (state->thumbnail_path,
+				 &file_contents, &file_size, NULL)) {
+		state->pixbuf = get_pixbuf_for_content (file_size, file_contents);
+		g_free (file_contents);
+	}
 
-		g_file_load_contents_async (location,
-					    state->cancellable,
-					    thumbnail_read_callback,
-					    state);
-		g_object_unref (location);
-	} else {
-		state->directory->details->thumbnail_state = NULL;
-		async_job_end (state->directory, "thumbnail");
-		
-		thumbnail_got_pixbuf (state->directory, state->file, pixbuf, state->tried_original);
-	
-		thumbnail_state_free (state);
+	thumbnail_load_deliver (state);
+}
+
+static GThreadPool *
+get_thumbnail_load_pool (void)
+{
+	if (thumbnail_load_pool == NULL) {
+		thumbnail_load_results = g_async_queue_new ();
+		thumbnail_load_pool = g_thread_pool_new (thumbnail_load_thread, NULL,
+							 CLAMP (g_get_num_processors (), 2, MAX_THUMBNAIL_LOADS),
+							 FALSE, NULL);
 	}
-	
-	nemo_directory_unref (directory);
+
+	return thumbnail_load_pool;
 }
 
 static void
@@ -3843,22 +4260,28 @@ thumbnail_start (NemoDirectory *directory,
 		 NemoFile *file,
 		 gboolean *doing_io)
 {
-	GFile *location;
 	ThumbnailState *state;
-
-	if (directory->details->thumbnail_state != NULL) {
-		*doing_io = TRUE;
-		return;
-	}
+	NemoThumbnailAtlas *atlas;
 
 	if (!is_needy (file,
 		       lacks_thumbnail,
 		       REQUEST_THUMBNAIL)) {
 		return;
 	}
-	*doing_io = TRUE;
 
-	if (!async_job_start (directory, "thumbnail")) {
+	/* Already loading, let the queue move on to the next file. */
+	if (thumbnail_state_for_file (directory, file) != NULL) {
+		return;
+	}
+
+	if (g_list_length (directory->details->thumbnail_states) >= MAX_THUMBNAIL_LOADS) {
+		*doing_io = TRUE;
+		return;
+	}
+
+	if (directory->details->thumbnail_states == NULL &&
+	    !async_job_start (directory, "thumbnail")) {
+		*doing_io = TRUE;
 		return;
 	}
 	
@@ -3866,22 +4289,34 @@ thumbnail_start (NemoDirectory *directory,
 	state->directory = directory;
 	state->file = file;
 	state->cancellable = g_cancellable_new ();
+	state->thumbnail_path = g_strdup (file->details->thumbnail_path);
 
 	if (file->details->thumbnail_wants_original) {
 		state->tried_original = TRUE;
 		state->trying_original = TRUE;
-		location = nemo_file_get_location (file);
+		state->original_location = nemo_file_get_location (file);
 	} else {
-		location = g_file_new_for_path (file->details->thumbnail_path);
+		atlas = get_thumbnail_atlas (directory);
+		if (atlas != NULL) {
+			state->pixbuf = nemo_thumbnail_atlas_lookup (atlas,
+								     file->details->name,
+								     file->details->mtime);
+			state->from_atlas = state->pixbuf != NULL;
+		}
 	}
 	
-	directory->details->thumbnail_state = state;
+	directory->details->thumbnail_states =
+		g_list_prepend (directory->details->thumbnail_states, state);
 
-	g_file_load_contents_async (location,
-				    state->cancellable,
-				    thumbnail_read_callback,
-				    state);
-	g_object_unref (location);
+	/* Don't set doing_io, so other files can start loading
+	 * while this one is in flight.
+	 */
+	if (state->from_atlas) {
+		get_thumbnail_load_pool ();
+		thumbnail_load_deliver (state);
+	} else {
+		g_thread_pool_push (get_thumbnail_load_pool (), state, NULL);
+	}
 }
 
 static void
@@ -4508,6 +4943,7 @@ nemo_directory_cancel (NemoDirectory *directory)
 	new_files_cancel (directory);
 	extension_info_cancel (directory);
 	thumbnail_cancel (directory);
+	thumbnail_atlas_cancel (directory);
 	mount_cancel (directory);
 	filesystem_info_cancel (directory);
     favorite_check_cancel (directory);
@@ -4572,9 +5008,11 @@ static void
 cancel_thumbnail_for_file (NemoDirectory *directory,
 			   NemoFile      *file)
 {
-	if (directory->details->thumbnail_state != NULL &&
-	    directory->details->thumbnail_state->file == file) {
-		thumbnail_cancel (directory);
+	ThumbnailState *state;
+
+	state = thumbnail_state_for_file (directory, file);
+	if (state != NULL) {
+		thumbnail_cancel_one (directory, state);
 	}
 }
 
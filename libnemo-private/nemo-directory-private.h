@@ -28,6 +28,7 @@
 #include <libnemo-private/nemo-file-queue.h>
 #include <libnemo-private/nemo-file.h>
 #include <libnemo-private/nemo-monitor.h>
+#include <libnemo-private/nemo-thumbnail-atlas.h>
 #include <libnemo-extension/nemo-info-provider.h>
 
 typedef struct LinkInfoReadState LinkInfoReadState;
@@ -131,7 +132,12 @@ struct NemoDirectoryDetails
 	guint extension_info_idle;
     GClosure * extension_info_closure;
 
-	ThumbnailState *thumbnail_state;
+	GList *thumbnail_states; /* list of ThumbnailState * */
+	NemoThumbnailAtlas *thumbnail_atlas;
+	gboolean thumbnail_atlas_opened;
+	GHashTable *thumbnail_atlas_tiles; /* name -> NemoThumbnailAtlasTile * to save */
+	guint thumbnail_atlas_save_id;
+	gint64 thumbnail_atlas_save_first; /* first add since the last save */
 
 	MountState *mount_state;
 
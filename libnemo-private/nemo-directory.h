@@ -215,6 +215,12 @@ gboolean           nemo_directory_are_all_files_seen       (NemoDirectory
 /* Return true if the directory is local. */
 gboolean           nemo_directory_is_local                 (NemoDirectory         *directory);
 
+/* Return how long, in microseconds, the most recent read of a local
+ * directory on @device (a unix::device value) took on disk, or 0 if no
+ * directory there was read lately. Can be called from any thread.
+ */
+gint64             nemo_directory_get_recent_load_latency  (guint64                device);
+
 gboolean           nemo_directory_is_in_trash              (NemoDirectory         *directory);
 gboolean           nemo_directory_is_in_recent             (NemoDirectory         *directory);
 gboolean           nemo_directory_is_in_favorites          (NemoDirectory         *directory);
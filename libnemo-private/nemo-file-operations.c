@@ -26,6 +26,7 @@
             Pavel Cisler <pavel@eazel.com>
  */
 
+#define _GNU_SOURCE /* copy_file_range () */
 #include <config.h>
 #include <string.h>
 #include <stdio.h>
@@ -36,6 +37,19 @@
 #include <sys/types.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#if HAVE_LINUX_FS_H
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#if HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+#if HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
 
 #include "nemo-file-operations.h"
 
@@ -70,6 +84,7 @@
 #include "nemo-file-undo-operations.h"
 #include "nemo-file-undo-manager.h"
 #include "nemo-job-queue.h"
+#include "nemo-copy-journal.h"
 
 /* TODO: TESTING!!! */
 
@@ -104,6 +119,48 @@ typedef struct {
 	gboolean delete_all;
 } CommonJob;
 
+/* Paces the data a copy or move job transfers, see io_throttle_account () */
+typedef struct {
+	GMutex mutex;
+	NemoFileOpsIOPriority io_priority;
+	goffset bytes_per_sec; /* 0 for no limit */
+	gboolean yield_to_browsing;
+	GArray *devices; /* guint64 unix::device of the job's files */
+	gint64 start_time;
+	goffset bytes;
+	gint backing_off; /* atomic */
+} IOThrottle;
+
+/* Copy and move progress as plain counters. The job thread publishes its
+ * totals under @seq, copy workers add the files they finish to the
+ * worker_ counters until the job accounts for them, and
+ * copy_progress_sample () turns it all into text on the main loop.
+ */
+typedef struct {
+	GSource *source;
+	gint seq;
+	int num_files;
+	int total_files;
+	goffset num_bytes;
+	goffset total_bytes;
+	gint worker_files;
+	gint worker_bytes; /* at most one parallel copy batch */
+	/* Main loop only */
+	int last_files_left;
+	int last_files;
+	goffset last_bytes;
+	gboolean last_paused;
+	gboolean last_backing_off;
+} CopyProgress;
+
+/* Reads back copied files on worker threads, see copy_verifier_queue () */
+typedef struct {
+	GThreadPool *pool;
+	GCancellable *cancellable;
+	GMutex mutex;
+	GList *mismatches; /* destination GFiles */
+} CopyVerifier;
+
 typedef struct {
 	CommonJob common;
 	gboolean is_move;
@@ -117,6 +174,11 @@ typedef struct {
 	gchar *target_name;
 	NemoCopyCallback  done_callback;
 	gpointer done_callback_data;
+	GThreadPool *copy_pool;
+	IOThrottle throttle;
+	NemoCopyJournal *journal;
+	CopyVerifier *verifier;
+	CopyProgress counters;
 } CopyMoveJob;
 
 typedef struct {
@@ -183,12 +245,13 @@ typedef struct {
 	goffset num_bytes;
 	OpKind op;
 	guint64 last_report_time;
-	int last_reported_files_left;
 } TransferInfo;
 
 #define SECONDS_NEEDED_FOR_RELIABLE_TRANSFER_RATE 8
 #define US_PER_MS 1000
 #define PROGRESS_UPDATE_THRESHOLD 250
+/* NemoProgressInfo doesn't signal changes any faster than this */
+#define PROGRESS_SAMPLE_INTERVAL 100
 
 #define MAXIMUM_DISPLAYED_FILE_NAME_LENGTH 50
 
@@ -1041,261 +1104,1082 @@ file_delete_wrapper (GFile        *file,
     return ret;
 }
 
-static void
-generate_initial_job_details (NemoProgressInfo *info,
-                              OpKind            kind,
-                              GList            *files,
-                              GFile            *destination)
-{
-    gchar *s = NULL;
-    gchar *dest_name = NULL;
-    gchar *src_name = NULL;
-
-    if (destination != NULL)
-        get_best_name (destination, &dest_name);
-
-    if (files != NULL)
-        get_parent_name (files->data, &src_name);
-
-    switch (kind) {
-        case OP_KIND_COPY:
-            g_return_if_fail (files != NULL);
-            g_return_if_fail (destination != NULL);
-
-            s = f (ngettext("Waiting to copy a file from '%1$s' to '%2$s'",
-                            "Waiting to copy files from '%1$s' to '%2$s'",
-                            g_list_length (files)),
-                            src_name, dest_name);
-            break;
-        case OP_KIND_MOVE:
-            g_return_if_fail (files != NULL);
-            g_return_if_fail (destination != NULL);
-
-            s = f (ngettext("Waiting to move a file from '%1$s' to '%2$s'",
-                            "Waiting to move files from '%1$s' to '%2$s'",
-                            g_list_length (files)),
-                            src_name, dest_name);
-            break;
-        case OP_KIND_DELETE:
-            g_return_if_fail (files != NULL);
+#define NATIVE_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+#define NATIVE_COPY_BUFFER_SIZE (256 * 1024)
 
-            s = f (ngettext("Waiting to permanently delete a file from '%s'",
-                            "Waiting to permanently delete files from '%s'",
-                            g_list_length (files)),
-                            src_name);
-            break;
-        case OP_KIND_TRASH:
-            g_return_if_fail (files != NULL);
-
-            s = f (ngettext("Waiting to trash a file in '%s'",
-                            "Waiting to trash files in '%s'",
-                            g_list_length (files)),
-                            src_name);
-            break;
-        case OP_KIND_EMPTY_TRASH:
-            s = f (_("Waiting to empty the trash"));
-            break;
-        case OP_KIND_DUPE:
-            g_return_if_fail (files != NULL);
-            g_return_if_fail (destination != NULL);
+/* Journaled copies sync and record their progress this often */
+#define COPY_JOURNAL_CHECKPOINT_SIZE (64 * 1024 * 1024)
+/* Bytes compared before continuing a partly copied file */
+#define COPY_JOURNAL_VERIFY_SIZE (64 * 1024)
+/* Copies and moves smaller than this aren't worth a journal */
+#define COPY_JOURNAL_MIN_JOB_SIZE (256 * 1024 * 1024)
 
-            s = f (ngettext("Waiting to duplicate a file in '%s'",
-                            "Waiting to duplicate files in '%s'",
-                            g_list_length (files)),
-                            dest_name);
-            break;
-        case OP_KIND_PERMISSIONS:
-            g_return_if_fail (destination != NULL);
+/* Only guards against corrupted writes, not tampering, so the fastest
+ * digest GLib has will do.
+ */
+#define COPY_VERIFY_CHECKSUM G_CHECKSUM_MD5
+#define COPY_VERIFY_MAX_THREADS 2
+
+/* Folder reads slower than this make file operations back off */
+#define IO_THROTTLE_BROWSING_LATENCY (100 * 1000)
+#define IO_THROTTLE_MAX_BACKOFF (250 * 1000)
+#define IO_THROTTLE_SLEEP_SLICE (50 * 1000)
+
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_NONE 0
+#define IOPRIO_CLASS_BE 2
+#define IOPRIO_CLASS_IDLE 3
+#define IOPRIO_WHO_PROCESS 1
+
+/* Gives the calling thread the disk priority of @priority. Returns the
+ * previous priority to hand to io_priority_restore (), or -1 if there
+ * is nothing to restore.
+ */
+static int
+io_priority_set (NemoFileOpsIOPriority priority)
+{
+#if HAVE_SYS_SYSCALL_H && defined (SYS_ioprio_set) && defined (SYS_ioprio_get)
+    int old, value;
 
-            s = f (_("Waiting to change permissions of files in '%s'"), dest_name);
+    switch (priority) {
+        case NEMO_FILE_OPS_IO_PRIORITY_LOW:
+            value = (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7;
             break;
-        case OP_KIND_LINK:
-            g_return_if_fail (files != NULL);
-            g_return_if_fail (destination != NULL);
-
-            s = f (ngettext("Waiting to link a file from '%1$s' to '%2$s'",
-                            "Waiting to link files from '%1$s' to '%2$s'",
-                            g_list_length (files)),
-                            src_name, dest_name);
+        case NEMO_FILE_OPS_IO_PRIORITY_IDLE:
+            value = IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
             break;
-        case OP_KIND_TRUST:
-        case OP_KIND_CREATE:
+        case NEMO_FILE_OPS_IO_PRIORITY_NORMAL:
         default:
-            break;
+            return -1;
     }
-    g_free (dest_name);
-    g_free (src_name);
 
-    nemo_progress_info_take_initial_details (info, s);
-}
+    /* who == 0 with IOPRIO_WHO_PROCESS is the calling thread */
+    old = syscall (SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0);
+    if (old < 0 || syscall (SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, value) != 0) {
+        return -1;
+    }
 
+    /* The kernel won't take back a "none" class with a level */
+    if ((old >> IOPRIO_CLASS_SHIFT) == IOPRIO_CLASS_NONE) {
+        old = 0;
+    }
 
-#define op_job_new(__type, parent_window) ((__type *)(init_common (sizeof(__type), parent_window)))
+    return old;
+#else
+    return -1;
+#endif
+}
 
-static gpointer
-init_common (gsize job_size,
-	     GtkWindow *parent_window)
+static void
+io_priority_restore (int old)
 {
-	CommonJob *common;
-
-	common = g_malloc0 (job_size);
-
-	if (parent_window) {
-		common->parent_window = parent_window;
-		g_object_add_weak_pointer (G_OBJECT (common->parent_window),
-					   (gpointer *) &common->parent_window);
-
-	}
-	common->progress = nemo_progress_info_new ();
-	common->cancellable = nemo_progress_info_get_cancellable (common->progress);
-	common->inhibit_cookie = -1;
-    common->monitor_num = 0;
-	if (parent_window) {
-        common->monitor_num = nemo_desktop_utils_get_monitor_for_widget (GTK_WIDGET (parent_window));
-	}
-
-	return common;
+#if HAVE_SYS_SYSCALL_H && defined (SYS_ioprio_set)
+    if (old >= 0) {
+        syscall (SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, old);
+    }
+#endif
 }
 
 static void
-finalize_common (CommonJob *common)
+io_throttle_add_device (IOThrottle *throttle,
+                        GFile      *file)
 {
-	nemo_progress_info_finish (common->progress);
-
-	if (common->inhibit_cookie != -1) {
-		nemo_uninhibit_power_manager (common->inhibit_cookie);
-	}
-
-	common->inhibit_cookie = -1;
-
-	if (common->parent_window) {
-		g_object_remove_weak_pointer (G_OBJECT (common->parent_window),
-					      (gpointer *) &common->parent_window);
-	}
+    GFileInfo *info;
+    guint64 device;
+    guint i;
 
-	if (common->skip_files) {
-		g_hash_table_destroy (common->skip_files);
-	}
-	if (common->skip_readdir_error) {
-		g_hash_table_destroy (common->skip_readdir_error);
-	}
+    info = g_file_query_info (file, G_FILE_ATTRIBUTE_UNIX_DEVICE,
+                              G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL, NULL);
+    if (info == NULL) {
+        return;
+    }
 
-	if (common->undo_info != NULL) {
-		nemo_file_undo_manager_set_action (common->undo_info);
-		g_object_unref (common->undo_info);
-	}
+    device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+    g_object_unref (info);
 
-	g_object_unref (common->progress);
-	g_object_unref (common->cancellable);
-	g_free (common);
+    for (i = 0; i < throttle->devices->len; i++) {
+        if (g_array_index (throttle->devices, guint64, i) == device) {
+            return;
+        }
+    }
+    g_array_append_val (throttle->devices, device);
 }
 
+/* Called from the job thread. @files and @destination are the devices
+ * whose folder reads the job yields to.
+ */
 static void
-skip_file (CommonJob *common,
-	   GFile *file)
+io_throttle_init (IOThrottle *throttle,
+                  GList      *files,
+                  GFile      *destination)
 {
-	if (common->skip_files == NULL) {
-		common->skip_files =
-			g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
-	}
+    GList *l;
 
-	g_hash_table_insert (common->skip_files, g_object_ref (file), file);
+    g_mutex_init (&throttle->mutex);
+    throttle->io_priority = g_settings_get_enum (nemo_preferences,
+                                                 NEMO_PREFERENCES_FILE_OPS_IO_PRIORITY);
+    throttle->bytes_per_sec = (goffset) g_settings_get_int (nemo_preferences,
+                                                            NEMO_PREFERENCES_FILE_OPS_BANDWIDTH_LIMIT) * 1024 * 1024;
+    throttle->yield_to_browsing = g_settings_get_boolean (nemo_preferences,
+                                                          NEMO_PREFERENCES_FILE_OPS_YIELD_TO_BROWSING);
+    throttle->devices = g_array_new (FALSE, FALSE, sizeof (guint64));
+    if (throttle->yield_to_browsing) {
+        for (l = files; l != NULL; l = l->next) {
+            io_throttle_add_device (throttle, l->data);
+        }
+        if (destination != NULL) {
+            io_throttle_add_device (throttle, destination);
+        }
+    }
+    throttle->start_time = g_get_monotonic_time ();
+    throttle->bytes = 0;
+    throttle->backing_off = FALSE;
 }
 
 static void
-skip_readdir_error (CommonJob *common,
-		    GFile *dir)
+io_throttle_clear (IOThrottle *throttle)
 {
-	if (common->skip_readdir_error == NULL) {
-		common->skip_readdir_error =
-			g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
-	}
-
-	g_hash_table_insert (common->skip_readdir_error, g_object_ref (dir), dir);
+    g_mutex_clear (&throttle->mutex);
+    g_array_unref (throttle->devices);
 }
 
 static gboolean
-should_skip_file (CommonJob *common,
-		  GFile *file)
+io_throttle_is_backing_off (IOThrottle *throttle)
 {
-	if (common->skip_files != NULL) {
-		return g_hash_table_lookup (common->skip_files, file) != NULL;
-	}
-	return FALSE;
+    return g_atomic_int_get (&throttle->backing_off);
 }
 
-static gboolean
-should_skip_readdir_error (CommonJob *common,
-			   GFile *dir)
+/* How many bytes to move between two io_throttle_account () calls */
+static goffset
+io_throttle_get_chunk_size (IOThrottle *throttle,
+                            goffset     max_size)
 {
-	if (common->skip_readdir_error != NULL) {
-		return g_hash_table_lookup (common->skip_readdir_error, dir) != NULL;
-	}
-	return FALSE;
+    if (throttle == NULL || throttle->bytes_per_sec == 0) {
+        return max_size;
+    }
+
+    return CLAMP (throttle->bytes_per_sec / 4, NATIVE_COPY_BUFFER_SIZE, max_size);
 }
 
-static gboolean
-can_delete_without_confirm (GFile *file)
+/* Called after @bytes were transferred, from the job thread or a copy
+ * worker. Sleeps for as long as it takes to keep the job under its
+ * bandwidth limit, and a little longer while folders the user browses
+ * on the job's disks are slow to load because of us.
+ */
+static void
+io_throttle_account (IOThrottle   *throttle,
+                     goffset       bytes,
+                     GCancellable *cancellable)
 {
-	if (g_file_has_uri_scheme (file, "burn") ||
-        g_file_has_uri_scheme (file, "recent") ||
-        g_file_has_uri_scheme (file, "favorites") ||
-	    g_file_has_uri_scheme (file, "x-nemo-desktop")) {
-		return TRUE;
-	}
+    gint64 now, expected, delay, latency;
+    gboolean backing_off;
+    guint i;
 
-	return FALSE;
+    if (throttle == NULL ||
+        (throttle->bytes_per_sec == 0 && !throttle->yield_to_browsing)) {
+        return;
+    }
+
+    delay = 0;
+    now = g_get_monotonic_time ();
+
+    if (throttle->bytes_per_sec > 0) {
+        g_mutex_lock (&throttle->mutex);
+        throttle->bytes += bytes;
+        expected = throttle->start_time +
+                   (gint64) ((gdouble) throttle->bytes * G_USEC_PER_SEC / throttle->bytes_per_sec);
+        if (expected > now) {
+            delay = expected - now;
+        } else if (now - expected > G_USEC_PER_SEC) {
+            /* Don't let time spent on conflicts or scanning pile up
+             * into a burst at full speed.
+             */
+            throttle->start_time = now;
+            throttle->bytes = 0;
+        }
+        g_mutex_unlock (&throttle->mutex);
+    }
+
+    if (throttle->yield_to_browsing) {
+        latency = 0;
+        for (i = 0; i < throttle->devices->len; i++) {
+            latency = MAX (latency,
+                           nemo_directory_get_recent_load_latency (g_array_index (throttle->devices, guint64, i)));
+        }
+        backing_off = latency > IO_THROTTLE_BROWSING_LATENCY;
+        if (backing_off) {
+            delay = MAX (delay, MIN (latency, IO_THROTTLE_MAX_BACKOFF));
+        }
+        g_atomic_int_set (&throttle->backing_off, backing_off);
+    }
+
+    while (delay > 0 && !g_cancellable_is_cancelled (cancellable)) {
+        g_usleep (MIN (delay, IO_THROTTLE_SLEEP_SLICE));
+        delay -= IO_THROTTLE_SLEEP_SLICE;
+    }
 }
 
-static gboolean
-can_delete_files_without_confirm (GList *files)
+typedef struct {
+    IOThrottle *throttle;
+    GCancellable *cancellable;
+    GFileProgressCallback callback;
+    gpointer data;
+    goffset last_size;
+} ThrottledProgress;
+
+static void
+throttled_progress_callback (goffset  current_num_bytes,
+                             goffset  total_num_bytes,
+                             gpointer user_data)
 {
-	g_assert (files != NULL);
+    ThrottledProgress *progress;
 
-	while (files != NULL) {
-		if (!can_delete_without_confirm (files->data)) {
-			return FALSE;
-		}
+    progress = user_data;
 
-		files = files->next;
-	}
+    if (progress->callback) {
+        progress->callback (current_num_bytes, total_num_bytes, progress->data);
+    }
 
-	return TRUE;
+    if (current_num_bytes > progress->last_size) {
+        io_throttle_account (progress->throttle,
+                             current_num_bytes - progress->last_size,
+                             progress->cancellable);
+        progress->last_size = current_num_bytes;
+    }
 }
 
 typedef struct {
-	GtkWindow **parent_window;
-	gboolean ignore_close_box;
-	GtkMessageType message_type;
-	const char *primary_text;
-	const char *secondary_text;
-	const char *details_text;
-	const char **button_titles;
-	gboolean show_all;
-
-	int result;
-} RunSimpleDialogData;
+    CopyVerifier *verifier;
+    GFile *src; /* NULL if the digest is known */
+    GFile *dest;
+    gchar *digest;
+} VerifyTask;
 
 static gboolean
-do_run_simple_dialog (gpointer _data)
+checksum_file (GFile        *file,
+               GChecksum    *checksum,
+               GCancellable *cancellable)
 {
-	RunSimpleDialogData *data = _data;
-	const char *button_title;
-        GtkWidget *dialog;
-	int result;
-	int response_id;
+    GFileInputStream *stream;
+    guchar *buffer;
+    gssize n;
 
-	/* Create the dialog. */
-	dialog = gtk_message_dialog_new (*data->parent_window,
-					 0,
-					 data->message_type,
-					 GTK_BUTTONS_NONE,
-					 NULL);
+    stream = g_file_read (file, cancellable, NULL);
+    if (stream == NULL) {
+        return FALSE;
+    }
 
-	g_object_set (dialog,
-		      "text", data->primary_text,
-		      "secondary-text", data->secondary_text,
-		      NULL);
+    buffer = g_malloc (NATIVE_COPY_BUFFER_SIZE);
+
+    while ((n = g_input_stream_read (G_INPUT_STREAM (stream), buffer,
+                                     NATIVE_COPY_BUFFER_SIZE, cancellable, NULL)) > 0) {
+        g_checksum_update (checksum, buffer, n);
+    }
+
+    g_free (buffer);
+    g_object_unref (stream);
+
+    return n == 0;
+}
+
+/* Makes the next read of a local file come from the disk, not from the
+ * pages we just wrote.
+ */
+static void
+drop_cached_pages (GFile *file)
+{
+    gchar *path;
+    int fd;
+
+    path = g_file_get_path (file);
+    if (path == NULL) {
+        return;
+    }
+
+    fd = open (path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0) {
+        /* Dirty pages stay cached */
+        fdatasync (fd);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        close (fd);
+    }
+
+    g_free (path);
+}
+
+static void
+verify_copy_thread (gpointer data,
+                    gpointer user_data)
+{
+    VerifyTask *task;
+    CopyVerifier *verifier;
+    GChecksum *checksum;
+    gboolean same;
+
+    task = data;
+    verifier = task->verifier;
+    same = FALSE;
+
+    if (task->digest == NULL) {
+        checksum = g_checksum_new (COPY_VERIFY_CHECKSUM);
+        if (checksum_file (task->src, checksum, verifier->cancellable)) {
+            task->digest = g_strdup (g_checksum_get_string (checksum));
+        }
+        g_checksum_free (checksum);
+    }
+
+    if (task->digest != NULL) {
+        drop_cached_pages (task->dest);
+
+        checksum = g_checksum_new (COPY_VERIFY_CHECKSUM);
+        same = checksum_file (task->dest, checksum, verifier->cancellable) &&
+               strcmp (g_checksum_get_string (checksum), task->digest) == 0;
+        g_checksum_free (checksum);
+    }
+
+    if (!same && !g_cancellable_is_cancelled (verifier->cancellable)) {
+        g_mutex_lock (&verifier->mutex);
+        verifier->mismatches = g_list_prepend (verifier->mismatches,
+                                               g_object_ref (task->dest));
+        g_mutex_unlock (&verifier->mutex);
+    }
+
+    g_clear_object (&task->src);
+    g_object_unref (task->dest);
+    g_free (task->digest);
+    g_free (task);
+}
+
+static CopyVerifier *
+copy_verifier_new (GCancellable *cancellable)
+{
+    CopyVerifier *verifier;
+
+    verifier = g_new0 (CopyVerifier, 1);
+    g_mutex_init (&verifier->mutex);
+    verifier->cancellable = cancellable;
+    verifier->pool = g_thread_pool_new (verify_copy_thread, NULL,
+                                        COPY_VERIFY_MAX_THREADS, FALSE, NULL);
+
+    return verifier;
+}
+
+/* Reads @dest back and compares it with @checksum, the digest of the data
+ * written to it, or with a fresh read of @src if there is none. Runs
+ * while the job goes on copying the next files.
+ */
+static void
+copy_verifier_queue (CopyVerifier *verifier,
+                     GFile        *src,
+                     GFile        *dest,
+                     GChecksum    *checksum)
+{
+    VerifyTask *task;
+
+    task = g_new0 (VerifyTask, 1);
+    task->verifier = verifier;
+    task->dest = g_object_ref (dest);
+
+    if (checksum != NULL) {
+        task->digest = g_strdup (g_checksum_get_string (checksum));
+    } else {
+        task->src = g_object_ref (src);
+    }
+
+    g_thread_pool_push (verifier->pool, task, NULL);
+}
+
+/* Waits for the outstanding checks, returns the destinations that
+ * didn't match their source.
+ */
+static GList *
+copy_verifier_finish (CopyVerifier *verifier)
+{
+    GList *mismatches;
+
+    g_thread_pool_free (verifier->pool, FALSE, TRUE);
+
+    mismatches = g_list_reverse (verifier->mismatches);
+
+    g_mutex_clear (&verifier->mutex);
+    g_free (verifier);
+
+    return mismatches;
+}
+
+typedef enum {
+    NATIVE_COPY_DONE,
+    NATIVE_COPY_FAILED,
+    NATIVE_COPY_UNSUPPORTED
+} NativeCopyResult;
+
+static void
+set_native_copy_error (GError     **error,
+                       int          errsv,
+                       const gchar *path)
+{
+    gchar *display_name;
+
+    display_name = g_filename_display_name (path);
+    g_set_error (error, G_IO_ERROR,
+                 g_io_error_from_errno (errsv),
+                 _("Error while copying to \"%s\": %s"),
+                 display_name, g_strerror (errsv));
+    g_free (display_name);
+}
+
+/* Records that the first @offset bytes of @dest_fd are on disk */
+static void
+journal_checkpoint (NemoCopyJournal *journal,
+                    GFile           *src,
+                    int              dest_fd,
+                    goffset          offset,
+                    goffset          size,
+                    gint64           src_mtime)
+{
+    struct stat dest_stat;
+
+    if ((offset > 0 && fdatasync (dest_fd) != 0) ||
+        fstat (dest_fd, &dest_stat) != 0) {
+        return;
+    }
+
+    nemo_copy_journal_add_partial (journal, src, offset, size, src_mtime,
+                                   (gint64) dest_stat.st_mtim.tv_sec * G_USEC_PER_SEC +
+                                   dest_stat.st_mtim.tv_nsec / 1000);
+}
+
+/* Copies the contents of @src_fd into @dest_fd without going through
+ * GIO's userspace loop: a reflink if the filesystem can share extents,
+ * otherwise copy_file_range() or sendfile() so the data stays in the
+ * kernel, and only if all of those are refused a plain read/write loop.
+ * Both files must be positioned at @offset. With a @journal, the copy is
+ * synced and recorded every COPY_JOURNAL_CHECKPOINT_SIZE bytes and when
+ * it is cancelled, along with the source's @size and @src_mtime. With a
+ * @checksum, the data goes through the read/write loop and is hashed
+ * on the way.
+ * Returns an errno value, 0 on success.
+ */
+static int
+native_copy_fd (int                    src_fd,
+                int                    dest_fd,
+                goffset                offset,
+                goffset                size,
+                gint64                 src_mtime,
+                GCancellable          *cancellable,
+                IOThrottle            *throttle,
+                NemoCopyJournal       *journal,
+                GFile                 *src,
+                GChecksum             *checksum,
+                GFileProgressCallback  progress_callback,
+                gpointer               progress_data)
+{
+    goffset copied, chunk_size, next_checkpoint;
+    ssize_t n;
+    gboolean use_copy_file_range G_GNUC_UNUSED;
+    gboolean use_sendfile G_GNUC_UNUSED;
+    char *buffer;
+
+#if HAVE_LINUX_FS_H && defined (FICLONE)
+    if (offset == 0 && checksum == NULL && ioctl (dest_fd, FICLONE, src_fd) == 0) {
+        if (progress_callback) {
+            progress_callback (size, size, progress_data);
+        }
+        return 0;
+    }
+#endif
+
+    copied = offset;
+    next_checkpoint = offset + COPY_JOURNAL_CHECKPOINT_SIZE;
+    chunk_size = io_throttle_get_chunk_size (throttle, NATIVE_COPY_CHUNK_SIZE);
+    use_copy_file_range = HAVE_COPY_FILE_RANGE && checksum == NULL;
+    use_sendfile = HAVE_SYS_SENDFILE_H && checksum == NULL;
+    buffer = NULL;
+
+    while (copied < size) {
+        if (g_cancellable_is_cancelled (cancellable)) {
+            if (journal != NULL) {
+                journal_checkpoint (journal, src, dest_fd, copied, size, src_mtime);
+            }
+            g_free (buffer);
+            return ECANCELED;
+        }
+
+        n = -1;
+#if HAVE_COPY_FILE_RANGE
+        if (use_copy_file_range) {
+            n = copy_file_range (src_fd, NULL, dest_fd, NULL,
+                                 MIN (size - copied, chunk_size), 0);
+            if (n < 0 && copied == offset &&
+                (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                 errno == EOPNOTSUPP || errno == EPERM)) {
+                use_copy_file_range = FALSE;
+                continue;
+            }
+        } else
+#endif
+#if HAVE_SYS_SENDFILE_H
+        if (use_sendfile) {
+            n = sendfile (dest_fd, src_fd, NULL,
+                          MIN (size - copied, chunk_size));
+            if (n < 0 && copied == offset &&
+                (errno == ENOSYS || errno == EINVAL)) {
+                use_sendfile = FALSE;
+                continue;
+            }
+        } else
+#endif
+        {
+            ssize_t written, total;
+
+            if (buffer == NULL) {
+                buffer = g_malloc (NATIVE_COPY_BUFFER_SIZE);
+            }
+
+            n = read (src_fd, buffer, NATIVE_COPY_BUFFER_SIZE);
+            if (checksum != NULL && n > 0) {
+                g_checksum_update (checksum, (guchar *) buffer, n);
+            }
+            for (total = 0; n > 0 && total < n; total += written) {
+                written = write (dest_fd, buffer + total, n - total);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        written = 0;
+                        continue;
+                    }
+                    n = -1;
+                    break;
+                }
+            }
+        }
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            g_free (buffer);
+            return errno;
+        }
+
+        if (n == 0) {
+            /* The file shrank while we were copying it */
+            break;
+        }
+
+        copied += n;
+
+        if (progress_callback) {
+            progress_callback (copied, size, progress_data);
+        }
+
+        io_throttle_account (throttle, n, cancellable);
+
+        if (journal != NULL && copied >= next_checkpoint) {
+            journal_checkpoint (journal, src, dest_fd, copied, size, src_mtime);
+            next_checkpoint = copied + COPY_JOURNAL_CHECKPOINT_SIZE;
+        }
+    }
+
+    g_free (buffer);
+    return 0;
+}
+
+/* Returns @offset if @dest_fd holds at least @offset bytes and the last
+ * of them match @src_fd, 0 if a journaled copy has to start over.
+ */
+static goffset
+verify_resume_offset (int     src_fd,
+                      int     dest_fd,
+                      goffset offset)
+{
+    struct stat dest_stat;
+    char *src_buf, *dest_buf;
+    gsize len;
+    gboolean same;
+
+    if (fstat (dest_fd, &dest_stat) != 0 || dest_stat.st_size < offset) {
+        return 0;
+    }
+
+    len = MIN (offset, COPY_JOURNAL_VERIFY_SIZE);
+    src_buf = g_malloc (len);
+    dest_buf = g_malloc (len);
+
+    same = pread (src_fd, src_buf, len, offset - len) == (ssize_t) len &&
+           pread (dest_fd, dest_buf, len, offset - len) == (ssize_t) len &&
+           memcmp (src_buf, dest_buf, len) == 0;
+
+    g_free (src_buf);
+    g_free (dest_buf);
+
+    return same ? offset : 0;
+}
+
+/* Local to local fast path for g_file_copy(). Only takes regular,
+ * non-empty files copied without G_FILE_COPY_OVERWRITE, unless the
+ * @journal has a partial copy to continue; everything else,
+ * and any case where we couldn't create the target, is left to GIO so
+ * error reporting and invalid file name handling stay the same.
+ */
+static NativeCopyResult
+native_copy_file (GFile                 *src,
+                  GFile                 *dest,
+                  GFileCopyFlags         flags,
+                  GCancellable          *cancellable,
+                  IOThrottle            *throttle,
+                  NemoCopyJournal       *journal,
+                  CopyVerifier          *verifier,
+                  GFileProgressCallback  progress_callback,
+                  gpointer               progress_data,
+                  GError               **error)
+{
+    gchar *src_path, *dest_path;
+    struct stat src_stat;
+    int src_fd, dest_fd;
+    mode_t mode;
+    int errsv;
+    goffset offset, recorded_size;
+    gint64 src_mtime, recorded_mtime;
+    GChecksum *checksum;
+    NativeCopyResult result;
+
+    /* A file an interrupted run of the job got partway through */
+    recorded_size = 0;
+    recorded_mtime = 0;
+    offset = journal != NULL ?
+             nemo_copy_journal_get_partial (journal, src, dest, &recorded_size, &recorded_mtime) : 0;
+
+    if (((flags & G_FILE_COPY_OVERWRITE) && offset == 0) ||
+        !g_file_is_native (src) || !g_file_is_native (dest)) {
+        return NATIVE_COPY_UNSUPPORTED;
+    }
+
+    src_path = g_file_get_path (src);
+    dest_path = g_file_get_path (dest);
+    result = NATIVE_COPY_UNSUPPORTED;
+    dest_fd = -1;
+    checksum = NULL;
+
+    src_fd = open (src_path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (src_fd < 0) {
+        goto out;
+    }
+
+    if (fstat (src_fd, &src_stat) != 0 ||
+        !S_ISREG (src_stat.st_mode) ||
+        src_stat.st_size == 0) {
+        goto out;
+    }
+
+    src_mtime = (gint64) src_stat.st_mtim.tv_sec * G_USEC_PER_SEC + src_stat.st_mtim.tv_nsec / 1000;
+
+    if (offset > 0 && offset <= src_stat.st_size) {
+        dest_fd = open (dest_path, O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+        if (dest_fd >= 0) {
+            /* A source changed since the checkpoint may differ anywhere
+             * before it, start over.
+             */
+            if (recorded_size != src_stat.st_size || recorded_mtime != src_mtime) {
+                offset = 0;
+            } else {
+                offset = verify_resume_offset (src_fd, dest_fd, offset);
+            }
+
+            if (ftruncate (dest_fd, offset) != 0 ||
+                lseek (src_fd, offset, SEEK_SET) != offset ||
+                lseek (dest_fd, offset, SEEK_SET) != offset) {
+                goto out;
+            }
+        }
+    }
+
+    if (dest_fd < 0) {
+        if (flags & G_FILE_COPY_OVERWRITE) {
+            goto out;
+        }
+
+        offset = 0;
+        mode = (flags & G_FILE_COPY_TARGET_DEFAULT_PERMS) ? 0666 : (src_stat.st_mode & 0777);
+
+        dest_fd = open (dest_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+        if (dest_fd < 0) {
+            if (errno == EEXIST) {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+                             _("Target file already exists"));
+                result = NATIVE_COPY_FAILED;
+            }
+            goto out;
+        }
+
+        if (journal != NULL) {
+            nemo_copy_journal_add_created (journal, src, dest);
+            journal_checkpoint (journal, src, dest_fd, 0, src_stat.st_size, src_mtime);
+        }
+    }
+
+    /* A resumed copy didn't hash what it wrote before, the verifier
+     * reads the source again instead.
+     */
+    if (verifier != NULL && offset == 0) {
+        checksum = g_checksum_new (COPY_VERIFY_CHECKSUM);
+    }
+
+    errsv = native_copy_fd (src_fd, dest_fd, offset, src_stat.st_size, src_mtime,
+                            cancellable, throttle, journal, src, checksum,
+                            progress_callback, progress_data);
+
+    if (close (dest_fd) != 0 && errsv == 0) {
+        errsv = errno;
+    }
+    dest_fd = -1;
+
+    if (errsv == 0) {
+        if (verifier != NULL) {
+            copy_verifier_queue (verifier, src, dest, checksum);
+        }
+        result = NATIVE_COPY_DONE;
+    } else {
+        /* The journal knows how much of it can be kept */
+        if (errsv != ECANCELED || journal == NULL) {
+            g_unlink (dest_path);
+        }
+
+        if (errsv == ECANCELED) {
+            g_cancellable_set_error_if_cancelled (cancellable, error);
+        } else {
+            set_native_copy_error (error, errsv, dest_path);
+        }
+        result = NATIVE_COPY_FAILED;
+    }
+
+ out:
+    if (dest_fd >= 0) {
+        close (dest_fd);
+    }
+    if (src_fd >= 0) {
+        close (src_fd);
+    }
+    if (checksum != NULL) {
+        g_checksum_free (checksum);
+    }
+    g_free (src_path);
+    g_free (dest_path);
+
+    return result;
+}
+
+static gboolean
+file_copy_wrapper (GFile                 *src,
+                   GFile                 *dest,
+                   GFileCopyFlags         flags,
+                   GCancellable          *cancellable,
+                   IOThrottle            *throttle,
+                   NemoCopyJournal       *journal,
+                   CopyVerifier          *verifier,
+                   GFileProgressCallback  progress_callback,
+                   gpointer               progress_data,
+                   GError               **error)
+{
+    ThrottledProgress throttled;
+    gboolean res;
+
+    switch (native_copy_file (src, dest, flags, cancellable, throttle, journal, verifier,
+                              progress_callback, progress_data, error)) {
+        case NATIVE_COPY_DONE:
+            return TRUE;
+        case NATIVE_COPY_FAILED:
+            return FALSE;
+        case NATIVE_COPY_UNSUPPORTED:
+        default:
+            if (throttle == NULL) {
+                res = g_file_copy (src, dest, flags, cancellable,
+                                   progress_callback, progress_data, error);
+            } else {
+                throttled.throttle = throttle;
+                throttled.cancellable = cancellable;
+                throttled.callback = progress_callback;
+                throttled.data = progress_data;
+                throttled.last_size = 0;
+
+                res = g_file_copy (src, dest, flags, cancellable,
+                                   throttled_progress_callback, &throttled, error);
+            }
+
+            /* So a resumed job doesn't take it for a conflict */
+            if (res && journal != NULL && !(flags & G_FILE_COPY_OVERWRITE)) {
+                nemo_copy_journal_add_created (journal, src, dest);
+            }
+
+            /* Links, devices and the like have nothing to read back */
+            if (res && verifier != NULL &&
+                g_file_query_file_type (src,
+                                        (flags & G_FILE_COPY_NOFOLLOW_SYMLINKS) ?
+                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS : 0,
+                                        cancellable) == G_FILE_TYPE_REGULAR) {
+                copy_verifier_queue (verifier, src, dest, NULL);
+            }
+
+            return res;
+    }
+}
+
+static void
+generate_initial_job_details (NemoProgressInfo *info,
+                              OpKind            kind,
+                              GList            *files,
+                              GFile            *destination)
+{
+    gchar *s = NULL;
+    gchar *dest_name = NULL;
+    gchar *src_name = NULL;
+
+    if (destination != NULL)
+        get_best_name (destination, &dest_name);
+
+    if (files != NULL)
+        get_parent_name (files->data, &src_name);
+
+    switch (kind) {
+        case OP_KIND_COPY:
+            g_return_if_fail (files != NULL);
+            g_return_if_fail (destination != NULL);
+
+            s = f (ngettext("Waiting to copy a file from '%1$s' to '%2$s'",
+                            "Waiting to copy files from '%1$s' to '%2$s'",
+                            g_list_length (files)),
+                            src_name, dest_name);
+            break;
+        case OP_KIND_MOVE:
+            g_return_if_fail (files != NULL);
+            g_return_if_fail (destination != NULL);
+
+            s = f (ngettext("Waiting to move a file from '%1$s' to '%2$s'",
+                            "Waiting to move files from '%1$s' to '%2$s'",
+                            g_list_length (files)),
+                            src_name, dest_name);
+            break;
+        case OP_KIND_DELETE:
+            g_return_if_fail (files != NULL);
+
+            s = f (ngettext("Waiting to permanently delete a file from '%s'",
+                            "Waiting to permanently delete files from '%s'",
+                            g_list_length (files)),
+                            src_name);
+            break;
+        case OP_KIND_TRASH:
+            g_return_if_fail (files != NULL);
+
+            s = f (ngettext("Waiting to trash a file in '%s'",
+                            "Waiting to trash files in '%s'",
+                            g_list_length (files)),
+                            src_name);
+            break;
+        case OP_KIND_EMPTY_TRASH:
+            s = f (_("Waiting to empty the trash"));
+            break;
+        case OP_KIND_DUPE:
+            g_return_if_fail (files != NULL);
+            g_return_if_fail (destination != NULL);
+
+            s = f (ngettext("Waiting to duplicate a file in '%s'",
+                            "Waiting to duplicate files in '%s'",
+                            g_list_length (files)),
+                            dest_name);
+            break;
+        case OP_KIND_PERMISSIONS:
+            g_return_if_fail (destination != NULL);
+
+            s = f (_("Waiting to change permissions of files in '%s'"), dest_name);
+            break;
+        case OP_KIND_LINK:
+            g_return_if_fail (files != NULL);
+            g_return_if_fail (destination != NULL);
+
+            s = f (ngettext("Waiting to link a file from '%1$s' to '%2$s'",
+                            "Waiting to link files from '%1$s' to '%2$s'",
+                            g_list_length (files)),
+                            src_name, dest_name);
+            break;
+        case OP_KIND_TRUST:
+        case OP_KIND_CREATE:
+        default:
+            break;
+    }
+    g_free (dest_name);
+    g_free (src_name);
+
+    nemo_progress_info_take_initial_details (info, s);
+}
+
+
+#define op_job_new(__type, parent_window) ((__type *)(init_common (sizeof(__type), parent_window)))
+
+static gpointer
+init_common (gsize job_size,
+	     GtkWindow *parent_window)
+{
+	CommonJob *common;
+
+	common = g_malloc0 (job_size);
+
+	if (parent_window) {
+		common->parent_window = parent_window;
+		g_object_add_weak_pointer (G_OBJECT (common->parent_window),
+					   (gpointer *) &common->parent_window);
+
+	}
+	common->progress = nemo_progress_info_new ();
+	common->cancellable = nemo_progress_info_get_cancellable (common->progress);
+	common->inhibit_cookie = -1;
+    common->monitor_num = 0;
+	if (parent_window) {
+        common->monitor_num = nemo_desktop_utils_get_monitor_for_widget (GTK_WIDGET (parent_window));
+	}
+
+	return common;
+}
+
+static void
+finalize_common (CommonJob *common)
+{
+	nemo_progress_info_finish (common->progress);
+
+	if (common->inhibit_cookie != -1) {
+		nemo_uninhibit_power_manager (common->inhibit_cookie);
+	}
+
+	common->inhibit_cookie = -1;
+
+	if (common->parent_window) {
+		g_object_remove_weak_pointer (G_OBJECT (common->parent_window),
+					      (gpointer *) &common->parent_window);
+	}
+
+	if (common->skip_files) {
+		g_hash_table_destroy (common->skip_files);
+	}
+	if (common->skip_readdir_error) {
+		g_hash_table_destroy (common->skip_readdir_error);
+	}
+
+	if (common->undo_info != NULL) {
+		nemo_file_undo_manager_set_action (common->undo_info);
+		g_object_unref (common->undo_info);
+	}
+
+	g_object_unref (common->progress);
+	g_object_unref (common->cancellable);
+	g_free (common);
+}
+
+static void
+skip_file (CommonJob *common,
+	   GFile *file)
+{
+	if (common->skip_files == NULL) {
+		common->skip_files =
+			g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
+	}
+
+	g_hash_table_insert (common->skip_files, g_object_ref (file), file);
+}
+
+static void
+skip_readdir_error (CommonJob *common,
+		    GFile *dir)
+{
+	if (common->skip_readdir_error == NULL) {
+		common->skip_readdir_error =
+			g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
+	}
+
+	g_hash_table_insert (common->skip_readdir_error, g_object_ref (dir), dir);
+}
+
+static gboolean
+should_skip_file (CommonJob *common,
+		  GFile *file)
+{
+	if (common->skip_files != NULL) {
+		return g_hash_table_lookup (common->skip_files, file) != NULL;
+	}
+	return FALSE;
+}
+
+static gboolean
+should_skip_readdir_error (CommonJob *common,
+			   GFile *dir)
+{
+	if (common->skip_readdir_error != NULL) {
+		return g_hash_table_lookup (common->skip_readdir_error, dir) != NULL;
+	}
+	return FALSE;
+}
+
+static gboolean
+can_delete_without_confirm (GFile *file)
+{
+	if (g_file_has_uri_scheme (file, "burn") ||
+        g_file_has_uri_scheme (file, "recent") ||
+        g_file_has_uri_scheme (file, "favorites") ||
+	    g_file_has_uri_scheme (file, "x-nemo-desktop")) {
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean
+can_delete_files_without_confirm (GList *files)
+{
+	g_assert (files != NULL);
+
+	while (files != NULL) {
+		if (!can_delete_without_confirm (files->data)) {
+			return FALSE;
+		}
+
+		files = files->next;
+	}
+
+	return TRUE;
+}
+
+typedef struct {
+	GtkWindow **parent_window;
+	gboolean ignore_close_box;
+	GtkMessageType message_type;
+	const char *primary_text;
+	const char *secondary_text;
+	const char *details_text;
+	const char **button_titles;
+	gboolean show_all;
+
+	int result;
+} RunSimpleDialogData;
+
+static gboolean
+do_run_simple_dialog (gpointer _data)
+{
+	RunSimpleDialogData *data = _data;
+	const char *button_title;
+        GtkWidget *dialog;
+	int result;
+	int response_id;
+
+	/* Create the dialog. */
+	dialog = gtk_message_dialog_new (*data->parent_window,
+					 0,
+					 data->message_type,
+					 GTK_BUTTONS_NONE,
+					 NULL);
+
+	g_object_set (dialog,
+		      "text", data->primary_text,
+		      "secondary-text", data->secondary_text,
+		      NULL);
 
 	for (response_id = 0;
 	     data->button_titles[response_id] != NULL;
@@ -1731,14 +2615,306 @@ report_delete_progress (CommonJob *job,
 		details = g_strconcat (files_left_s, "\xE2\x80\x94", time_left_s, NULL);
 		nemo_progress_info_take_details (job->progress, details);
 
-		g_free (time_left_s);
+		g_free (time_left_s);
+	}
+
+	g_free (files_left_s);
+
+	if (source_info->num_files != 0) {
+		nemo_progress_info_set_progress (job->progress, transfer_info->num_files, source_info->num_files);
+	}
+}
+
+/* Local folders are emptied straight through directory fds rather than a
+ * GFile and a GFileInfo per entry. Subfolders at any depth are emptied on
+ * a pool thread while one is free, and inline otherwise. No more tasks
+ * are handed out than the pool has threads, so a task waiting for its own
+ * subfolders never waits on one that can't start. Anything that can't be
+ * removed this way is left in place and the GIO path below takes over,
+ * so its error dialogs still apply.
+ */
+#define DELETE_MAX_THREADS 8
+#define DELETE_REPORT_INTERVAL_US (100 * 1000)
+
+typedef struct {
+	CommonJob *job;
+	SourceInfo *source_info;
+	TransferInfo *transfer_info;
+	int base_files;
+	GMutex mutex;
+	GCond cond;
+	gint n_deleted;
+} NativeDelete;
+
+/* Subfolders of one folder that are being emptied on the pool */
+typedef struct {
+	int n_pending;
+	gboolean failed;
+} NativeDeletePending;
+
+typedef struct {
+	NativeDelete *del;
+	NativeDeletePending *pending;
+	int parent_fd;
+	char *name;
+} NativeDeleteTask;
+
+static GThreadPool *native_delete_pool;
+static gint native_delete_max_tasks;
+static gint native_delete_n_tasks;
+
+static gboolean
+native_delete_contents (NativeDelete *del,
+			int           dir_fd,
+			gboolean      report);
+
+/* Only called from the job thread */
+static void
+native_delete_report (NativeDelete *del)
+{
+	del->transfer_info->num_files = del->base_files + g_atomic_int_get (&del->n_deleted);
+	report_delete_progress (del->job, del->source_info, del->transfer_info);
+}
+
+/* Takes one of the pool's threads, shared by all delete jobs */
+static gboolean
+native_delete_claim_task (void)
+{
+	gint n_tasks;
+
+	do {
+		n_tasks = g_atomic_int_get (&native_delete_n_tasks);
+		if (n_tasks >= native_delete_max_tasks) {
+			return FALSE;
+		}
+	} while (!g_atomic_int_compare_and_exchange (&native_delete_n_tasks, n_tasks, n_tasks + 1));
+
+	return TRUE;
+}
+
+static gboolean
+native_delete_subdir (NativeDelete *del,
+		      int           parent_fd,
+		      const char   *name,
+		      gboolean      report)
+{
+	int fd;
+	gboolean ok;
+
+	fd = openat (parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0) {
+		return FALSE;
+	}
+
+	ok = native_delete_contents (del, fd, report);
+
+	if (ok && unlinkat (parent_fd, name, AT_REMOVEDIR) != 0) {
+		ok = FALSE;
+	}
+
+	if (ok) {
+		g_atomic_int_inc (&del->n_deleted);
+	}
+
+	return ok;
+}
+
+static void
+native_delete_thread (gpointer data,
+		      gpointer user_data)
+{
+	NativeDeleteTask *task;
+	NativeDelete *del;
+	gboolean ok;
+
+	task = data;
+	del = task->del;
+
+	ok = native_delete_subdir (del, task->parent_fd, task->name, FALSE);
+
+	g_atomic_int_add (&native_delete_n_tasks, -1);
+
+	g_mutex_lock (&del->mutex);
+	if (!ok) {
+		task->pending->failed = TRUE;
+	}
+	task->pending->n_pending--;
+	g_cond_broadcast (&del->cond);
+	g_mutex_unlock (&del->mutex);
+
+	g_free (task->name);
+	g_free (task);
+}
+
+/* Removes everything inside @dir_fd, which is closed. Progress is only
+ * reported if @report, i.e. on the job thread.
+ */
+static gboolean
+native_delete_contents (NativeDelete *del,
+			int           dir_fd,
+			gboolean      report)
+{
+	NativeDeletePending pending = { 0 };
+	DIR *dir;
+	struct dirent *entry;
+	NativeDeleteTask *task;
+	gboolean ok, is_dir;
+	gint64 next_report;
+
+	dir = fdopendir (dir_fd);
+	if (dir == NULL) {
+		close (dir_fd);
+		return FALSE;
+	}
+
+	ok = TRUE;
+
+	while (ok && (entry = readdir (dir)) != NULL) {
+		if (strcmp (entry->d_name, ".") == 0 ||
+		    strcmp (entry->d_name, "..") == 0) {
+			continue;
+		}
+
+		if (job_aborted (del->job)) {
+			ok = FALSE;
+			break;
+		}
+
+		is_dir = entry->d_type == DT_DIR;
+
+		if (!is_dir) {
+			if (unlinkat (dirfd (dir), entry->d_name, 0) == 0) {
+				g_atomic_int_inc (&del->n_deleted);
+				if (report) {
+					native_delete_report (del);
+				}
+				continue;
+			}
+
+			/* Linux says EISDIR, POSIX allows EPERM */
+			if (entry->d_type != DT_UNKNOWN ||
+			    (errno != EISDIR && errno != EPERM)) {
+				ok = FALSE;
+				break;
+			}
+		}
+
+		if (native_delete_claim_task ()) {
+			task = g_new0 (NativeDeleteTask, 1);
+			task->del = del;
+			task->pending = &pending;
+			task->parent_fd = dirfd (dir);
+			task->name = g_strdup (entry->d_name);
+
+			g_mutex_lock (&del->mutex);
+			pending.n_pending++;
+			g_mutex_unlock (&del->mutex);
+
+			g_thread_pool_push (native_delete_pool, task, NULL);
+		} else {
+			ok = native_delete_subdir (del, dirfd (dir), entry->d_name, report);
+		}
+	}
+
+	/* The tasks use our fd, wait for them before closing it */
+	next_report = g_get_monotonic_time () + DELETE_REPORT_INTERVAL_US;
+
+	g_mutex_lock (&del->mutex);
+	while (pending.n_pending > 0) {
+		if (!report) {
+			g_cond_wait (&del->cond, &del->mutex);
+		} else if (!g_cond_wait_until (&del->cond, &del->mutex, next_report)) {
+			g_mutex_unlock (&del->mutex);
+			native_delete_report (del);
+			g_mutex_lock (&del->mutex);
+
+			next_report = g_get_monotonic_time () + DELETE_REPORT_INTERVAL_US;
+		}
+	}
+	ok = ok && !pending.failed;
+	g_mutex_unlock (&del->mutex);
+
+	closedir (dir);
+
+	return ok;
+}
+
+static gboolean
+has_favorites_below (XAppFavorites *favorites,
+		     const gchar   *uri)
+{
+	GList *infos, *iter;
+	gboolean found;
+
+	infos = xapp_favorites_get_favorites (favorites, NULL);
+	found = FALSE;
+
+	for (iter = infos; iter != NULL && !found; iter = iter->next) {
+		XAppFavoriteInfo *info = (XAppFavoriteInfo *) iter->data;
+
+		found = info->uri && g_str_has_prefix (info->uri, uri) && strcmp (info->uri, uri) != 0;
+	}
+
+	g_list_free_full (infos, (GDestroyNotify) xapp_favorite_info_free);
+
+	return found;
+}
+
+/* Returns TRUE if @dir is now empty. */
+static gboolean
+native_delete_dir_contents (CommonJob *job,
+			    GFile *dir,
+			    SourceInfo *source_info,
+			    TransferInfo *transfer_info)
+{
+	NativeDelete del = { 0 };
+	char *path, *uri;
+	int fd;
+	gboolean ok;
+
+	if (!g_file_is_native (dir) ||
+	    (job->skip_files != NULL && g_hash_table_size (job->skip_files) > 0) ||
+	    (job->skip_readdir_error != NULL && g_hash_table_size (job->skip_readdir_error) > 0)) {
+		return FALSE;
+	}
+
+	/* Favorites below @dir need removing one by one, leave that to GIO */
+	uri = g_file_get_uri (dir);
+	ok = !has_favorites_below (xapp_favorites_get_default (), uri);
+	g_free (uri);
+	if (!ok) {
+		return FALSE;
 	}
 
-	g_free (files_left_s);
+	path = g_file_get_path (dir);
+	fd = path != NULL ? open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC) : -1;
+	g_free (path);
+	if (fd < 0) {
+		return FALSE;
+	}
 
-	if (source_info->num_files != 0) {
-		nemo_progress_info_set_progress (job->progress, transfer_info->num_files, source_info->num_files);
+	if (native_delete_pool == NULL) {
+		native_delete_max_tasks = CLAMP (g_get_num_processors (), 2, DELETE_MAX_THREADS);
+		native_delete_pool = g_thread_pool_new (native_delete_thread, NULL,
+							native_delete_max_tasks,
+							FALSE, NULL);
 	}
+
+	del.job = job;
+	del.source_info = source_info;
+	del.transfer_info = transfer_info;
+	del.base_files = transfer_info->num_files;
+	g_mutex_init (&del.mutex);
+	g_cond_init (&del.cond);
+
+	ok = native_delete_contents (&del, fd, TRUE);
+
+	native_delete_report (&del);
+
+	g_mutex_clear (&del.mutex);
+	g_cond_clear (&del.cond);
+
+	return ok;
 }
 
 static void delete_file (CommonJob *job, GFile *file,
@@ -1765,6 +2941,11 @@ delete_dir (CommonJob *job, GFile *dir,
 
 	local_skipped_file = FALSE;
 
+	if (native_delete_dir_contents (job, dir, source_info, transfer_info)) {
+		error = NULL;
+		goto remove_dir;
+	}
+
 	skip_error = should_skip_readdir_error (job, dir);
  retry:
 	error = NULL;
@@ -1856,6 +3037,7 @@ delete_dir (CommonJob *job, GFile *dir,
 		}
 	}
 
+ remove_dir:
 	if (!job_aborted (job) &&
 	    /* Don't delete dir if there was a skipped file */
 	    !local_skipped_file) {
@@ -2051,6 +3233,202 @@ report_trash_progress (CommonJob *job,
 	}
 }
 
+/* Local files on the same filesystem as the home trash are moved
+ * there directly: one rename() and one .trashinfo write per file, with
+ * the trash folders opened once for the whole batch. Everything else,
+ * including any file this fails for, goes through g_file_trash().
+ */
+#define NATIVE_TRASH_MAX_TRIES 1000
+
+typedef struct {
+	char *path;
+	dev_t device;
+	int files_fd;
+	int info_fd;
+	char *deletion_date;
+	time_t deletion_time;
+} NativeTrash;
+
+static NativeTrash *
+native_trash_open (void)
+{
+	NativeTrash *trash;
+	char *files_path, *info_path;
+	struct stat trash_stat;
+
+	trash = g_new0 (NativeTrash, 1);
+	trash->path = g_build_filename (g_get_user_data_dir (), "Trash", NULL);
+	trash->files_fd = -1;
+	trash->info_fd = -1;
+
+	files_path = g_build_filename (trash->path, "files", NULL);
+	info_path = g_build_filename (trash->path, "info", NULL);
+
+	if (g_mkdir_with_parents (files_path, 0700) == 0 &&
+	    g_mkdir_with_parents (info_path, 0700) == 0 &&
+	    lstat (trash->path, &trash_stat) == 0) {
+		trash->device = trash_stat.st_dev;
+		trash->files_fd = open (files_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		trash->info_fd = open (info_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	}
+
+	g_free (files_path);
+	g_free (info_path);
+
+	return trash;
+}
+
+static void
+native_trash_close (NativeTrash *trash)
+{
+	if (trash->files_fd >= 0) {
+		close (trash->files_fd);
+	}
+	if (trash->info_fd >= 0) {
+		close (trash->info_fd);
+	}
+	g_free (trash->path);
+	g_free (trash->deletion_date);
+	g_free (trash);
+}
+
+static const char *
+native_trash_get_deletion_date (NativeTrash *trash)
+{
+	GDateTime *now;
+	time_t t;
+
+	t = time (NULL);
+	if (trash->deletion_date == NULL || t != trash->deletion_time) {
+		g_free (trash->deletion_date);
+		now = g_date_time_new_now_local ();
+		trash->deletion_date = g_date_time_format (now, "%Y-%m-%dT%H:%M:%S");
+		trash->deletion_time = t;
+		g_date_time_unref (now);
+	}
+
+	return trash->deletion_date;
+}
+
+/* Reserves a name in the trash by creating its .trashinfo, as GIO does. */
+static char *
+native_trash_write_info (NativeTrash *trash,
+			 const char *path)
+{
+	char *basename, *trashname, *infoname, *escaped, *data;
+	int fd, i;
+	gsize len;
+	gboolean written;
+
+	basename = g_path_get_basename (path);
+	escaped = g_uri_escape_string (path, "/", FALSE);
+	data = g_strdup_printf ("[Trash Info]\nPath=%s\nDeletionDate=%s\n",
+				escaped, native_trash_get_deletion_date (trash));
+	len = strlen (data);
+	trashname = NULL;
+
+	for (i = 1; i <= NATIVE_TRASH_MAX_TRIES; i++) {
+		trashname = i == 1 ? g_strdup (basename) : g_strdup_printf ("%s.%d", basename, i);
+		infoname = g_strconcat (trashname, ".trashinfo", NULL);
+
+		fd = openat (trash->info_fd, infoname, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+		if (fd >= 0) {
+			written = write (fd, data, len) == (gssize) len;
+			if (close (fd) != 0) {
+				written = FALSE;
+			}
+
+			/* A leftover in files/ without its info would get replaced by rename() */
+			if (written &&
+			    faccessat (trash->files_fd, trashname, F_OK, AT_SYMLINK_NOFOLLOW) != 0) {
+				g_free (infoname);
+				break;
+			}
+
+			unlinkat (trash->info_fd, infoname, 0);
+			if (!written) {
+				g_clear_pointer (&trashname, g_free);
+				g_free (infoname);
+				break;
+			}
+		} else if (errno != EEXIST) {
+			g_clear_pointer (&trashname, g_free);
+			g_free (infoname);
+			break;
+		}
+
+		g_clear_pointer (&trashname, g_free);
+		g_free (infoname);
+	}
+
+	g_free (basename);
+	g_free (escaped);
+	g_free (data);
+
+	return trashname;
+}
+
+static gboolean
+native_trash_file (NativeTrash *trash,
+		   GFile *file)
+{
+	struct stat file_stat;
+	char *path, *trashname, *infoname;
+	gboolean ok;
+
+	if (trash->files_fd < 0 || trash->info_fd < 0 ||
+	    !g_file_is_native (file)) {
+		return FALSE;
+	}
+
+	path = g_file_get_path (file);
+	if (path == NULL ||
+	    g_str_has_prefix (path, trash->path) ||
+	    lstat (path, &file_stat) != 0 ||
+	    file_stat.st_dev != trash->device) {
+		g_free (path);
+		return FALSE;
+	}
+
+	ok = FALSE;
+	trashname = native_trash_write_info (trash, path);
+
+	if (trashname != NULL) {
+		ok = renameat (AT_FDCWD, path, trash->files_fd, trashname) == 0;
+
+		if (!ok) {
+			infoname = g_strconcat (trashname, ".trashinfo", NULL);
+			unlinkat (trash->info_fd, infoname, 0);
+			g_free (infoname);
+		}
+	}
+
+	g_free (trashname);
+	g_free (path);
+
+	return ok;
+}
+
+static GList *
+get_favorite_uris (XAppFavorites *favorites)
+{
+	GList *infos, *iter, *uris;
+
+	infos = xapp_favorites_get_favorites (favorites, NULL);
+	uris = NULL;
+
+	for (iter = infos; iter != NULL; iter = iter->next) {
+		XAppFavoriteInfo *info = (XAppFavoriteInfo *) iter->data;
+
+		if (info->uri) {
+			uris = g_list_prepend (uris, g_strdup (info->uri));
+		}
+	}
+
+	g_list_free_full (infos, (GDestroyNotify) xapp_favorite_info_free);
+
+	return uris;
+}
 
 static void
 trash_files (CommonJob *job, GList *files, guint *files_skipped)
@@ -2062,6 +3440,10 @@ trash_files (CommonJob *job, GList *files, guint *files_skipped)
 	int total_files, files_trashed;
 	char *primary, *secondary, *details;
 	int response;
+	NativeTrash *native_trash;
+	XAppFavorites *favorites;
+	GList *favorite_uris;
+	gint64 last_report_time, now;
 
 	if (job_aborted (job)) {
 		return;
@@ -2071,6 +3453,11 @@ trash_files (CommonJob *job, GList *files, guint *files_skipped)
 	files_trashed = 0;
 
 	report_trash_progress (job, files_trashed, total_files);
+	last_report_time = g_get_monotonic_time ();
+
+	native_trash = native_trash_open ();
+	favorites = xapp_favorites_get_default ();
+	favorite_uris = get_favorite_uris (favorites);
 
 	to_delete = NULL;
 	for (l = files;
@@ -2080,7 +3467,8 @@ trash_files (CommonJob *job, GList *files, guint *files_skipped)
 
 		error = NULL;
 
-		if (!g_file_trash (file, job->cancellable, &error)) {
+		if (!native_trash_file (native_trash, file) &&
+		    !g_file_trash (file, job->cancellable, &error)) {
 			if (job->skip_all_error) {
 				(*files_skipped)++;
 				goto skip;
@@ -2127,35 +3515,21 @@ trash_files (CommonJob *job, GList *files, guint *files_skipped)
 		} else {
             gchar *uri = g_file_get_uri (file);
             if (!eel_uri_is_favorite (uri)) {
-                XAppFavorites *favorites = xapp_favorites_get_default ();
                 xapp_favorites_remove (favorites, uri);
 
                 // move-to-trash doesn't recurse, it just trashes the toplevel, and
                 // the recent backend (gvfs) takes care of the rest. If we trash a folder
                 // that was a favorite, which also had favorites that descended from it,
                 // we need to explicitly remove them, or we'll have dangling entries in the
-                // favorites list.
-
-                GList *to_remove, *infos, *iter;
+                // favorites list. The list is only fetched once for the whole batch.
 
-                infos = xapp_favorites_get_favorites (favorites, NULL);
-                to_remove = NULL;
+                GList *iter;
 
-                for (iter = infos; iter != NULL; iter = iter->next) {
-                    XAppFavoriteInfo *info = (XAppFavoriteInfo *) iter->data;
-
-                    if (info->uri && g_str_has_prefix (info->uri, uri)) {
-                        to_remove = g_list_prepend (to_remove, g_strdup (info->uri));
+                for (iter = favorite_uris; iter != NULL; iter = iter->next) {
+                    if (g_str_has_prefix ((const gchar *) iter->data, uri)) {
+                        xapp_favorites_remove (favorites, (const gchar *) iter->data);
                     }
                 }
-
-                g_list_free_full (infos, (GDestroyNotify) xapp_favorite_info_free);
-
-                for (iter = to_remove; iter != NULL; iter = iter->next) {
-                    xapp_favorites_remove (favorites, (const gchar *) iter->data);
-                }
-
-                g_list_free_full (to_remove, g_free);
             }
             g_free (uri);
 
@@ -2166,10 +3540,21 @@ trash_files (CommonJob *job, GList *files, guint *files_skipped)
 			}
 
 			files_trashed++;
-			report_trash_progress (job, files_trashed, total_files);
+
+			now = g_get_monotonic_time ();
+			if (now - last_report_time >= PROGRESS_UPDATE_THRESHOLD * US_PER_MS ||
+			    files_trashed == total_files) {
+				report_trash_progress (job, files_trashed, total_files);
+				last_report_time = now;
+			}
 		}
 	}
 
+	report_trash_progress (job, files_trashed, total_files);
+
+	g_list_free_full (favorite_uris, g_free);
+	native_trash_close (native_trash);
+
 	if (to_delete) {
 		to_delete = g_list_reverse (to_delete);
 		delete_files (job, to_delete, files_skipped);
@@ -2897,84 +4282,307 @@ scan_dir (GFile *dir,
 			primary = get_scan_primary (source_info->op);
 			details = NULL;
 
-			if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
-				secondary = f (_("Files in the folder \"%B\" cannot be handled because you do "
-						 "not have permissions to see them."), dir);
-			} else {
-				secondary = f (_("There was an error getting information about the files in the folder \"%B\"."), dir);
-				details = error->message;
-			}
+			if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
+				secondary = f (_("Files in the folder \"%B\" cannot be handled because you do "
+						 "not have permissions to see them."), dir);
+			} else {
+				secondary = f (_("There was an error getting information about the files in the folder \"%B\"."), dir);
+				details = error->message;
+			}
+
+			response = run_warning (job,
+						primary,
+						secondary,
+						details,
+						FALSE,
+						GTK_STOCK_CANCEL, RETRY, SKIP,
+						NULL);
+
+			g_error_free (error);
+
+			if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
+				abort_job (job);
+			} else if (response == 1) {
+				*source_info = saved_info;
+				goto retry;
+			} else if (response == 2) {
+				skip_readdir_error (job, dir);
+			} else {
+				g_assert_not_reached ();
+			}
+		}
+
+	} else if (job->skip_all_error) {
+		g_error_free (error);
+		skip_file (job, dir);
+	} else if (IS_IO_ERROR (error, CANCELLED)) {
+		g_error_free (error);
+	} else {
+		primary = get_scan_primary (source_info->op);
+		details = NULL;
+
+		if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
+			secondary = f (_("The folder \"%B\" cannot be handled because you do not have "
+					 "permissions to read it."), dir);
+		} else {
+			secondary = f (_("There was an error reading the folder \"%B\"."), dir);
+			details = error->message;
+		}
+		/* set show_all to TRUE here, as we don't know how many
+		 * files we'll end up processing yet.
+		 */
+		response = run_warning (job,
+					primary,
+					secondary,
+					details,
+					TRUE,
+					GTK_STOCK_CANCEL, SKIP_ALL, SKIP, RETRY,
+					NULL);
+
+		g_error_free (error);
+
+		if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
+			abort_job (job);
+		} else if (response == 1 || response == 2) {
+			if (response == 1) {
+				job->skip_all_error = TRUE;
+			}
+			skip_file (job, dir);
+		} else if (response == 3) {
+			goto retry;
+		} else {
+			g_assert_not_reached ();
+		}
+	}
+}
+
+/* Directories below a source are enumerated by several threads at
+ * once, since each readdir is mostly waiting on the disk or the
+ * network. The threads only count; a folder that can't be read is
+ * handed back to the job thread, which goes over it again with
+ * scan_dir() so the usual error dialogs are shown. One pool serves
+ * every source of a scan_sources() call.
+ */
+#define SCAN_MAX_THREADS 8
+#define SCAN_REPORT_INTERVAL_US (100 * 1000)
+
+typedef struct {
+	CommonJob *job;
+	GThreadPool *pool;
+	int n_threads;
+	GMutex mutex;
+	GCond cond;
+	GQueue dirs;
+	int n_workers; /* drain tasks pushed and not yet returned */
+	int n_busy;
+	GList *failed_dirs;
+	int num_files;
+	goffset num_bytes;
+} ParallelScan;
+
+static gboolean
+scan_dir_contents (ParallelScan *scan,
+		   GFile *dir,
+		   int *num_files,
+		   goffset *num_bytes,
+		   GList **subdirs)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	GError *error;
+
+	error = NULL;
+	enumerator = g_file_enumerate_children (dir,
+						G_FILE_ATTRIBUTE_STANDARD_NAME ","
+						G_FILE_ATTRIBUTE_STANDARD_TYPE","
+						G_FILE_ATTRIBUTE_STANDARD_SIZE,
+						G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+						scan->job->cancellable,
+						&error);
+	if (enumerator == NULL) {
+		g_error_free (error);
+		return FALSE;
+	}
+
+	while ((info = g_file_enumerator_next_file (enumerator, scan->job->cancellable, &error)) != NULL) {
+		*num_files += 1;
+		*num_bytes += g_file_info_get_size (info);
+
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+			*subdirs = g_list_prepend (*subdirs,
+						   g_file_get_child (dir, g_file_info_get_name (info)));
+		}
+
+		g_object_unref (info);
+	}
+	g_file_enumerator_close (enumerator, scan->job->cancellable, NULL);
+	g_object_unref (enumerator);
+
+	if (error != NULL) {
+		g_error_free (error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Pool task, drains scan->dirs together with the other workers */
+static void
+parallel_scan_thread (gpointer data,
+		      gpointer user_data)
+{
+	ParallelScan *scan;
+	GFile *dir;
+	GList *subdirs, *l;
+	int num_files;
+	goffset num_bytes;
+
+	scan = data;
+
+	g_mutex_lock (&scan->mutex);
+
+	while (!job_aborted (scan->job)) {
+		dir = g_queue_pop_head (&scan->dirs);
+
+		if (dir == NULL) {
+			if (scan->n_busy == 0) {
+				break;
+			}
+			g_cond_wait (&scan->cond, &scan->mutex);
+			continue;
+		}
+
+		scan->n_busy++;
+		g_mutex_unlock (&scan->mutex);
+
+		num_files = 0;
+		num_bytes = 0;
+		subdirs = NULL;
+
+		if (scan_dir_contents (scan, dir, &num_files, &num_bytes, &subdirs)) {
+			g_mutex_lock (&scan->mutex);
+			scan->num_files += num_files;
+			scan->num_bytes += num_bytes;
+			/* Push to head, since we want depth-first */
+			for (l = subdirs; l != NULL; l = l->next) {
+				g_queue_push_head (&scan->dirs, l->data);
+			}
+			g_list_free (subdirs);
+			g_object_unref (dir);
+		} else {
+			/* Counted again by scan_dir(), along with anything below it */
+			g_list_free_full (subdirs, g_object_unref);
+			g_mutex_lock (&scan->mutex);
+			scan->failed_dirs = g_list_prepend (scan->failed_dirs, dir);
+		}
+
+		scan->n_busy--;
+		g_cond_broadcast (&scan->cond);
+	}
+
+	/* Wake up the others, the queue is drained or the job is gone */
+	scan->n_workers--;
+	g_cond_broadcast (&scan->cond);
+	g_mutex_unlock (&scan->mutex);
+}
+
+static void
+parallel_scan_init (ParallelScan *scan,
+		    CommonJob *job)
+{
+	memset (scan, 0, sizeof (ParallelScan));
+	scan->job = job;
+	g_mutex_init (&scan->mutex);
+	g_cond_init (&scan->cond);
+	g_queue_init (&scan->dirs);
+}
+
+static void
+parallel_scan_clear (ParallelScan *scan)
+{
+	if (scan->pool != NULL) {
+		g_thread_pool_free (scan->pool, FALSE, TRUE);
+	}
+
+	g_mutex_clear (&scan->mutex);
+	g_cond_clear (&scan->cond);
+}
+
+/* Counts everything below @dirs. Directories that couldn't be read
+ * are left in @dirs for scan_dir().
+ */
+static void
+scan_dirs_parallel (ParallelScan *scan,
+		    GQueue *dirs,
+		    SourceInfo *source_info,
+		    CommonJob *job)
+{
+	GFile *dir;
+	int base_files;
+	goffset base_bytes;
+	int i;
+	gint64 next_report;
+
+	if (scan->pool == NULL) {
+		scan->n_threads = CLAMP (g_get_num_processors (), 2, SCAN_MAX_THREADS);
+		scan->pool = g_thread_pool_new (parallel_scan_thread, NULL,
+						scan->n_threads, FALSE, NULL);
+	}
+
+	g_mutex_lock (&scan->mutex);
+
+	while ((dir = g_queue_pop_tail (dirs)) != NULL) {
+		g_queue_push_head (&scan->dirs, dir);
+	}
 
-			response = run_warning (job,
-						primary,
-						secondary,
-						details,
-						FALSE,
-						GTK_STOCK_CANCEL, RETRY, SKIP,
-						NULL);
+	base_files = source_info->num_files;
+	base_bytes = source_info->num_bytes;
+	scan->num_files = 0;
+	scan->num_bytes = 0;
 
-			g_error_free (error);
+	for (i = 0; i < scan->n_threads; i++) {
+		scan->n_workers++;
+		g_thread_pool_push (scan->pool, scan, NULL);
+	}
 
-			if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
-				abort_job (job);
-			} else if (response == 1) {
-				*source_info = saved_info;
-				goto retry;
-			} else if (response == 2) {
-				skip_readdir_error (job, dir);
-			} else {
-				g_assert_not_reached ();
-			}
+	next_report = g_get_monotonic_time () + SCAN_REPORT_INTERVAL_US;
+
+	/* Workers return once the queue is drained or the job is aborted */
+	while (scan->n_workers > 0) {
+		if (g_cond_wait_until (&scan->cond, &scan->mutex, next_report)) {
+			continue;
 		}
 
-	} else if (job->skip_all_error) {
-		g_error_free (error);
-		skip_file (job, dir);
-	} else if (IS_IO_ERROR (error, CANCELLED)) {
-		g_error_free (error);
-	} else {
-		primary = get_scan_primary (source_info->op);
-		details = NULL;
+		source_info->num_files = base_files + scan->num_files;
+		source_info->num_bytes = base_bytes + scan->num_bytes;
 
-		if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
-			secondary = f (_("The folder \"%B\" cannot be handled because you do not have "
-					 "permissions to read it."), dir);
-		} else {
-			secondary = f (_("There was an error reading the folder \"%B\"."), dir);
-			details = error->message;
-		}
-		/* set show_all to TRUE here, as we don't know how many
-		 * files we'll end up processing yet.
-		 */
-		response = run_warning (job,
-					primary,
-					secondary,
-					details,
-					TRUE,
-					GTK_STOCK_CANCEL, SKIP_ALL, SKIP, RETRY,
-					NULL);
+		g_mutex_unlock (&scan->mutex);
+		report_count_progress (job, source_info);
+		g_mutex_lock (&scan->mutex);
 
-		g_error_free (error);
+		next_report = g_get_monotonic_time () + SCAN_REPORT_INTERVAL_US;
+	}
 
-		if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
-			abort_job (job);
-		} else if (response == 1 || response == 2) {
-			if (response == 1) {
-				job->skip_all_error = TRUE;
-			}
-			skip_file (job, dir);
-		} else if (response == 3) {
-			goto retry;
-		} else {
-			g_assert_not_reached ();
-		}
+	source_info->num_files = base_files + scan->num_files;
+	source_info->num_bytes = base_bytes + scan->num_bytes;
+
+	while ((dir = g_queue_pop_head (&scan->dirs)) != NULL) {
+		g_object_unref (dir);
+	}
+
+	while (scan->failed_dirs != NULL) {
+		g_queue_push_head (dirs, scan->failed_dirs->data);
+		scan->failed_dirs = g_list_delete_link (scan->failed_dirs, scan->failed_dirs);
 	}
+
+	g_mutex_unlock (&scan->mutex);
 }
 
 static void
 scan_file (GFile *file,
 	   SourceInfo *source_info,
-	   CommonJob *job)
+	   CommonJob *job,
+	   ParallelScan *scan)
 {
 	GFileInfo *info;
 	GError *error;
@@ -3050,6 +4658,10 @@ scan_file (GFile *file,
 		}
 	}
 
+	if (!job_aborted (job) && !g_queue_is_empty (dirs)) {
+		scan_dirs_parallel (scan, dirs, source_info, job);
+	}
+
 	while (!job_aborted (job) &&
 	       (dir = g_queue_pop_head (dirs)) != NULL) {
 		scan_dir (dir, source_info, job, dirs);
@@ -3067,6 +4679,7 @@ scan_sources (GList *files,
 	      CommonJob *job,
 	      OpKind kind)
 {
+	ParallelScan scan;
 	GList *l;
 	GFile *file;
 
@@ -3075,14 +4688,19 @@ scan_sources (GList *files,
 
 	report_count_progress (job, source_info);
 
+	parallel_scan_init (&scan, job);
+
 	for (l = files; l != NULL && !job_aborted (job); l = l->next) {
 		file = l->data;
 
 		scan_file (file,
 			   source_info,
-			   job);
+			   job,
+			   &scan);
 	}
 
+	parallel_scan_clear (&scan);
+
 	/* Make sure we report the final count */
 	report_count_progress (job, source_info);
 }
@@ -3246,44 +4864,70 @@ verify_destination (CommonJob *job,
 	g_object_unref (fsinfo);
 }
 
-static void
-report_copy_progress (CopyMoveJob *copy_job,
-		      SourceInfo *source_info,
-		      TransferInfo *transfer_info)
+static gboolean
+copy_progress_sample (gpointer user_data)
 {
-	int files_left;
-	goffset total_size;
+	CopyMoveJob *copy_job;
+	CopyProgress *counters;
+	int files_left, num_files, total_files;
+	goffset num_bytes, total_bytes, total_size;
 	double elapsed, transfer_rate;
 	int remaining_time;
-	guint64 now;
+	gboolean paused, backing_off;
 	CommonJob *job;
 	gboolean is_move;
+	gint seq;
 
+	copy_job = user_data;
 	job = (CommonJob *)copy_job;
+	counters = &copy_job->counters;
 
 	is_move = copy_job->is_move;
 
-	now = g_get_monotonic_time ();
+	/* Retry if the job thread was publishing meanwhile */
+	do {
+		seq = g_atomic_int_get (&counters->seq);
+		num_files = counters->num_files;
+		num_bytes = counters->num_bytes;
+		total_files = counters->total_files;
+		total_bytes = counters->total_bytes;
+	} while ((seq & 1) != 0 || seq != g_atomic_int_get (&counters->seq));
+
+	if (seq == 0) {
+		/* Nothing published yet */
+		return TRUE;
+	}
 
-	if (transfer_info->last_report_time != 0 &&
-	    ABS ((gint64)(transfer_info->last_report_time - now)) < PROGRESS_UPDATE_THRESHOLD * US_PER_MS) {
-		return;
+	num_files += g_atomic_int_get (&counters->worker_files);
+	num_bytes += g_atomic_int_get (&counters->worker_bytes);
+
+	paused = nemo_progress_info_get_is_paused (job->progress);
+	backing_off = io_throttle_is_backing_off (&copy_job->throttle);
+
+	if (num_files == counters->last_files &&
+	    num_bytes == counters->last_bytes &&
+	    paused == counters->last_paused &&
+	    backing_off == counters->last_backing_off) {
+		return TRUE;
 	}
-	transfer_info->last_report_time = now;
+	counters->last_files = num_files;
+	counters->last_bytes = num_bytes;
+	counters->last_paused = paused;
+	counters->last_backing_off = backing_off;
 
-	files_left = source_info->num_files - transfer_info->num_files;
+	files_left = total_files - num_files;
 
 	/* Races and whatnot could cause this to be negative... */
 	if (files_left < 0) {
 		files_left = 1;
 	}
 
-	if (files_left != transfer_info->last_reported_files_left ||
-	    transfer_info->last_reported_files_left == 0) {
+	if (files_left != counters->last_files_left ||
+	    counters->last_files_left == 0) {
 		/* Avoid changing this unless files_left changed since last time */
-		transfer_info->last_reported_files_left = files_left;
+		counters->last_files_left = files_left;
 
-		if (source_info->num_files == 1) {
+		if (total_files == 1) {
 			if (copy_job->destination != NULL) {
 				nemo_progress_info_take_status (job->progress,
 								    f (is_move ?
@@ -3306,15 +4950,15 @@ report_copy_progress (CopyMoveJob *copy_job,
 								       _("Moving file %'d of %'d (in \"%B\") to \"%B\"")
 								       :
 								       _("Copying file %'d of %'d (in \"%B\") to \"%B\""),
-								       transfer_info->num_files + 1,
-								       source_info->num_files,
+								       MIN (num_files + 1, total_files),
+								       total_files,
 								       (GFile *)copy_job->files->data,
 								       copy_job->destination));
 			} else {
 				nemo_progress_info_take_status (job->progress,
 								    f (_("Duplicating file %'d of %'d (in \"%B\")"),
-								       transfer_info->num_files + 1,
-								       source_info->num_files,
+								       MIN (num_files + 1, total_files),
+								       total_files,
 								       (GFile *)copy_job->files->data));
 			}
 		} else {
@@ -3324,44 +4968,49 @@ report_copy_progress (CopyMoveJob *copy_job,
 								       _("Moving file %'d of %'d to \"%B\"")
 								       :
 								       _ ("Copying file %'d of %'d to \"%B\""),
-								       transfer_info->num_files + 1,
-								       source_info->num_files,
+								       MIN (num_files + 1, total_files),
+								       total_files,
 								       copy_job->destination));
 			} else {
 				nemo_progress_info_take_status (job->progress,
 								    f (_("Duplicating file %'d of %'d"),
-								       transfer_info->num_files + 1,
-								       source_info->num_files));
+								       MIN (num_files + 1, total_files),
+								       total_files));
 			}
 		}
 	}
 
-	total_size = MAX (source_info->num_bytes, transfer_info->num_bytes);
+	total_size = MAX (total_bytes, num_bytes);
 
 	elapsed = nemo_progress_info_get_elapsed_time (job->progress);
 	transfer_rate = 0;
 	if (elapsed > 0) {
-		transfer_rate = transfer_info->num_bytes / elapsed;
+		transfer_rate = num_bytes / elapsed;
 	}
 
 	if (elapsed < SECONDS_NEEDED_FOR_RELIABLE_TRANSFER_RATE &&
 	    transfer_rate > 0) {
 		char *s;
 
-        if (nemo_progress_info_get_is_paused (job->progress)) {
+        if (paused) {
             s = g_strdup (_("Paused"));
         } else {
             /* To translators: %S will expand to a size like "2 bytes" or "3 MB", so something like "4 kb of 4 MB" */
-            s = f (_("%S of %S"), transfer_info->num_bytes, total_size);
+            s = f (_("%S of %S"), num_bytes, total_size);
         }
 
         nemo_progress_info_take_details (job->progress, s);
 	} else {
-        if (nemo_progress_info_get_is_paused (job->progress)) {
+        if (paused) {
             nemo_progress_info_take_details (job->progress, g_strdup (_("Paused")));
+        } else if (backing_off) {
+            /* To translators: %S will expand to a size like "2 bytes" or "3 MB" */
+            nemo_progress_info_take_details (job->progress,
+                                             f (_("%S of %S \xE2\x80\x94 slowed down while folders load"),
+                                                num_bytes, total_size));
         } else {
             char *s;
-            remaining_time = (total_size - transfer_info->num_bytes) / transfer_rate;
+            remaining_time = (total_size - num_bytes) / transfer_rate;
 
             /* To translators: %S will expand to a size like "2 bytes" or "3 MB", %T to a time duration like
              * "2 minutes". So the whole thing will be something like "2 kb of 4 MB -- 2 hours left (4kb/sec)"
@@ -3371,14 +5020,75 @@ report_copy_progress (CopyMoveJob *copy_job,
             s = f (ngettext ("%S of %S \xE2\x80\x94 %T left (%S/sec)",
                      "%S of %S \xE2\x80\x94 %T left (%S/sec)",
                      seconds_count_format_time_units (remaining_time)),
-                   transfer_info->num_bytes, total_size,
+                   num_bytes, total_size,
                    remaining_time,
                    (goffset)transfer_rate);
             nemo_progress_info_take_details (job->progress, s);
         }
     }
 
-	nemo_progress_info_set_progress (job->progress, transfer_info->num_bytes, total_size);
+	nemo_progress_info_update_progress (job->progress, num_bytes, total_size);
+
+	return TRUE;
+}
+
+/* Only called from the job thread. Formatting is left to
+ * copy_progress_sample (), this just publishes the counters and
+ * blocks while the job is paused.
+ */
+static void
+report_copy_progress (CopyMoveJob *copy_job,
+		      SourceInfo *source_info,
+		      TransferInfo *transfer_info)
+{
+	CopyProgress *counters;
+	guint64 now;
+
+	counters = &copy_job->counters;
+
+	g_atomic_int_inc (&counters->seq);
+	counters->num_files = transfer_info->num_files;
+	counters->num_bytes = transfer_info->num_bytes;
+	counters->total_files = source_info->num_files;
+	counters->total_bytes = source_info->num_bytes;
+	g_atomic_int_inc (&counters->seq);
+
+	now = g_get_monotonic_time ();
+
+	if (transfer_info->last_report_time != 0 &&
+	    ABS ((gint64)(transfer_info->last_report_time - now)) < PROGRESS_UPDATE_THRESHOLD * US_PER_MS) {
+		return;
+	}
+	transfer_info->last_report_time = now;
+
+	nemo_progress_info_wait_while_paused (copy_job->common.progress);
+}
+
+static void
+copy_progress_start (CopyMoveJob *copy_job)
+{
+	CopyProgress *counters;
+
+	counters = &copy_job->counters;
+	counters->last_files = -1;
+
+	counters->source = g_timeout_source_new (PROGRESS_SAMPLE_INTERVAL);
+	g_source_set_callback (counters->source, copy_progress_sample, copy_job, NULL);
+	g_source_attach (counters->source, NULL);
+}
+
+static void
+copy_progress_stop (CopyMoveJob *copy_job)
+{
+	CopyProgress *counters;
+
+	counters = &copy_job->counters;
+
+	if (counters->source != NULL) {
+		g_source_destroy (counters->source);
+		g_source_unref (counters->source);
+		counters->source = NULL;
+	}
 }
 
 static int
@@ -3782,43 +5492,295 @@ create_dest_dir (CommonJob *job,
 		primary = f (_("Error while copying."));
 		details = NULL;
 
-		if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
-			secondary = f (_("The folder \"%B\" cannot be copied because you do not have "
-					 "permissions to create it in the destination."), src);
-		} else {
-			secondary = f (_("There was an error creating the folder \"%B\"."), src);
-			details = error->message;
-		}
+		if (IS_IO_ERROR (error, PERMISSION_DENIED)) {
+			secondary = f (_("The folder \"%B\" cannot be copied because you do not have "
+					 "permissions to create it in the destination."), src);
+		} else {
+			secondary = f (_("There was an error creating the folder \"%B\"."), src);
+			details = error->message;
+		}
+
+		response = run_warning (job,
+					primary,
+					secondary,
+					details,
+					FALSE,
+					GTK_STOCK_CANCEL, SKIP, RETRY,
+					NULL);
+
+		g_error_free (error);
+
+		if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
+			abort_job (job);
+		} else if (response == 1) {
+			/* Skip: Do Nothing  */
+		} else if (response == 2) {
+			goto retry;
+		} else {
+			g_assert_not_reached ();
+		}
+		return CREATE_DEST_DIR_FAILED;
+	}
+	nemo_file_changes_queue_file_added (*dest);
+
+	if (job->undo_info != NULL) {
+		nemo_file_undo_info_ext_add_origin_target_pair (NEMO_FILE_UNDO_INFO_EXT (job->undo_info),
+								    src, *dest);
+	}
+
+	return CREATE_DEST_DIR_SUCCESS;
+}
+
+/* Small regular files inside a folder that is being copied are handed
+ * to a pool of worker threads, so that per-file latency overlaps
+ * instead of adding up. Workers only run g_file_copy(); the results are
+ * consumed on the job thread in the order the files were enumerated.
+ * Any file that didn't copy cleanly goes through copy_move_file() again,
+ * so conflicts and errors are reported one at a time exactly as before.
+ */
+#define PARALLEL_COPY_MAX_FILE_SIZE (1024 * 1024)
+#define PARALLEL_COPY_MAX_THREADS 8
+#define PARALLEL_COPY_BATCH_SIZE 256
+
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	int n_pending;
+	GPtrArray *items;
+} CopyBatch;
+
+typedef struct {
+	CopyBatch *batch;
+	GFile *src;
+	GFile *dest;
+	goffset size;
+	GFileCopyFlags flags;
+	GCancellable *cancellable;
+	IOThrottle *throttle;
+	NemoCopyJournal *journal;
+	CopyVerifier *verifier;
+	CopyProgress *counters;
+	NemoProgressInfo *progress;
+	gboolean copied;
+} CopyBatchItem;
+
+static void
+copy_batch_item_free (CopyBatchItem *item)
+{
+	g_object_unref (item->src);
+	g_object_unref (item->dest);
+	g_free (item);
+}
+
+static void
+parallel_copy_thread (gpointer data,
+		      gpointer user_data)
+{
+	CopyBatchItem *item;
+	CopyBatch *batch;
+	GError *error;
+	int old_io_priority;
+	gboolean dest_existed;
+
+	item = data;
+	batch = item->batch;
+
+	/* Hold queued files back while the job is paused, like the job
+	 * thread does between files. Cancelling also resumes.
+	 */
+	nemo_progress_info_wait_while_paused (item->progress);
+
+	/* Pool threads are shared, don't leave our priority behind */
+	old_io_priority = io_priority_set (item->throttle->io_priority);
+
+	/* GIO can fail on the source or on cancellation before it notices
+	 * the target exists, so the error alone doesn't tell us whose file
+	 * is there.
+	 */
+	dest_existed = g_file_query_file_type (item->dest,
+					       G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+					       NULL) != G_FILE_TYPE_UNKNOWN;
+
+	error = NULL;
+	item->copied = file_copy_wrapper (item->src, item->dest,
+					  item->flags,
+					  item->cancellable,
+					  item->throttle,
+					  item->journal,
+					  item->verifier,
+					  NULL, NULL,
+					  &error);
+	if (item->copied) {
+		/* Ignore errors here. Failure to copy metadata is not a hard error */
+		g_file_copy_attributes (item->src, item->dest,
+					item->flags | G_FILE_COPY_ALL_METADATA,
+					item->cancellable, NULL);
+
+		g_atomic_int_inc (&item->counters->worker_files);
+		g_atomic_int_add (&item->counters->worker_bytes, (gint) item->size);
+	} else {
+		/* Don't leave a partial file we created behind for the retry
+		 * to trip over. The native path already removed its own.
+		 */
+		if (!dest_existed && !IS_IO_ERROR (error, EXISTS)) {
+			g_file_delete (item->dest, NULL, NULL);
+		}
+		g_error_free (error);
+	}
+
+	io_priority_restore (old_io_priority);
+
+	g_mutex_lock (&batch->mutex);
+	if (--batch->n_pending == 0) {
+		g_cond_signal (&batch->cond);
+	}
+	g_mutex_unlock (&batch->mutex);
+}
+
+static GThreadPool *
+get_copy_pool (CopyMoveJob *copy_job)
+{
+	if (copy_job->copy_pool == NULL) {
+		copy_job->copy_pool = g_thread_pool_new (parallel_copy_thread, NULL,
+							 CLAMP (g_get_num_processors (), 2, PARALLEL_COPY_MAX_THREADS),
+							 FALSE, NULL);
+	}
+
+	return copy_job->copy_pool;
+}
+
+/* Returns TRUE if @src was queued on @batch, FALSE if the caller
+ * has to copy it itself.
+ */
+static gboolean
+queue_parallel_copy (CopyMoveJob *copy_job,
+		     CopyBatch **batch,
+		     GFile *src,
+		     GFileInfo *info,
+		     GFile *dest_dir,
+		     gboolean same_fs,
+		     const char *dest_fs_type,
+		     gboolean readonly_source_fs)
+{
+	CommonJob *job;
+	CopyBatchItem *item;
+
+	job = (CommonJob *)copy_job;
+
+	/* Anything an interrupted run touched takes the slow path */
+	if (copy_job->journal != NULL &&
+	    nemo_copy_journal_has_record (copy_job->journal, src)) {
+		return FALSE;
+	}
+
+	if (copy_job->is_move ||
+	    g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR ||
+	    g_file_info_get_size (info) > PARALLEL_COPY_MAX_FILE_SIZE ||
+	    should_skip_file (job, src)) {
+		return FALSE;
+	}
+
+	/* Desktop files may need marking as trusted, keep them on the slow path */
+	if (copy_job->desktop_location != NULL &&
+	    g_file_equal (copy_job->desktop_location, dest_dir)) {
+		return FALSE;
+	}
+
+	if (*batch == NULL) {
+		*batch = g_new0 (CopyBatch, 1);
+		g_mutex_init (&(*batch)->mutex);
+		g_cond_init (&(*batch)->cond);
+		(*batch)->items = g_ptr_array_new_with_free_func ((GDestroyNotify) copy_batch_item_free);
+	}
+
+	item = g_new0 (CopyBatchItem, 1);
+	item->batch = *batch;
+	item->src = g_object_ref (src);
+	item->dest = get_target_file (src, dest_dir, dest_fs_type, same_fs);
+	item->size = g_file_info_get_size (info);
+	item->flags = G_FILE_COPY_NOFOLLOW_SYMLINKS;
+	if (readonly_source_fs) {
+		item->flags |= G_FILE_COPY_TARGET_DEFAULT_PERMS;
+	}
+	item->cancellable = job->cancellable;
+	item->throttle = &copy_job->throttle;
+	item->journal = copy_job->journal;
+	item->verifier = copy_job->verifier;
+	item->counters = &copy_job->counters;
+	item->progress = job->progress;
+
+	g_ptr_array_add ((*batch)->items, item);
+
+	g_mutex_lock (&(*batch)->mutex);
+	(*batch)->n_pending++;
+	g_mutex_unlock (&(*batch)->mutex);
+
+	g_thread_pool_push (get_copy_pool (copy_job), item, NULL);
+
+	return TRUE;
+}
+
+/* Waits for every file in @batch and accounts for them in order. */
+static void
+finish_parallel_copy (CopyMoveJob *copy_job,
+		      CopyBatch *batch,
+		      GFile *dest_dir,
+		      gboolean same_fs,
+		      char **dest_fs_type,
+		      SourceInfo *source_info,
+		      TransferInfo *transfer_info,
+		      gboolean *skipped_file,
+		      gboolean readonly_source_fs)
+{
+	CommonJob *job;
+	CopyBatchItem *item;
+	guint i;
+
+	job = (CommonJob *)copy_job;
+
+	g_mutex_lock (&batch->mutex);
+	while (batch->n_pending > 0) {
+		g_cond_wait (&batch->cond, &batch->mutex);
+	}
+	g_mutex_unlock (&batch->mutex);
+
+	for (i = 0; i < batch->items->len; i++) {
+		item = g_ptr_array_index (batch->items, i);
+
+		if (item->copied) {
+			transfer_info->num_files ++;
+			transfer_info->num_bytes += item->size;
+			report_copy_progress (copy_job, source_info, transfer_info);
 
-		response = run_warning (job,
-					primary,
-					secondary,
-					details,
-					FALSE,
-					GTK_STOCK_CANCEL, SKIP, RETRY,
-					NULL);
+			/* Publish before taking it off the workers' count, so
+			 * the sampler never sees the file missing.
+			 */
+			g_atomic_int_add (&copy_job->counters.worker_files, -1);
+			g_atomic_int_add (&copy_job->counters.worker_bytes, - (gint) item->size);
 
-		g_error_free (error);
+			nemo_file_changes_queue_file_added (item->dest);
 
-		if (response == 0 || response == GTK_RESPONSE_DELETE_EVENT) {
-			abort_job (job);
-		} else if (response == 1) {
-			/* Skip: Do Nothing  */
-		} else if (response == 2) {
-			goto retry;
+			if (copy_job->journal != NULL) {
+				nemo_copy_journal_add_done (copy_job->journal, item->src, item->size);
+			}
+
+			if (job->undo_info != NULL) {
+				nemo_file_undo_info_ext_add_origin_target_pair (NEMO_FILE_UNDO_INFO_EXT (job->undo_info),
+										    item->src, item->dest);
+			}
+		} else if (job_aborted (job)) {
+			*skipped_file = TRUE;
 		} else {
-			g_assert_not_reached ();
+			copy_move_file (copy_job, item->src, dest_dir, same_fs, FALSE, dest_fs_type,
+					source_info, transfer_info, NULL, NULL, FALSE, skipped_file,
+					readonly_source_fs);
 		}
-		return CREATE_DEST_DIR_FAILED;
-	}
-	nemo_file_changes_queue_file_added (*dest);
-
-	if (job->undo_info != NULL) {
-		nemo_file_undo_info_ext_add_origin_target_pair (NEMO_FILE_UNDO_INFO_EXT (job->undo_info),
-								    src, *dest);
 	}
 
-	return CREATE_DEST_DIR_SUCCESS;
+	g_ptr_array_unref (batch->items);
+	g_mutex_clear (&batch->mutex);
+	g_cond_clear (&batch->cond);
+	g_free (batch);
 }
 
 /* a return value of FALSE means retry, i.e.
@@ -3851,6 +5813,7 @@ copy_move_directory (CopyMoveJob *copy_job,
 	gboolean local_skipped_file;
 	CommonJob *job;
 	GFileCopyFlags flags;
+	CopyBatch *batch;
 
 	job = (CommonJob *)copy_job;
 
@@ -3872,6 +5835,10 @@ copy_move_directory (CopyMoveJob *copy_job,
 				break;
 		}
 
+		if (copy_job->journal != NULL) {
+			nemo_copy_journal_add_created (copy_job->journal, src, *dest);
+		}
+
 		if (debuting_files) {
 			g_hash_table_replace (debuting_files, g_object_ref (*dest), GINT_TO_POINTER (TRUE));
 		}
@@ -3885,26 +5852,45 @@ copy_move_directory (CopyMoveJob *copy_job,
  retry:
 	error = NULL;
 	enumerator = g_file_enumerate_children (src,
-						G_FILE_ATTRIBUTE_STANDARD_NAME,
+						G_FILE_ATTRIBUTE_STANDARD_NAME ","
+						G_FILE_ATTRIBUTE_STANDARD_TYPE","
+						G_FILE_ATTRIBUTE_STANDARD_SIZE,
 						G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
 						job->cancellable,
 						&error);
 	if (enumerator) {
 		error = NULL;
+		batch = NULL;
 
 		while (!job_aborted (job) &&
 		       (info = g_file_enumerator_next_file (enumerator, job->cancellable, skip_error?NULL:&error)) != NULL) {
 			src_file = g_file_get_child (src,
 						     g_file_info_get_name (info));
-			copy_move_file (copy_job, src_file, *dest, same_fs, FALSE, &dest_fs_type,
-					source_info, transfer_info, NULL, NULL, FALSE, &local_skipped_file,
-					readonly_source_fs);
+			if (!queue_parallel_copy (copy_job, &batch, src_file, info, *dest, same_fs,
+						  dest_fs_type, readonly_source_fs)) {
+				copy_move_file (copy_job, src_file, *dest, same_fs, FALSE, &dest_fs_type,
+						source_info, transfer_info, NULL, NULL, FALSE, &local_skipped_file,
+						readonly_source_fs);
+			}
 			g_object_unref (src_file);
 			g_object_unref (info);
+
+			if (batch != NULL && batch->items->len >= PARALLEL_COPY_BATCH_SIZE) {
+				finish_parallel_copy (copy_job, batch, *dest, same_fs, &dest_fs_type,
+						      source_info, transfer_info, &local_skipped_file,
+						      readonly_source_fs);
+				batch = NULL;
+			}
 		}
 		g_file_enumerator_close (enumerator, job->cancellable, NULL);
 		g_object_unref (enumerator);
 
+		if (batch != NULL) {
+			finish_parallel_copy (copy_job, batch, *dest, same_fs, &dest_fs_type,
+					      source_info, transfer_info, &local_skipped_file,
+					      readonly_source_fs);
+		}
+
 		if (error && IS_IO_ERROR (error, CANCELLED)) {
 			g_error_free (error);
 		} else if (error) {
@@ -4393,6 +6379,60 @@ get_target_file_for_display_name (GFile *dir,
 }
 
 /* Debuting files is non-NULL only for toplevel items */
+/* Returns TRUE if an interrupted run of this job already finished or
+ * skipped @src, after accounting for it.
+ */
+static gboolean
+skip_journaled_file (CopyMoveJob *copy_job,
+		     GFile *src,
+		     SourceInfo *source_info,
+		     TransferInfo *transfer_info,
+		     gboolean *skipped_file)
+{
+	goffset size;
+
+	if (copy_job->journal == NULL) {
+		return FALSE;
+	}
+
+	if (nemo_copy_journal_lookup_done (copy_job->journal, src, &size)) {
+		transfer_info->num_files ++;
+		transfer_info->num_bytes += size;
+		report_copy_progress (copy_job, source_info, transfer_info);
+		return TRUE;
+	}
+
+	if (nemo_copy_journal_was_skipped (copy_job->journal, src)) {
+		*skipped_file = TRUE;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Whether an interrupted run of this job created @dest, or was told
+ * to replace it.
+ */
+static gboolean
+journal_may_overwrite_dest (CopyMoveJob *copy_job,
+			    GFile *src,
+			    GFile *dest)
+{
+	GFile *created;
+	gboolean ret;
+
+	if (copy_job->journal == NULL) {
+		return FALSE;
+	}
+
+	created = nemo_copy_journal_lookup_created (copy_job->journal, src);
+	ret = (created != NULL && g_file_equal (created, dest)) ||
+	      nemo_copy_journal_was_replaced (copy_job->journal, src, dest);
+	g_clear_object (&created);
+
+	return ret;
+}
+
 static void
 copy_move_file (CopyMoveJob *copy_job,
 		GFile *src,
@@ -4414,6 +6454,7 @@ copy_move_file (CopyMoveJob *copy_job,
 	char *primary, *secondary, *details;
 	int response;
 	ProgressData pdata;
+	ThrottledProgress throttled;
 	gboolean would_recurse, is_merge;
 	CommonJob *job;
 	gboolean res;
@@ -4428,6 +6469,10 @@ copy_move_file (CopyMoveJob *copy_job,
 		return;
 	}
 
+	if (skip_journaled_file (copy_job, src, source_info, transfer_info, skipped_file)) {
+		return;
+	}
+
     target_is_desktop = (copy_job->desktop_location != NULL &&
                          g_file_equal (copy_job->desktop_location, dest_dir));
 
@@ -4460,6 +6505,15 @@ copy_move_file (CopyMoveJob *copy_job,
 		dest = get_target_file (src, dest_dir, *dest_fs_type, same_fs);
 	}
 
+	/* Pick up where an interrupted run left off, even if it was renamed */
+	if (copy_job->journal != NULL) {
+		new_dest = nemo_copy_journal_lookup_created (copy_job->journal, src);
+		if (new_dest != NULL) {
+			g_object_unref (dest);
+			dest = new_dest;
+		}
+	}
+
 	/* Don't allow recursive move/copy into itself.
 	 * (We would get a file system error if we proceeded but it is nicer to
 	 * detect and report it at this level) */
@@ -4544,20 +6598,39 @@ copy_move_file (CopyMoveJob *copy_job,
 	pdata.source_info = source_info;
 	pdata.transfer_info = transfer_info;
 
-	if (copy_job->is_move) {
+	if (copy_job->is_move && same_fs) {
 		res = g_file_move (src, dest,
 				   flags,
 				   job->cancellable,
 				   copy_file_progress_callback,
 				   &pdata,
 				   &error);
-	} else {
-		res = g_file_copy (src, dest,
+	} else if (copy_job->is_move) {
+		/* A copy and delete behind, pace it like a copy. Renames
+		 * report their whole size too, so only here.
+		 */
+		throttled.throttle = &copy_job->throttle;
+		throttled.cancellable = job->cancellable;
+		throttled.callback = copy_file_progress_callback;
+		throttled.data = &pdata;
+		throttled.last_size = 0;
+
+		res = g_file_move (src, dest,
 				   flags,
 				   job->cancellable,
-				   copy_file_progress_callback,
-				   &pdata,
+				   throttled_progress_callback,
+				   &throttled,
 				   &error);
+	} else {
+		res = file_copy_wrapper (src, dest,
+					 flags,
+					 job->cancellable,
+					 &copy_job->throttle,
+					 copy_job->journal,
+					 copy_job->verifier,
+					 copy_file_progress_callback,
+					 &pdata,
+					 &error);
 	}
 
 	if (res) {
@@ -4571,6 +6644,10 @@ copy_move_file (CopyMoveJob *copy_job,
 		transfer_info->num_files ++;
 		report_copy_progress (copy_job, source_info, transfer_info);
 
+		if (copy_job->journal != NULL) {
+			nemo_copy_journal_add_done (copy_job->journal, src, pdata.last_size);
+		}
+
         if (debuting_files) {
             if (target_is_desktop && position) {
                 nemo_file_changes_queue_schedule_position_set (dest, *position, job->monitor_num);
@@ -4648,6 +6725,12 @@ copy_move_file (CopyMoveJob *copy_job,
 
 		g_error_free (error);
 
+		/* Left behind by an interrupted run of this job */
+		if (journal_may_overwrite_dest (copy_job, src, dest)) {
+			overwrite = TRUE;
+			goto retry;
+		}
+
 		if (unique_names || job->auto_rename_all) {
 			g_object_unref (dest);
 			dest = get_unique_target_file (src, dest_dir, same_fs, *dest_fs_type, unique_name_nr++);
@@ -4680,6 +6763,13 @@ copy_move_file (CopyMoveJob *copy_job,
 			if (resp->apply_to_all) {
 				job->skip_all_conflict = TRUE;
 			}
+			if (copy_job->journal != NULL) {
+				nemo_copy_journal_add_skipped (copy_job->journal, src);
+				if (resp->apply_to_all) {
+					nemo_copy_journal_add_apply_to_all (copy_job->journal,
+									    NEMO_COPY_JOURNAL_SKIP_ALL);
+				}
+			}
 			conflict_response_data_free (resp);
 		} else if (resp->id == CONFLICT_RESPONSE_REPLACE) { /* merge/replace */
 			if (resp->apply_to_all) {
@@ -4689,6 +6779,15 @@ copy_move_file (CopyMoveJob *copy_job,
 					job->replace_all = TRUE;
 				}
 			}
+			if (copy_job->journal != NULL) {
+				nemo_copy_journal_add_replaced (copy_job->journal, src, dest);
+				if (resp->apply_to_all) {
+					nemo_copy_journal_add_apply_to_all (copy_job->journal,
+									    is_a_merge ?
+									    NEMO_COPY_JOURNAL_MERGE_ALL :
+									    NEMO_COPY_JOURNAL_REPLACE_ALL);
+				}
+			}
 			overwrite = TRUE;
 			conflict_response_data_free (resp);
 			goto retry;
@@ -4701,6 +6800,10 @@ copy_move_file (CopyMoveJob *copy_job,
 		} else if (resp->id == CONFLICT_RESPONSE_AUTO_RENAME) {
 			if (resp->apply_to_all) {
 				job->auto_rename_all = TRUE;
+				if (copy_job->journal != NULL) {
+					nemo_copy_journal_add_apply_to_all (copy_job->journal,
+									    NEMO_COPY_JOURNAL_AUTO_RENAME_ALL);
+				}
 			}
 			unique_names = TRUE;
 			conflict_response_data_free (resp);
@@ -4917,9 +7020,69 @@ copy_files (CopyMoveJob *job,
 		i++;
 	}
 
+	if (job->copy_pool != NULL) {
+		g_thread_pool_free (job->copy_pool, FALSE, TRUE);
+		job->copy_pool = NULL;
+	}
+
 	g_free (dest_fs_type);
 }
 
+/* Starts a journal for a copy or move big enough to be worth resuming,
+ * or brings back the "apply to all" answers of an interrupted run.
+ */
+static void
+start_job_journal (CopyMoveJob *job,
+		   goffset num_bytes)
+{
+	CommonJob *common;
+	guint apply_to_all;
+
+	common = &job->common;
+
+	if (job->journal == NULL) {
+		if (job->destination != NULL &&
+		    num_bytes >= COPY_JOURNAL_MIN_JOB_SIZE) {
+			job->journal = nemo_copy_journal_new (job->is_move,
+							      job->files,
+							      job->destination);
+		}
+		return;
+	}
+
+	apply_to_all = nemo_copy_journal_get_apply_to_all (job->journal);
+
+	if (apply_to_all & NEMO_COPY_JOURNAL_SKIP_ALL) {
+		common->skip_all_conflict = TRUE;
+	}
+	if (apply_to_all & NEMO_COPY_JOURNAL_REPLACE_ALL) {
+		common->replace_all = TRUE;
+	}
+	if (apply_to_all & NEMO_COPY_JOURNAL_MERGE_ALL) {
+		common->merge_all = TRUE;
+	}
+	if (apply_to_all & NEMO_COPY_JOURNAL_AUTO_RENAME_ALL) {
+		common->auto_rename_all = TRUE;
+	}
+}
+
+static void
+finish_job_journal (CopyMoveJob *job)
+{
+	if (job->journal == NULL) {
+		return;
+	}
+
+	/* Cancelled jobs can be resumed in a later session */
+	if (job_aborted (&job->common)) {
+		nemo_copy_journal_close (job->journal);
+	} else {
+		nemo_copy_journal_discard (job->journal);
+	}
+
+	job->journal = NULL;
+}
+
 static gboolean
 copy_job_done (gpointer user_data)
 {
@@ -4951,6 +7114,54 @@ copy_job_done (gpointer user_data)
 	return FALSE;
 }
 
+/* Waits for the read-back of the copied files and tells the user about
+ * the ones that came out different.
+ */
+static void
+finish_copy_verification (CopyMoveJob *job)
+{
+	CommonJob *common;
+	GList *mismatches, *l;
+	GString *details;
+	char *name;
+	int n;
+
+	common = &job->common;
+
+	nemo_progress_info_take_status (common->progress,
+					f (_("Verifying copied files")));
+
+	mismatches = copy_verifier_finish (job->verifier);
+	job->verifier = NULL;
+
+	if (mismatches == NULL || job_aborted (common)) {
+		g_list_free_full (mismatches, g_object_unref);
+		return;
+	}
+
+	n = g_list_length (mismatches);
+	details = g_string_new (NULL);
+	for (l = mismatches; l != NULL; l = l->next) {
+		name = g_file_get_parse_name (l->data);
+		g_string_append_printf (details, "%s\n", name);
+		g_free (name);
+	}
+
+	run_warning (common,
+		     f (ngettext ("%'d copied file doesn't match its original.",
+				  "%'d copied files don't match their originals.",
+				  n), n),
+		     f (_("The data read back from the destination differs from the source. "
+			  "The copies may be damaged; check the destination disk before relying on them.")),
+		     details->str,
+		     FALSE,
+		     GTK_STOCK_OK,
+		     NULL);
+
+	g_string_free (details, TRUE);
+	g_list_free_full (mismatches, g_object_unref);
+}
+
 static gboolean
 copy_job (GIOSchedulerJob *io_job,
 	  GCancellable *cancellable,
@@ -4962,6 +7173,7 @@ copy_job (GIOSchedulerJob *io_job,
 	TransferInfo transfer_info;
 	char *dest_fs_id;
 	GFile *dest;
+	int old_io_priority;
 
 	job = user_data;
 	common = &job->common;
@@ -4969,6 +7181,9 @@ copy_job (GIOSchedulerJob *io_job,
 
 	dest_fs_id = NULL;
 
+	io_throttle_init (&job->throttle, job->files, job->destination);
+	old_io_priority = io_priority_set (job->throttle.io_priority);
+
     nemo_progress_info_start (common->progress);
 
 	scan_sources (job->files,
@@ -4997,17 +7212,35 @@ copy_job (GIOSchedulerJob *io_job,
 		goto aborted;
 	}
 
+	start_job_journal (job, source_info.num_bytes);
+
+	if (g_settings_get_boolean (nemo_preferences, NEMO_PREFERENCES_FILE_OPS_VERIFY_COPIES)) {
+		job->verifier = copy_verifier_new (common->cancellable);
+	}
+
 	nemo_progress_info_start (common->progress);
+	copy_progress_start (job);
 
 	memset (&transfer_info, 0, sizeof (transfer_info));
 	copy_files (job,
 		    dest_fs_id,
 		    &source_info, &transfer_info);
 
+	copy_progress_stop (job);
+
+	if (job->verifier != NULL) {
+		finish_copy_verification (job);
+	}
+
  aborted:
 
 	g_free (dest_fs_id);
 
+	finish_job_journal (job);
+
+	io_priority_restore (old_io_priority);
+	io_throttle_clear (&job->throttle);
+
 	g_io_scheduler_job_send_to_mainloop_async (io_job,
 						   copy_job_done,
 						   job,
@@ -5549,6 +7782,22 @@ move_job_done (gpointer user_data)
 	return FALSE;
 }
 
+/* Sources of a resumed move that were moved completely are gone */
+static void
+drop_moved_sources (CopyMoveJob *job)
+{
+	GList *l, *next;
+
+	for (l = job->files; l != NULL; l = next) {
+		next = l->next;
+
+		if (!g_file_query_exists (l->data, job->common.cancellable)) {
+			g_object_unref (l->data);
+			job->files = g_list_delete_link (job->files, l);
+		}
+	}
+}
+
 static gboolean
 move_job (GIOSchedulerJob *io_job,
 	  GCancellable *cancellable,
@@ -5562,6 +7811,7 @@ move_job (GIOSchedulerJob *io_job,
 	char *dest_fs_id;
 	char *dest_fs_type;
 	GList *fallback_files;
+	int old_io_priority;
 
 	job = user_data;
 	common = &job->common;
@@ -5572,8 +7822,18 @@ move_job (GIOSchedulerJob *io_job,
 
 	fallbacks = NULL;
 
+	io_throttle_init (&job->throttle, job->files, job->destination);
+	old_io_priority = io_priority_set (job->throttle.io_priority);
+
     nemo_progress_info_start (common->progress);
 
+	if (job->journal != NULL) {
+		drop_moved_sources (job);
+		if (job->files == NULL) {
+			goto aborted;
+		}
+	}
+
 	verify_destination (&job->common,
 			    job->destination,
 			    &dest_fs_id,
@@ -5611,18 +7871,29 @@ move_job (GIOSchedulerJob *io_job,
 		goto aborted;
 	}
 
+	start_job_journal (job, source_info.num_bytes);
+
+	copy_progress_start (job);
+
 	memset (&transfer_info, 0, sizeof (transfer_info));
 	move_files (job,
 		    fallbacks,
 		    dest_fs_id, &dest_fs_type,
 		    &source_info, &transfer_info);
 
+	copy_progress_stop (job);
+
  aborted:
 	g_list_free_full (fallbacks, g_free);
 
 	g_free (dest_fs_id);
 	g_free (dest_fs_type);
 
+	finish_job_journal (job);
+
+	io_priority_restore (old_io_priority);
+	io_throttle_clear (&job->throttle);
+
 	g_io_scheduler_job_send_to_mainloop (io_job,
 					     move_job_done,
 					     job,
@@ -5682,6 +7953,84 @@ nemo_file_operations_move (GList *files,
     add_job_to_job_queue (move_job, job, job->common.cancellable, job->common.progress, OP_KIND_MOVE);
 }
 
+static void
+resume_journaled_job (NemoCopyJournal *journal)
+{
+	CopyMoveJob *job;
+	OpKind kind;
+
+	job = op_job_new (CopyMoveJob, NULL);
+	job->is_move = nemo_copy_journal_is_move (journal);
+	job->desktop_location = nemo_get_desktop_location ();
+	job->files = eel_g_object_list_copy (nemo_copy_journal_get_sources (journal));
+	job->destination = g_object_ref (nemo_copy_journal_get_destination (journal));
+	job->debuting_files = g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
+	job->journal = journal;
+
+	kind = job->is_move ? OP_KIND_MOVE : OP_KIND_COPY;
+
+	inhibit_power_manager ((CommonJob *)job, job->is_move ? _("Moving Files") : _("Copying Files"));
+
+    generate_initial_job_details (job->common.progress, kind, job->files, job->destination);
+
+    add_job_to_job_queue (job->is_move ? move_job : copy_job,
+                          job, job->common.cancellable, job->common.progress, kind);
+}
+
+static void
+resume_dialog_response_cb (GtkDialog *dialog,
+			   int response_id,
+			   NemoCopyJournal *journal)
+{
+	if (response_id == GTK_RESPONSE_YES) {
+		resume_journaled_job (journal);
+	} else if (response_id == GTK_RESPONSE_CANCEL) {
+		nemo_copy_journal_abandon (journal);
+	} else {
+		/* Closed without an answer, ask again next time */
+		nemo_copy_journal_close (journal);
+	}
+
+	gtk_widget_destroy (GTK_WIDGET (dialog));
+}
+
+void
+nemo_file_operations_offer_resume (GtkWindow *parent_window)
+{
+	NemoCopyJournal *journal;
+	GtkDialog *dialog;
+	GList *paths, *l;
+	char *primary;
+
+	paths = nemo_copy_journal_list_pending ();
+
+	for (l = paths; l != NULL; l = l->next) {
+		/* Skips journals of jobs still running elsewhere */
+		journal = nemo_copy_journal_open (l->data);
+		if (journal == NULL) {
+			continue;
+		}
+
+		primary = f (nemo_copy_journal_is_move (journal) ?
+			     _("Resume moving files to \"%B\"?") :
+			     _("Resume copying files to \"%B\"?"),
+			     nemo_copy_journal_get_destination (journal));
+
+		dialog = eel_show_yes_no_dialog (primary,
+						 _("The operation was interrupted before it finished. "
+						   "Files that were already done are not copied again. "
+						   "If you discard it, partly copied files are deleted."),
+						 _("_Resume"), _("_Discard"),
+						 parent_window);
+		g_signal_connect (dialog, "response",
+				  G_CALLBACK (resume_dialog_response_cb), journal);
+
+		g_free (primary);
+	}
+
+	g_list_free_full (paths, g_free);
+}
+
 static void
 report_link_progress (CopyMoveJob *link_job, int total, int left)
 {
@@ -7243,6 +9592,87 @@ job_is_small (GList *files)
     return ret;
 }
 
+static gboolean
+add_job_device (GPtrArray *devices,
+                GFile     *location)
+{
+    NemoFile *file;
+    gchar *fs_id;
+    guint i;
+
+    file = nemo_file_get_existing (location);
+
+    if (file == NULL)
+        return FALSE;
+
+    fs_id = nemo_file_get_filesystem_id (file);
+    nemo_file_unref (file);
+
+    if (fs_id == NULL)
+        return FALSE;
+
+    for (i = 0; i < devices->len; i++) {
+        if (g_strcmp0 (g_ptr_array_index (devices, i), fs_id) == 0) {
+            g_free (fs_id);
+            return TRUE;
+        }
+    }
+
+    g_ptr_array_add (devices, fs_id);
+
+    return TRUE;
+}
+
+/* Returns the filesystems the job reads from and writes to, or NULL
+ * if any of them isn't known yet, in which case the queue runs the job
+ * on its own.
+ */
+static gchar **
+get_job_devices (OpKind kind, gpointer op_data)
+{
+    GPtrArray *devices;
+    GList *files, *l;
+    GFile *destination;
+    gboolean known;
+
+    switch (kind) {
+        case OP_KIND_COPY:
+        case OP_KIND_MOVE:
+        case OP_KIND_DUPE:
+            files = ((CopyMoveJob *) op_data)->files;
+            destination = ((CopyMoveJob *) op_data)->destination;
+            break;
+        case OP_KIND_DELETE:
+        case OP_KIND_TRASH:
+            files = ((DeleteJob *) op_data)->files;
+            destination = NULL;
+            break;
+        default:
+            return NULL;
+    }
+
+    devices = g_ptr_array_new_with_free_func (g_free);
+    known = files != NULL;
+
+    for (l = files; l != NULL && known; l = l->next) {
+        known = add_job_device (devices, G_FILE (l->data));
+    }
+
+    if (known && destination != NULL) {
+        known = add_job_device (devices, destination);
+    }
+
+    if (!known) {
+        g_ptr_array_unref (devices);
+        return NULL;
+    }
+
+    g_ptr_array_set_free_func (devices, NULL);
+    g_ptr_array_add (devices, NULL);
+
+    return (gchar **) g_ptr_array_free (devices, FALSE);
+}
+
 static gboolean
 should_start_immediately (OpKind kind, gpointer op_data)
 {
@@ -7305,17 +9735,22 @@ add_job_to_job_queue (GIOSchedulerJobFunc job_func,
                                   OpKind  kind)
 {
     gboolean start_immediately;
+    gchar **devices;
 
     NemoJobQueue *job_queue = nemo_job_queue_get ();
 
     start_immediately = should_start_immediately (kind, user_data);
+    devices = get_job_devices (kind, user_data);
 
     nemo_job_queue_add_new_job (job_queue,
                                 job_func,
                                 user_data,
                                 cancellable,
                                 info,
+                                (const gchar * const *) devices,
                                 start_immediately);
+
+    g_strfreev (devices);
 }
 
 
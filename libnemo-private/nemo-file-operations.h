@@ -63,6 +63,8 @@ void nemo_file_operations_copy_file (GFile *source_file,
 					 NemoCopyCallback done_callback,
 					 gpointer done_callback_data);
 void nemo_file_operations_empty_trash (GtkWidget                 *parent_view);
+/* Asks whether to continue copies and moves an earlier session didn't finish */
+void nemo_file_operations_offer_resume (GtkWindow                 *parent_window);
 void nemo_file_operations_new_folder  (GtkWidget                 *parent_view,
 					   GdkPoint                  *target_point,
 					   const char                *parent_dir_uri,
@@ -44,6 +44,34 @@ typedef enum {
 	UNKNOWN
 } Knowledge;
 
+/* Fields that most files never set. They live in a side struct that is
+ * only allocated on the first write, so the common case doesn't pay
+ * for them. Read them through nemo_file_peek_rare_details(), which
+ * returns the defaults for files without one.
+ */
+typedef struct {
+	char *symlink_name;
+	char *description;
+
+	char *trash_orig_path;
+	time_t trash_time; /* 0 is unknown */
+
+	guint deep_directory_count;
+	guint deep_file_count;
+	guint deep_unreadable_count;
+	guint deep_hidden_count;
+	goffset deep_size;
+
+	guint64 free_space; /* (guint)-1 for unknown */
+	time_t free_space_read; /* The time free_space was updated, or 0 for never */
+
+	GHashTable *search_results;
+
+	gint desktop_monitor;
+	gint cached_position_x;
+	gint cached_position_y;
+} NemoFileRareDetails;
+
 typedef enum {
     FILE_META_STATE_INIT = -1,
     FILE_META_STATE_FALSE = 0,
@@ -80,27 +108,15 @@ struct NemoFileDetails
 	time_t ctime; /* 0 is unknown */
     time_t btime; /* 0 is unknown */
 	
-	char *symlink_name;
-	
 	GRefString *mime_type;
 	
-	char *selinux_context;
-	char *description;
-	
 	GError *get_info_error;
 	
 	guint directory_count;
 
-	guint deep_directory_count;
-	guint deep_file_count;
-	guint deep_unreadable_count;
-    guint deep_hidden_count;
-	goffset deep_size;
-
 	GIcon *icon;
 
 	char *thumbnail_path;
-    eel_boolean_bit thumbnail_access_problem : 1;
 	GdkPixbuf *thumbnail;
 	time_t thumbnail_mtime;
     gint thumbnail_throttle_count;
@@ -108,8 +124,6 @@ struct NemoFileDetails
 
 	GList *mime_list; /* If this is a directory, the list of MIME types in it. */
 
-    GHashTable *search_results;
-
 	/* Info you might get from a link (.desktop, .directory or nemo link) */
 	GIcon *custom_icon;
 	char *activation_uri;
@@ -119,7 +133,8 @@ struct NemoFileDetails
 	 */
 	GRefString *filesystem_id;
 
-	char *trash_orig_path;
+	/* Set for every file on SELinux systems, and shared by most of them */
+	GRefString *selinux_context;
 
 	/* The following is for file operations in progress. Since
 	 * there are normally only a few of these, we can move them to
@@ -185,6 +200,7 @@ struct NemoFileDetails
 	eel_boolean_bit thumbnail_wants_original      : 1;
 	eel_boolean_bit thumbnail_tried_original      : 1;
 	eel_boolean_bit thumbnailing_failed           : 1;
+	eel_boolean_bit thumbnail_access_problem      : 1;
 	
 	eel_boolean_bit is_thumbnailing               : 1;
 
@@ -228,14 +244,7 @@ struct NemoFileDetails
     NemoFileMetaState pinning;
     NemoFileMetaState favorite;
 
-	time_t trash_time; /* 0 is unknown */
-
-	guint64 free_space; /* (guint)-1 for unknown */
-	time_t free_space_read; /* The time free_space was updated, or 0 for never */
-
-    gint desktop_monitor;
-    gint cached_position_x;
-    gint cached_position_y;
+	NemoFileRareDetails *rare;
 };
 
 typedef struct {
@@ -253,6 +262,8 @@ typedef struct {
 NemoFile *nemo_file_new_from_info                  (NemoDirectory      *directory,
 							    GFileInfo              *info);
 void          nemo_file_emit_changed                   (NemoFile           *file);
+const NemoFileRareDetails *nemo_file_peek_rare_details (NemoFile           *file);
+NemoFileRareDetails *nemo_file_get_rare_details        (NemoFile           *file);
 void          nemo_file_mark_gone                      (NemoFile           *file);
 
 void          nemo_file_set_directory                  (NemoFile           *file,
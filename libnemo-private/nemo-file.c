@@ -186,17 +186,52 @@ nemo_file_init (NemoFile *file)
 {
 	file->details = G_TYPE_INSTANCE_GET_PRIVATE ((file), NEMO_TYPE_FILE, NemoFileDetails);
 
-    file->details->desktop_monitor = -1;
-    file->details->cached_position_x = -1;
-    file->details->cached_position_y = -1;
     file->details->pinning = FILE_META_STATE_INIT;
     file->details->favorite = FILE_META_STATE_INIT;
     file->details->load_deferred_attrs = NEMO_FILE_LOAD_DEFERRED_ATTRS_NO;
 
 	nemo_file_clear_info (file);
 	nemo_file_invalidate_extension_info_internal (file);
+}
+
+static const NemoFileRareDetails rare_details_defaults = {
+	.free_space = (guint64) -1,
+	.desktop_monitor = -1,
+	.cached_position_x = -1,
+	.cached_position_y = -1,
+};
+
+/* Read access to the rarely set fields. Never allocates. */
+const NemoFileRareDetails *
+nemo_file_peek_rare_details (NemoFile *file)
+{
+	if (file->details->rare == NULL) {
+		return &rare_details_defaults;
+	}
+
+	return file->details->rare;
+}
 
-	file->details->free_space = -1;
+/* Write access to the rarely set fields, allocating them on first use. */
+NemoFileRareDetails *
+nemo_file_get_rare_details (NemoFile *file)
+{
+	if (file->details->rare == NULL) {
+		file->details->rare = g_new (NemoFileRareDetails, 1);
+		*file->details->rare = rare_details_defaults;
+	}
+
+	return file->details->rare;
+}
+
+static void
+rare_details_free (NemoFileRareDetails *rare)
+{
+	g_free (rare->symlink_name);
+	g_free (rare->description);
+	g_free (rare->trash_orig_path);
+	g_clear_pointer (&rare->search_results, g_hash_table_destroy);
+	g_free (rare);
 }
 
 static GObject*
@@ -265,8 +300,8 @@ nemo_file_set_display_name (NemoFile *file,
 			file->details->display_name = g_ref_string_new (display_name);
 		}
 
-		g_free (file->details->display_name_collation_key);
-		file->details->display_name_collation_key = g_utf8_collate_key_for_filename (display_name, -1);
+		/* Recomputed on first use, most folders are never sorted by name */
+		g_clear_pointer (&file->details->display_name_collation_key, g_free);
 	}
 
 	if (g_strcmp0 (file->details->edit_name, edit_name) != 0) {
@@ -501,21 +536,24 @@ nemo_file_clear_info (NemoFile *file)
 	file->details->atime = 0;
 	file->details->ctime = 0;
     file->details->btime = 0;
-	file->details->trash_time = 0;
     file->details->load_deferred_attrs = NEMO_FILE_LOAD_DEFERRED_ATTRS_NO;
-	g_free (file->details->symlink_name);
-	file->details->symlink_name = NULL;
     g_clear_pointer (&file->details->mime_type, g_ref_string_release);
-    g_clear_pointer (&file->details->selinux_context, g_free);
-    g_clear_pointer (&file->details->description, g_free);
     g_clear_pointer (&file->details->owner, g_ref_string_release);
     g_clear_pointer (&file->details->owner_real, g_ref_string_release);
     g_clear_pointer (&file->details->group, g_ref_string_release);
     g_clear_pointer (&file->details->filesystem_id, g_ref_string_release);
+    g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
 
     file->details->is_desktop_orphan = FALSE;
 
-    file->details->desktop_monitor = -1;
+	if (file->details->rare != NULL) {
+		NemoFileRareDetails *rare = file->details->rare;
+
+		rare->trash_time = 0;
+		g_clear_pointer (&rare->symlink_name, g_free);
+		g_clear_pointer (&rare->description, g_free);
+		rare->desktop_monitor = -1;
+	}
 
 	clear_metadata (file);
 }
@@ -572,7 +610,7 @@ modify_link_hash_table (NemoFile *file,
 	GList **list_ptr;
 
 	/* Check if there is a symlink name. If none, we are OK. */
-	if (file->details->symlink_name == NULL) {
+	if (nemo_file_peek_rare_details (file)->symlink_name == NULL) {
 		return;
 	}
 
@@ -817,13 +855,10 @@ finalize (GObject *object)
 		g_object_unref (file->details->icon);
 	}
 	g_free (file->details->thumbnail_path);
-	g_free (file->details->symlink_name);
 	g_clear_pointer (&file->details->mime_type, g_ref_string_release);
 	g_clear_pointer (&file->details->owner, g_ref_string_release);
 	g_clear_pointer (&file->details->owner_real, g_ref_string_release);
 	g_clear_pointer (&file->details->group, g_ref_string_release);
-	g_free (file->details->selinux_context);
-	g_free (file->details->description);
 	g_free (file->details->activation_uri);
 	g_clear_object (&file->details->custom_icon);
 
@@ -835,7 +870,8 @@ finalize (GObject *object)
 	}
 
 	g_clear_pointer (&file->details->filesystem_id, g_ref_string_release);
-	g_free (file->details->trash_orig_path);
+	g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
+	g_clear_pointer (&file->details->rare, rare_details_free);
 
 	g_list_free_full (file->details->mime_list, g_free);
 	g_list_free_full (file->details->pending_extension_emblems, g_free);
@@ -2294,6 +2330,7 @@ update_info_internal (NemoFile *file,
 	const char *group, *owner, *owner_real;
 	gboolean free_owner, free_group;
     const char *edit_name;
+	NemoFileRareDetails *rare;
 
 	if (file->details->is_gone) {
 		return FALSE;
@@ -2630,24 +2667,28 @@ update_info_internal (NemoFile *file,
 
     symlink_name = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET);
 
-	if (g_strcmp0 (file->details->symlink_name, symlink_name) != 0) {
+	if (g_strcmp0 (nemo_file_peek_rare_details (file)->symlink_name, symlink_name) != 0) {
+		rare = nemo_file_get_rare_details (file);
 		changed = TRUE;
-		g_free (file->details->symlink_name);
-		file->details->symlink_name = g_strdup (symlink_name);
+		g_free (rare->symlink_name);
+		rare->symlink_name = g_strdup (symlink_name);
 	}
 
 	selinux_context = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_SELINUX_CONTEXT);
 	if (g_strcmp0 (file->details->selinux_context, selinux_context) != 0) {
 		changed = TRUE;
-		g_free (file->details->selinux_context);
-		file->details->selinux_context = g_strdup (selinux_context);
+		g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
+		if (selinux_context != NULL) {
+			file->details->selinux_context = g_ref_string_new_intern (selinux_context);
+		}
 	}
 
 	description = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_DESCRIPTION);
-	if (g_strcmp0 (file->details->description, description) != 0) {
+	if (g_strcmp0 (nemo_file_peek_rare_details (file)->description, description) != 0) {
+		rare = nemo_file_get_rare_details (file);
 		changed = TRUE;
-		g_free (file->details->description);
-		file->details->description = g_strdup (description);
+		g_free (rare->description);
+		rare->description = g_strdup (description);
 	}
 
 	filesystem_id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
@@ -2663,16 +2704,17 @@ update_info_internal (NemoFile *file,
 		g_time_val_from_iso8601 (time_string, &g_trash_time);
 		trash_time = g_trash_time.tv_sec;
 	}
-	if (file->details->trash_time != trash_time) {
+	if (nemo_file_peek_rare_details (file)->trash_time != trash_time) {
 		changed = TRUE;
-		file->details->trash_time = trash_time;
+		nemo_file_get_rare_details (file)->trash_time = trash_time;
 	}
 
 	trash_orig_path = g_file_info_get_attribute_byte_string (info, "trash::orig-path");
-	if (g_strcmp0 (file->details->trash_orig_path, trash_orig_path) != 0) {
+	if (g_strcmp0 (nemo_file_peek_rare_details (file)->trash_orig_path, trash_orig_path) != 0) {
+		rare = nemo_file_get_rare_details (file);
 		changed = TRUE;
-		g_free (file->details->trash_orig_path);
-		file->details->trash_orig_path = g_strdup (trash_orig_path);
+		g_free (rare->trash_orig_path);
+		rare->trash_orig_path = g_strdup (trash_orig_path);
 	}
 
     if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_PREVIEW_ICON))
@@ -2939,7 +2981,7 @@ get_time (NemoFile *file,
         time = file->details->btime;
         break;
 	case NEMO_DATE_TYPE_TRASHED:
-		time = file->details->trash_time;
+		time = nemo_file_peek_rare_details (file)->trash_time;
 		break;
 	case NEMO_DATE_TYPE_CHANGED:
     case NEMO_DATE_TYPE_PERMISSIONS_CHANGED:
@@ -3098,7 +3140,10 @@ compare_by_display_name (NemoFile *file_1, NemoFile *file_2)
             compare = +1;
         else if (!name_1 && name_2)
             compare = -1;
-    } else {
+    } else if (strcmp (name_1, name_2) == 0) {
+		/* Identical names collate equal, don't build keys for them */
+		compare = 0;
+	} else {
 		key_1 = nemo_file_peek_display_name_collation_key (file_1);
 		key_2 = nemo_file_peek_display_name_collation_key (file_2);
 		compare = g_strcmp0 (key_1, key_2);
@@ -3454,6 +3499,49 @@ nemo_file_compare_for_sort (NemoFile *file_1,
 	return result;
 }
 
+/**
+ * nemo_file_get_sort_type_for_attribute_q:
+ * @attribute: A file attribute
+ *
+ * Return value: the sort type nemo_file_compare_for_sort_by_attribute_q()
+ * uses for @attribute, or %NEMO_FILE_SORT_NONE if @attribute is
+ * compared as a plain string.
+ **/
+NemoFileSortType
+nemo_file_get_sort_type_for_attribute_q (GQuark attribute)
+{
+	if (attribute == 0 || attribute == attribute_name_q) {
+		return NEMO_FILE_SORT_BY_DISPLAY_NAME;
+	} else if (attribute == attribute_size_q) {
+		return NEMO_FILE_SORT_BY_SIZE;
+	} else if (attribute == attribute_type_q) {
+		return NEMO_FILE_SORT_BY_TYPE;
+	} else if (attribute == attribute_detailed_type_q) {
+		return NEMO_FILE_SORT_BY_DETAILED_TYPE;
+	} else if (attribute == attribute_modification_date_q ||
+		   attribute == attribute_date_modified_q ||
+		   attribute == attribute_date_modified_with_time_q ||
+		   attribute == attribute_date_modified_full_q) {
+		return NEMO_FILE_SORT_BY_MTIME;
+	} else if (attribute == attribute_accessed_date_q ||
+		   attribute == attribute_date_accessed_q ||
+		   attribute == attribute_date_accessed_full_q) {
+		return NEMO_FILE_SORT_BY_ATIME;
+	} else if (attribute == attribute_creation_date_q ||
+		   attribute == attribute_date_created_q ||
+		   attribute == attribute_date_created_with_time_q ||
+		   attribute == attribute_date_created_full_q) {
+		return NEMO_FILE_SORT_BY_BTIME;
+	} else if (attribute == attribute_trashed_on_q ||
+		   attribute == attribute_trashed_on_full_q) {
+		return NEMO_FILE_SORT_BY_TRASHED_TIME;
+	} else if (attribute == attribute_search_result_count_q) {
+		return NEMO_FILE_SORT_BY_SEARCH_RESULT_COUNT;
+	}
+
+	return NEMO_FILE_SORT_NONE;
+}
+
 int
 nemo_file_compare_for_sort_by_attribute_q   (NemoFile                   *file_1,
 						 NemoFile                   *file_2,
@@ -3463,6 +3551,7 @@ nemo_file_compare_for_sort_by_attribute_q   (NemoFile                   *file_1,
 						 gboolean                        reversed,
                          gpointer                        search_dir)
 {
+	NemoFileSortType sort_type;
 	int result;
 
 	if (file_1 == file_2) {
@@ -3472,79 +3561,15 @@ nemo_file_compare_for_sort_by_attribute_q   (NemoFile                   *file_1,
 	/* Convert certain attributes into NemoFileSortTypes and use
 	 * nemo_file_compare_for_sort()
 	 */
-	if (attribute == 0 || attribute == attribute_name_q) {
+	sort_type = nemo_file_get_sort_type_for_attribute_q (attribute);
+	if (sort_type != NEMO_FILE_SORT_NONE) {
 		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_DISPLAY_NAME,
+						       sort_type,
 						       directories_first,
 						       favorites_first,
 						       reversed,
-                               search_dir);
-	} else if (attribute == attribute_size_q) {
-		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_SIZE,
-						       directories_first,
-						       favorites_first,
-						       reversed,
-                               search_dir);
-	} else if (attribute == attribute_type_q) {
-		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_TYPE,
-						       directories_first,
-						       favorites_first,
-						       reversed,
-                               search_dir);
-	} else if (attribute == attribute_detailed_type_q) {
-        return nemo_file_compare_for_sort (file_1, file_2,
-                               NEMO_FILE_SORT_BY_DETAILED_TYPE,
-                               directories_first,
-                               favorites_first,
-                               reversed,
-                               search_dir);
-	} else if (attribute == attribute_modification_date_q ||
-               attribute == attribute_date_modified_q ||
-               attribute == attribute_date_modified_with_time_q ||
-               attribute == attribute_date_modified_full_q) {
-		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_MTIME,
-						       directories_first,
-						       favorites_first,
-						       reversed,
-                               search_dir);
-    } else if (attribute == attribute_accessed_date_q ||
-               attribute == attribute_date_accessed_q ||
-               attribute == attribute_date_accessed_full_q) {
-		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_ATIME,
-						       directories_first,
-						       favorites_first,
-						       reversed,
-                               search_dir);
-    } else if (attribute == attribute_creation_date_q ||
-               attribute == attribute_date_created_q ||
-               attribute == attribute_date_created_with_time_q ||
-               attribute == attribute_date_created_full_q) {
-        return nemo_file_compare_for_sort (file_1, file_2,
-                               NEMO_FILE_SORT_BY_BTIME,
-                               directories_first,
-                               favorites_first,
-                               reversed,
-                               search_dir);
-    } else if (attribute == attribute_trashed_on_q ||
-               attribute == attribute_trashed_on_full_q) {
-		return nemo_file_compare_for_sort (file_1, file_2,
-						       NEMO_FILE_SORT_BY_TRASHED_TIME,
-						       directories_first,
-						       favorites_first,
-						       reversed,
-                               search_dir);
-	} else if (attribute == attribute_search_result_count_q) {
-        return nemo_file_compare_for_sort (file_1, file_2,
-                               NEMO_FILE_SORT_BY_SEARCH_RESULT_COUNT,
-                               directories_first,
-                               favorites_first,
-                               reversed,
-                               search_dir);
-    }
+						       search_dir);
+	}
 
 	/* it is a normal attribute, compare by strings */
 
@@ -3592,6 +3617,344 @@ nemo_file_compare_for_sort_by_attribute     (NemoFile                   *file_1,
 }
 
 
+/* Sort keys: everything nemo_file_compare_for_sort() looks at, pulled
+ * out of each file once. Strings that would be collated on every
+ * comparison are turned into collation keys here, so the sort itself
+ * does no allocation and no metadata or MIME lookups.
+ */
+typedef struct {
+	gpointer item;
+	NemoFile *file;
+	NemoDirectory *directory;
+
+	guint group;
+	int sort_order;
+
+	/* display name */
+	gboolean name_is_null;
+	gboolean name_sort_last;
+
+	const char *directory_key;
+
+	/* size, item count, time or search result count */
+	gboolean is_directory;
+	Knowledge knowledge;
+	gint64 value;
+
+	/* type, NULL if the file has no type string */
+	const char *type_key;
+} SortKey;
+
+typedef struct {
+	NemoFileSortType sort_type;
+	gboolean reversed;
+
+	/* Collation keys shared between files, owned by the sort */
+	GHashTable *directory_keys;
+	GHashTable *type_keys;
+} SortKeyContext;
+
+static const char *
+sort_key_context_intern (GHashTable *table, char *string)
+{
+	char *key;
+
+	key = g_hash_table_lookup (table, string);
+	if (key == NULL) {
+		key = g_utf8_collate_key (string, -1);
+		g_hash_table_insert (table, string, key);
+	} else {
+		g_free (string);
+	}
+
+	return key;
+}
+
+static void
+sort_key_init (SortKey *key,
+	       gpointer item,
+	       NemoFile *file,
+	       SortKeyContext *context,
+	       gboolean directories_first,
+	       gboolean favorites_first,
+	       gpointer search_dir)
+{
+	const char *name;
+	char *type_string, *parent_uri;
+	NemoDateType date_type;
+	time_t time;
+	goffset size;
+	guint count;
+
+	key->item = item;
+	key->file = file;
+	key->directory = file->details->directory;
+	key->sort_order = file->details->sort_order;
+	key->is_directory = nemo_file_is_directory (file);
+
+	/* Same precedence as nemo_file_compare_for_sort_internal() */
+	key->group = 0;
+	if (favorites_first && !nemo_file_get_is_favorite (file)) {
+		key->group |= 1 << 2;
+	}
+	if (!nemo_file_get_pinning (file)) {
+		key->group |= 1 << 1;
+	}
+	if (directories_first && !key->is_directory) {
+		key->group |= 1 << 0;
+	}
+
+	name = nemo_file_peek_display_name (file);
+	key->name_is_null = name == NULL;
+	key->name_sort_last = name && (name[0] == SORT_LAST_CHAR1 || name[0] == SORT_LAST_CHAR2);
+
+	key->directory_key = g_hash_table_lookup (context->directory_keys, key->directory);
+	if (key->directory_key == NULL) {
+		parent_uri = nemo_file_get_parent_uri_for_display (file);
+		key->directory_key = g_utf8_collate_key (parent_uri, -1);
+		g_hash_table_insert (context->directory_keys, key->directory, (char *) key->directory_key);
+		g_free (parent_uri);
+	}
+
+	key->knowledge = KNOWN;
+	key->value = 0;
+	key->type_key = NULL;
+
+	switch (context->sort_type) {
+	case NEMO_FILE_SORT_BY_SIZE:
+		if (key->is_directory) {
+			count = 0;
+			key->knowledge = get_item_count (file, &count);
+			key->value = count;
+		} else {
+			size = 0;
+			key->knowledge = get_size (file, &size);
+			key->value = size;
+		}
+		break;
+	case NEMO_FILE_SORT_BY_TYPE:
+	case NEMO_FILE_SORT_BY_DETAILED_TYPE:
+		if (!key->is_directory) {
+			type_string = context->sort_type == NEMO_FILE_SORT_BY_TYPE ?
+				nemo_file_get_type_as_string (file) :
+				nemo_file_get_detailed_type_as_string (file);
+			if (type_string != NULL) {
+				key->type_key = sort_key_context_intern (context->type_keys, type_string);
+			}
+		}
+		break;
+	case NEMO_FILE_SORT_BY_MTIME:
+	case NEMO_FILE_SORT_BY_ATIME:
+	case NEMO_FILE_SORT_BY_BTIME:
+	case NEMO_FILE_SORT_BY_TRASHED_TIME:
+		date_type = context->sort_type == NEMO_FILE_SORT_BY_MTIME ? NEMO_DATE_TYPE_MODIFIED :
+			    context->sort_type == NEMO_FILE_SORT_BY_ATIME ? NEMO_DATE_TYPE_ACCESSED :
+			    context->sort_type == NEMO_FILE_SORT_BY_BTIME ? NEMO_DATE_TYPE_CREATED :
+			    NEMO_DATE_TYPE_TRASHED;
+		time = 0;
+		key->knowledge = get_time (file, &time, date_type);
+		key->value = time;
+		break;
+	case NEMO_FILE_SORT_BY_SEARCH_RESULT_COUNT:
+		key->value = nemo_file_get_search_result_count (file, search_dir);
+		break;
+	case NEMO_FILE_SORT_BY_DISPLAY_NAME:
+	case NEMO_FILE_SORT_NONE:
+	default:
+		break;
+	}
+}
+
+static int
+compare_keys_by_display_name (const SortKey *key_1, const SortKey *key_2)
+{
+	if (key_1->name_sort_last != key_2->name_sort_last) {
+		return key_1->name_sort_last ? +1 : -1;
+	}
+
+	if (key_1->name_is_null || key_2->name_is_null) {
+		return key_1->name_is_null == key_2->name_is_null ? 0 :
+		       key_1->name_is_null ? -1 : +1;
+	}
+
+	/* Only computed on the first tie, most sorts by date, size or
+	 * type never need it */
+	return g_strcmp0 (nemo_file_peek_display_name_collation_key (key_1->file),
+			  nemo_file_peek_display_name_collation_key (key_2->file));
+}
+
+static int
+compare_keys_by_directory_name (const SortKey *key_1, const SortKey *key_2)
+{
+	if (key_1->directory == key_2->directory) {
+		return 0;
+	}
+
+	return strcmp (key_1->directory_key, key_2->directory_key);
+}
+
+static int
+compare_keys_by_full_path (const SortKey *key_1, const SortKey *key_2)
+{
+	int compare;
+
+	compare = compare_keys_by_directory_name (key_1, key_2);
+	if (compare != 0) {
+		return compare;
+	}
+
+	return compare_keys_by_display_name (key_1, key_2);
+}
+
+/* Known values first, unknown last, then by value; see compare_by_time() */
+static int
+compare_keys_by_known_value (const SortKey *key_1, const SortKey *key_2)
+{
+	if (key_1->knowledge != key_2->knowledge) {
+		return key_1->knowledge > key_2->knowledge ? -1 : +1;
+	}
+
+	if (key_1->knowledge == UNKNOWABLE || key_1->knowledge == UNKNOWN) {
+		return 0;
+	}
+
+	return key_1->value < key_2->value ? -1 : key_1->value > key_2->value ? +1 : 0;
+}
+
+static int
+compare_sort_keys (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const SortKey *key_1 = a, *key_2 = b;
+	SortKeyContext *context = user_data;
+	int result;
+
+	if (key_1->file == key_2->file) {
+		return 0;
+	}
+
+	if (key_1->group != key_2->group) {
+		return key_1->group < key_2->group ? -1 : +1;
+	}
+
+	if (key_1->sort_order != key_2->sort_order) {
+		result = key_1->sort_order < key_2->sort_order ? -1 : +1;
+		return context->reversed ? -result : result;
+	}
+
+	switch (context->sort_type) {
+	case NEMO_FILE_SORT_BY_DISPLAY_NAME:
+		result = compare_keys_by_display_name (key_1, key_2);
+		if (result == 0) {
+			result = compare_keys_by_directory_name (key_1, key_2);
+		}
+		break;
+	case NEMO_FILE_SORT_BY_SIZE:
+		if (key_1->is_directory != key_2->is_directory) {
+			result = key_1->is_directory ? -1 : +1;
+		} else {
+			result = compare_keys_by_known_value (key_1, key_2);
+		}
+		if (result == 0) {
+			result = compare_keys_by_full_path (key_1, key_2);
+		}
+		break;
+	case NEMO_FILE_SORT_BY_TYPE:
+	case NEMO_FILE_SORT_BY_DETAILED_TYPE:
+		if (key_1->is_directory || key_2->is_directory) {
+			result = key_1->is_directory == key_2->is_directory ? 0 :
+				 key_1->is_directory ? -1 : +1;
+		} else if (key_1->type_key == NULL || key_2->type_key == NULL) {
+			result = key_1->type_key != NULL ? -1 :
+				 key_2->type_key != NULL ? +1 : 0;
+		} else {
+			result = strcmp (key_1->type_key, key_2->type_key);
+		}
+		if (result == 0) {
+			result = compare_keys_by_full_path (key_1, key_2);
+		}
+		break;
+	case NEMO_FILE_SORT_BY_MTIME:
+	case NEMO_FILE_SORT_BY_ATIME:
+	case NEMO_FILE_SORT_BY_BTIME:
+	case NEMO_FILE_SORT_BY_TRASHED_TIME:
+		result = compare_keys_by_known_value (key_1, key_2);
+		if (result == 0) {
+			result = compare_keys_by_full_path (key_1, key_2);
+		}
+		break;
+	case NEMO_FILE_SORT_BY_SEARCH_RESULT_COUNT:
+		result = key_1->value < key_2->value ? -1 : key_1->value > key_2->value ? +1 : 0;
+		if (result == 0) {
+			result = compare_keys_by_full_path (key_1, key_2);
+		}
+		break;
+	case NEMO_FILE_SORT_NONE:
+	default:
+		g_return_val_if_reached (0);
+	}
+
+	return context->reversed ? -result : result;
+}
+
+/**
+ * nemo_file_sort_items:
+ * @items: Array of items to sort in place
+ * @n_items: Length of @items
+ * @get_file: Returns the NemoFile an item stands for
+ * @sort_type: Sort criterion
+ * @directories_first: Put all directories before any non-directories
+ * @favorites_first: Put all favorited items before any non-favorited items
+ * @reversed: Reverse the order of the items
+ * @search_dir: The search directory for %NEMO_FILE_SORT_BY_SEARCH_RESULT_COUNT
+ *
+ * Sorts @items into the order nemo_file_compare_for_sort() gives, but
+ * extracts each file's sort key only once, which makes sorting large
+ * folders by type or date much cheaper than a comparison sort calling
+ * nemo_file_compare_for_sort() directly.
+ **/
+void
+nemo_file_sort_items (gpointer             *items,
+		      guint                 n_items,
+		      NemoFileSortItemFunc  get_file,
+		      NemoFileSortType      sort_type,
+		      gboolean              directories_first,
+		      gboolean              favorites_first,
+		      gboolean              reversed,
+		      gpointer              search_dir)
+{
+	SortKeyContext context;
+	SortKey *keys;
+	guint i;
+
+	g_return_if_fail (sort_type != NEMO_FILE_SORT_NONE);
+
+	if (n_items <= 1) {
+		return;
+	}
+
+	context.sort_type = sort_type;
+	context.reversed = reversed;
+	context.directory_keys = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	context.type_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	keys = g_new (SortKey, n_items);
+	for (i = 0; i < n_items; i++) {
+		sort_key_init (&keys[i], items[i], get_file (items[i]), &context,
+			       directories_first, favorites_first, search_dir);
+	}
+
+	g_qsort_with_data (keys, n_items, sizeof (SortKey), compare_sort_keys, &context);
+
+	for (i = 0; i < n_items; i++) {
+		items[i] = keys[i].item;
+	}
+
+	g_free (keys);
+	g_hash_table_destroy (context.directory_keys);
+	g_hash_table_destroy (context.type_keys);
+}
+
+
 /**
  * nemo_file_compare_name:
  * @file: A file object
@@ -4059,13 +4422,18 @@ nemo_file_set_integer_metadata (NemoFile *file,
 static const char *
 nemo_file_peek_display_name_collation_key (NemoFile *file)
 {
-	const char *res;
+	const char *name;
 
-	res = file->details->display_name_collation_key;
-	if (res == NULL)
-		res = "";
+	if (file->details->display_name_collation_key == NULL) {
+		name = file->details->display_name;
+		if (name == NULL) {
+			return "";
+		}
 
-	return res;
+		file->details->display_name_collation_key = g_utf8_collate_key_for_filename (name, -1);
+	}
+
+	return file->details->display_name_collation_key;
 }
 
 static const char *
@@ -4146,7 +4514,7 @@ nemo_file_get_name (NemoFile *file)
 char *
 nemo_file_get_description (NemoFile *file)
 {
-	return g_strdup (file->details->description);
+	return g_strdup (nemo_file_peek_rare_details (file)->description);
 }
 
 void
@@ -5063,7 +5431,7 @@ nemo_file_get_trash_original_file_parent_as_string (NemoFile *file)
 	GFile *location;
 	char *filename;
 
-	if (file->details->trash_orig_path != NULL) {
+	if (nemo_file_peek_rare_details (file)->trash_orig_path != NULL) {
 		orig_file = nemo_file_get_trash_original_file (file);
 		parent = nemo_file_get_parent (orig_file);
 		location = nemo_file_get_location (parent);
@@ -7422,8 +7790,8 @@ get_fs_free_cb (GObject *source_object,
 		g_object_unref (info);
 	}
 
-	if (file->details->free_space != free_space) {
-		file->details->free_space = free_space;
+	if (nemo_file_peek_rare_details (file)->free_space != free_space) {
+		nemo_file_get_rare_details (file)->free_space = free_space;
 		nemo_file_emit_changed (file);
 	}
 
@@ -7440,16 +7808,19 @@ get_fs_free_cb (GObject *source_object,
 char *
 nemo_file_get_volume_free_space (NemoFile *file)
 {
+	NemoFileRareDetails *rare;
 	GFile *location;
 	char *res;
 	time_t now;
 	int prefix;
 
+	rare = nemo_file_get_rare_details (file);
+
 	now = time (NULL);
 	/* Update first time and then every 2 seconds */
-	if (file->details->free_space_read == 0 ||
-	    (now - file->details->free_space_read) > 2)  {
-		file->details->free_space_read = now;
+	if (rare->free_space_read == 0 ||
+	    (now - rare->free_space_read) > 2)  {
+		rare->free_space_read = now;
 		location = nemo_file_get_location (file);
 		g_file_query_filesystem_info_async (location,
 						    G_FILE_ATTRIBUTE_FILESYSTEM_FREE,
@@ -7460,9 +7831,9 @@ nemo_file_get_volume_free_space (NemoFile *file)
 	}
 
 	res = NULL;
-	if (file->details->free_space != (guint64)-1) {
+	if (rare->free_space != (guint64)-1) {
 		prefix = nemo_global_preferences_get_size_prefix_preference ();
-		res = g_format_size_full (file->details->free_space, prefix);
+		res = g_format_size_full (rare->free_space, prefix);
 	}
 
 	return res;
@@ -7512,7 +7883,7 @@ nemo_file_get_symbolic_link_target_path (NemoFile *file)
 		g_warning ("File has symlink target, but  is not marked as symlink");
 	}
 
-	return g_strdup (file->details->symlink_name);
+	return g_strdup (nemo_file_peek_rare_details (file)->symlink_name);
 }
 
 /**
@@ -7528,13 +7899,16 @@ char *
 nemo_file_get_symbolic_link_target_uri (NemoFile *file)
 {
 	GFile *location, *parent, *target;
+	const char *symlink_name;
 	char *target_uri;
 
 	if (!nemo_file_is_symbolic_link (file)) {
 		g_warning ("File has symlink target, but  is not marked as symlink");
 	}
 
-	if (file->details->symlink_name == NULL) {
+	symlink_name = nemo_file_peek_rare_details (file)->symlink_name;
+
+	if (symlink_name == NULL) {
 		return NULL;
 	} else {
 		target = NULL;
@@ -7543,7 +7917,7 @@ nemo_file_get_symbolic_link_target_uri (NemoFile *file)
 		parent = g_file_get_parent (location);
 		g_object_unref (location);
 		if (parent) {
-			target = g_file_resolve_relative_path (parent, file->details->symlink_name);
+			target = g_file_resolve_relative_path (parent, symlink_name);
 			g_object_unref (parent);
 		}
 
@@ -7853,8 +8227,8 @@ nemo_file_get_trash_original_file (NemoFile *file)
 
 	original_file = NULL;
 
-	if (file->details->trash_orig_path != NULL) {
-		location = g_file_new_for_path (file->details->trash_orig_path);
+	if (nemo_file_peek_rare_details (file)->trash_orig_path != NULL) {
+		location = g_file_new_for_path (nemo_file_peek_rare_details (file)->trash_orig_path);
 		original_file = nemo_file_get (location);
 		g_object_unref (location);
 	}
@@ -8194,18 +8568,26 @@ nemo_file_construct_tooltip (NemoFile *file, NemoFileTooltipFlags flags, gpointe
 gint
 nemo_file_get_monitor_number (NemoFile *file)
 {
-    if (file->details->desktop_monitor == -1) {
-        file->details->desktop_monitor = nemo_file_get_integer_metadata (file, NEMO_METADATA_KEY_MONITOR, -1);
+    gint monitor;
+
+    monitor = nemo_file_peek_rare_details (file)->desktop_monitor;
+
+    if (monitor == -1) {
+        monitor = nemo_file_get_integer_metadata (file, NEMO_METADATA_KEY_MONITOR, -1);
+
+        if (monitor != -1) {
+            nemo_file_get_rare_details (file)->desktop_monitor = monitor;
+        }
     }
 
-    return file->details->desktop_monitor;
+    return monitor;
 }
 
 void
 nemo_file_set_monitor_number (NemoFile *file, gint monitor)
 {
     nemo_file_set_integer_metadata (file, NEMO_METADATA_KEY_MONITOR, -1, monitor);
-    file->details->desktop_monitor = monitor;
+    nemo_file_get_rare_details (file)->desktop_monitor = monitor;
 }
 
 void
@@ -8213,7 +8595,11 @@ nemo_file_get_position (NemoFile *file, GdkPoint *point)
 {
     gint x, y;
 
-    if (file->details->cached_position_x == -1) {
+    const NemoFileRareDetails *rare;
+
+    rare = nemo_file_peek_rare_details (file);
+
+    if (rare->cached_position_x == -1) {
         char *position_string;
         gboolean position_good;
         char c;
@@ -8232,11 +8618,13 @@ nemo_file_get_position (NemoFile *file, GdkPoint *point)
             point->y = -1;
         }
 
-        file->details->cached_position_x = point->x;
-        file->details->cached_position_y = point->y;
+        if (position_good) {
+            nemo_file_get_rare_details (file)->cached_position_x = point->x;
+            nemo_file_get_rare_details (file)->cached_position_y = point->y;
+        }
     } else {
-        point->x = file->details->cached_position_x;
-        point->y = file->details->cached_position_y;
+        point->x = rare->cached_position_x;
+        point->y = rare->cached_position_y;
     }
 }
 
@@ -8252,8 +8640,10 @@ nemo_file_set_position (NemoFile *file, gint x, gint y)
     }
     nemo_file_set_metadata (file, NEMO_METADATA_KEY_ICON_POSITION, NULL, position_string);
 
-    file->details->cached_position_x = x;
-    file->details->cached_position_y = y;
+    if (x > -1 || file->details->rare != NULL) {
+        nemo_file_get_rare_details (file)->cached_position_x = x;
+        nemo_file_get_rare_details (file)->cached_position_y = y;
+    }
 
     g_free (position_string);
 }
@@ -8494,7 +8884,7 @@ nemo_file_invalidate_all_attributes (NemoFile *file)
 void
 nemo_file_dump (NemoFile *file)
 {
-	long size = file->details->deep_size;
+	long size = nemo_file_peek_rare_details (file)->deep_size;
 	char *uri;
 	const char *file_kind;
 
@@ -8529,7 +8919,7 @@ nemo_file_dump (NemoFile *file)
 		}
 		g_print ("kind: %s \n", file_kind);
 		if (file->details->type == G_FILE_TYPE_SYMBOLIC_LINK) {
-			g_print ("link to %s \n", file->details->symlink_name);
+			g_print ("link to %s \n", nemo_file_peek_rare_details (file)->symlink_name);
 			/* FIXME bugzilla.gnome.org 42430: add following of symlinks here */
 		}
 		/* FIXME bugzilla.gnome.org 42431: add permissions and other useful stuff here */
@@ -9073,12 +9463,16 @@ nemo_file_add_search_result_data (NemoFile         *file,
                                   gpointer          search_dir,
                                   FileSearchResult *result)
 {
-    if (file->details->search_results == NULL) {
-        file->details->search_results = g_hash_table_new_full (NULL, NULL,
-                                                               NULL, (GDestroyNotify) file_search_result_free);
+    NemoFileRareDetails *rare;
+
+    rare = nemo_file_get_rare_details (file);
+
+    if (rare->search_results == NULL) {
+        rare->search_results = g_hash_table_new_full (NULL, NULL,
+                                                      NULL, (GDestroyNotify) file_search_result_free);
     }
 
-    if (!g_hash_table_replace (file->details->search_results,
+    if (!g_hash_table_replace (rare->search_results,
                                search_dir,
                                result)) {
 
@@ -9095,34 +9489,46 @@ void
 nemo_file_clear_search_result_data (NemoFile      *file,
                                     gpointer       search_dir)
 {
-    g_return_if_fail (file->details->search_results != NULL);
+    NemoFileRareDetails *rare;
 
-    if (!g_hash_table_remove (file->details->search_results,
+    rare = file->details->rare;
+
+    g_return_if_fail (rare != NULL && rare->search_results != NULL);
+
+    if (!g_hash_table_remove (rare->search_results,
                               search_dir)) {
 
         g_warning ("Attempting to remove search hits that don't exist - %s", nemo_file_peek_name (file));
     }
 
-    if (g_hash_table_size (file->details->search_results) == 0) {
-        g_hash_table_destroy (file->details->search_results);
-        file->details->search_results = NULL;
+    if (g_hash_table_size (rare->search_results) == 0) {
+        g_hash_table_destroy (rare->search_results);
+        rare->search_results = NULL;
     }
 }
 
 static FileSearchResult*
 get_file_search_result (NemoFile *file, gpointer search_dir)
 {
-    if (file->details->search_results == NULL) {
+    GHashTable *search_results;
+
+    search_results = nemo_file_peek_rare_details (file)->search_results;
+
+    if (search_results == NULL) {
         return NULL;
     }
 
-    return g_hash_table_lookup (file->details->search_results, search_dir);
+    return g_hash_table_lookup (search_results, search_dir);
 }
 
 gboolean
 nemo_file_has_search_result (NemoFile *file, gpointer search_dir)
 {
-    return g_hash_table_contains (file->details->search_results, search_dir);
+    GHashTable *search_results;
+
+    search_results = nemo_file_peek_rare_details (file)->search_results;
+
+    return search_results != NULL && g_hash_table_contains (search_results, search_dir);
 }
 
 gint
@@ -9210,12 +9616,19 @@ nemo_file_info_iface_init (NemoFileInfoInterface *iface)
 
 #if !defined (NEMO_OMIT_SELF_CHECK)
 
+static NemoFile *
+self_check_item_get_file (gpointer item)
+{
+	return item;
+}
+
 void
 nemo_self_check_file (void)
 {
 	NemoFile *file_1;
 	NemoFile *file_2;
 	GList *list;
+	gpointer items[2];
 
         /* refcount checks */
 
@@ -9297,8 +9710,17 @@ nemo_self_check_file (void)
 	EEL_CHECK_BOOLEAN_RESULT (nemo_file_compare_for_sort (file_1, file_1, NEMO_FILE_SORT_BY_DISPLAY_NAME, TRUE, FALSE, FALSE, NULL) == 0, TRUE);
 	EEL_CHECK_BOOLEAN_RESULT (nemo_file_compare_for_sort (file_1, file_1, NEMO_FILE_SORT_BY_DISPLAY_NAME, FALSE, FALSE, TRUE, NULL) == 0, TRUE);
 	EEL_CHECK_BOOLEAN_RESULT (nemo_file_compare_for_sort (file_1, file_1, NEMO_FILE_SORT_BY_DISPLAY_NAME, TRUE, FALSE, TRUE, NULL) == 0, TRUE);
-    
-    
+
+	/* sorting on precomputed keys */
+	items[0] = file_2;
+	items[1] = file_1;
+	nemo_file_sort_items (items, 2, self_check_item_get_file, NEMO_FILE_SORT_BY_DISPLAY_NAME, FALSE, FALSE, FALSE, NULL);
+	EEL_CHECK_BOOLEAN_RESULT (items[0] == file_1 && items[1] == file_2, TRUE);
+	nemo_file_sort_items (items, 2, self_check_item_get_file, NEMO_FILE_SORT_BY_DISPLAY_NAME, FALSE, FALSE, TRUE, NULL);
+	EEL_CHECK_BOOLEAN_RESULT (items[0] == file_2 && items[1] == file_1, TRUE);
+	nemo_file_sort_items (items, 2, self_check_item_get_file, NEMO_FILE_SORT_BY_MTIME, FALSE, FALSE, FALSE, NULL);
+	EEL_CHECK_BOOLEAN_RESULT (nemo_file_compare_for_sort (items[0], items[1], NEMO_FILE_SORT_BY_MTIME, FALSE, FALSE, FALSE, NULL) <= 0, TRUE);
+
 
 	nemo_file_unref (file_1);
 	nemo_file_unref (file_2);
@@ -456,6 +456,19 @@ int                     nemo_file_compare_for_sort_by_attribute_q   (NemoFile
 									 gboolean                        reversed,
                                      gpointer                        search_dir);
 gboolean                nemo_file_is_date_sort_attribute_q          (GQuark                          attribute);
+NemoFileSortType        nemo_file_get_sort_type_for_attribute_q     (GQuark                          attribute);
+
+/* Sorting many files at once, see nemo_file_sort_items() */
+typedef NemoFile *    (*NemoFileSortItemFunc)                       (gpointer                        item);
+
+void                    nemo_file_sort_items                        (gpointer                       *items,
+									 guint                           n_items,
+									 NemoFileSortItemFunc            get_file,
+									 NemoFileSortType                sort_type,
+									 gboolean                        directories_first,
+									 gboolean                        favorites_first,
+									 gboolean                        reversed,
+									 gpointer                        search_dir);
 
 int                     nemo_file_compare_display_name              (NemoFile                   *file_1,
 									 const char                     *pattern);
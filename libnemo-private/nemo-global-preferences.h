@@ -206,6 +206,13 @@ typedef enum
     NEMO_SPEED_TRADEOFF_NEVER
 } NemoSpeedTradeoffValue;
 
+typedef enum
+{
+	NEMO_FILE_OPS_IO_PRIORITY_NORMAL,
+	NEMO_FILE_OPS_IO_PRIORITY_LOW,
+	NEMO_FILE_OPS_IO_PRIORITY_IDLE
+} NemoFileOpsIOPriority;
+
 #define NEMO_PREFERENCES_SHOW_DIRECTORY_ITEM_COUNTS "show-directory-item-counts"
 #define NEMO_PREFERENCES_SHOW_IMAGE_FILE_THUMBNAILS	"show-image-thumbnails"
 #define NEMO_PREFERENCES_IMAGE_FILE_THUMBNAIL_LIMIT	"thumbnail-limit"
@@ -270,6 +277,12 @@ typedef enum
 
 /* File operations queue */
 #define NEMO_PREFERENCES_NEVER_QUEUE_FILE_OPS          "never-queue-file-ops"
+#define NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE      "file-ops-jobs-per-device"
+#define NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE_OVERRIDES "file-ops-jobs-per-device-overrides"
+#define NEMO_PREFERENCES_FILE_OPS_IO_PRIORITY          "file-ops-io-priority"
+#define NEMO_PREFERENCES_FILE_OPS_BANDWIDTH_LIMIT      "file-ops-bandwidth-limit"
+#define NEMO_PREFERENCES_FILE_OPS_YIELD_TO_BROWSING    "file-ops-yield-to-browsing"
+#define NEMO_PREFERENCES_FILE_OPS_VERIFY_COPIES        "file-ops-verify-copies"
 
 #define NEMO_PREFERENCES_CLICK_DOUBLE_PARENT_FOLDER    "click-double-parent-folder"
 #define NEMO_PREFERENCES_EXPAND_ROW_ON_DND_DWELL       "expand-row-on-dnd-dwell"
@@ -1193,6 +1193,43 @@ nemo_icon_canvas_item_set_is_visible (NemoIconCanvasItem       *item,
 	}
 }
 
+gboolean
+nemo_icon_canvas_item_get_is_visible (NemoIconCanvasItem *item)
+{
+	return item->details->is_visible;
+}
+
+/* Lets the item be handed to another icon: it is hidden and put back
+ * at the origin, and its image and highlights are dropped. The text is
+ * left for the next icon to replace. */
+void
+nemo_icon_canvas_item_recycle (NemoIconCanvasItem *item)
+{
+	NemoIconCanvasItemDetails *details;
+
+	g_return_if_fail (NEMO_IS_ICON_CANVAS_ITEM (item));
+
+	details = item->details;
+
+	eel_canvas_item_hide (EEL_CANVAS_ITEM (item));
+	eel_canvas_item_set (EEL_CANVAS_ITEM (item),
+			     "highlighted_for_selection", FALSE,
+			     "highlighted_as_keyboard_focus", FALSE,
+			     "highlighted_for_drop", FALSE,
+			     "highlighted_for_clipboard", FALSE,
+			     NULL);
+	nemo_icon_canvas_item_set_image (item, NULL);
+	nemo_icon_canvas_item_set_is_visible (item, FALSE);
+	nemo_icon_canvas_item_set_entire_text (item, FALSE);
+
+	details->is_prelit = FALSE;
+	details->x = 0;
+	details->y = 0;
+	nemo_icon_canvas_item_invalidate_label (item);
+
+	item->user_data = NULL;
+}
+
 void
 nemo_icon_canvas_item_invalidate_label (NemoIconCanvasItem     *item)
 {
@@ -101,6 +101,8 @@ void        nemo_icon_canvas_item_update_bounds            (NemoIconCanvasItem
 								double i2w_dx, double i2w_dy);
 void        nemo_icon_canvas_item_set_is_visible           (NemoIconCanvasItem       *item,
 								gboolean                      visible);
+gboolean    nemo_icon_canvas_item_get_is_visible           (NemoIconCanvasItem       *item);
+void        nemo_icon_canvas_item_recycle                  (NemoIconCanvasItem       *item);
 /* whether the entire label text must be visible at all times */
 void        nemo_icon_canvas_item_set_entire_text          (NemoIconCanvasItem       *icon_item,
 								gboolean                      entire_text);
@@ -61,6 +61,9 @@
 #define RUBBERBAND_TIMEOUT_INTERVAL 10
 #define RUBBERBAND_SCROLL_THRESHOLD 5
 
+/* Margin around icon bounds in the spatial index, in world units. */
+#define SPATIAL_INDEX_PADDING 2
+
 /* Timeout for making the icon currently selected for keyboard operation visible.
  * If this is 0, you can get into trouble with extra scrolling after holding
  * down the arrow key for awhile when there are many items.
@@ -95,7 +98,7 @@ enum {
 };
 
 typedef struct {
-	GList *selection;
+	GPtrArray *selection;
 	char *action_descriptions[LAST_ACTION];
 } NemoIconContainerAccessiblePrivate;
 
@@ -147,6 +150,10 @@ static gboolean handle_icon_slow_two_click (NemoIconContainer *container,
 
 static void schedule_align_icons (NemoIconContainer *container);
 
+static int item_event_callback (EelCanvasItem *item,
+				GdkEvent *event,
+				gpointer data);
+
 static gpointer accessible_parent_class;
 
 static GQuark accessible_private_data_quark = 0;
@@ -223,7 +230,7 @@ clicked_on_text (NemoIconContainer *container,
                           NemoIcon *icon,
                     GdkEventButton *event)
 {
-    if (icon == NULL)
+    if (icon == NULL || icon->item == NULL)
         return FALSE;
 
     double eventX, eventY;
@@ -245,7 +252,7 @@ clicked_on_icon (NemoIconContainer *container,
                           NemoIcon *icon,
                     GdkEventButton *event)
 {
-    if (icon == NULL)
+    if (icon == NULL || icon->item == NULL)
         return FALSE;
 
     double eventX, eventY;
@@ -266,7 +273,9 @@ static void
 icon_free (NemoIcon *icon)
 {
 	/* Destroy this canvas item; the parent will unref it. */
-	eel_canvas_item_destroy (EEL_CANVAS_ITEM (icon->item));
+	if (icon->item != NULL) {
+		eel_canvas_item_destroy (EEL_CANVAS_ITEM (icon->item));
+	}
 	g_free (icon);
 }
 
@@ -339,9 +348,16 @@ icon_toggle_selected (NemoIconContainer *container,
 	nemo_icon_container_end_renaming_mode (container, TRUE);
 
 	icon->is_selected = !icon->is_selected;
-	eel_canvas_item_set (EEL_CANVAS_ITEM (icon->item),
-			     "highlighted_for_selection", (gboolean) icon->is_selected,
-			     NULL);
+	if (icon->is_selected) {
+		container->details->n_selected++;
+	} else {
+		container->details->n_selected--;
+	}
+	if (icon->item != NULL) {
+		eel_canvas_item_set (EEL_CANVAS_ITEM (icon->item),
+				     "highlighted_for_selection", (gboolean) icon->is_selected,
+				     NULL);
+	}
 
 	/* If the icon is deselected, then get rid of the stretch handles.
 	 * No harm in doing the same if the item is newly selected.
@@ -385,6 +401,649 @@ icon_set_selected (NemoIconContainer *container,
 	return TRUE;
 }
 
+/* details->icons keeps the order of the icons; the icon array mirrors
+ * it so an icon can be found from its position, and the other way
+ * around, without walking the list.
+ */
+void
+nemo_icon_container_invalidate_icon_array (NemoIconContainer *container)
+{
+	container->details->icon_array_valid = FALSE;
+}
+
+static GPtrArray *
+get_icon_array (NemoIconContainer *container)
+{
+	NemoIconContainerDetails *details;
+	NemoIcon *icon;
+	GList *p;
+	guint i;
+
+	details = container->details;
+
+	if (!details->icon_array_valid) {
+		g_ptr_array_set_size (details->icon_array, 0);
+
+		for (p = details->icons, i = 0; p != NULL; p = p->next, i++) {
+			icon = p->data;
+			icon->index = i;
+			g_ptr_array_add (details->icon_array, icon);
+		}
+
+		details->icon_array_valid = TRUE;
+	}
+
+	return details->icon_array;
+}
+
+static NemoIcon *
+get_icon_at_index (NemoIconContainer *container,
+		   int index)
+{
+	GPtrArray *array;
+
+	array = get_icon_array (container);
+
+	if (index < 0 || (guint) index >= array->len) {
+		return NULL;
+	}
+
+	return g_ptr_array_index (array, index);
+}
+
+static int
+get_icon_index (NemoIconContainer *container,
+		NemoIcon *icon)
+{
+	get_icon_array (container);
+
+	return icon->index;
+}
+
+static guint
+get_icon_count (NemoIconContainer *container)
+{
+	return g_hash_table_size (container->details->icon_set);
+}
+
+/* Icons of a plain grid layout only get a canvas item while they are
+ * near the visible area, see nemo_icon_container_ensure_icon_item ().
+ * Without one, an icon stands for an icon-sized square at its position,
+ * over a label as wide as its cell.
+ */
+static EelDRect
+icon_get_stand_in_rectangle (NemoIconContainer *container,
+			     NemoIcon *icon,
+			     gboolean entire_item)
+{
+	NemoIconGrid *grid;
+	EelDRect rect;
+
+	grid = &container->details->grid;
+
+	/* Unpositioned, an item would sit at the origin */
+	if (nemo_icon_container_icon_is_positioned (icon)) {
+		rect.x0 = icon->x;
+		rect.y0 = icon->y;
+	} else {
+		rect.x0 = rect.y0 = 0;
+	}
+	rect.x1 = rect.x0 + grid->icon_size;
+	rect.y1 = rect.y0 + grid->icon_size;
+
+	if (entire_item) {
+		rect.x0 -= (grid->cell_width - grid->icon_size) / 2;
+		rect.x1 = rect.x0 + grid->cell_width;
+		rect.y1 += grid->label_height;
+	}
+
+	return rect;
+}
+
+/* Get the rectangle of the icon only, in world coordinates. */
+EelDRect
+nemo_icon_container_icon_get_rectangle (NemoIconContainer *container,
+					NemoIcon *icon)
+{
+	if (icon->item == NULL) {
+		return icon_get_stand_in_rectangle (container, icon, FALSE);
+	}
+
+	return nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+}
+
+/* Bounds of what the icon displays, or of everything it could display
+ * if @entire_item, in world coordinates. */
+static void
+icon_get_world_bounds (NemoIconContainer *container,
+		       NemoIcon *icon,
+		       gboolean entire_item,
+		       EelDRect *bounds)
+{
+	EelCanvasItem *item;
+
+	if (icon->item == NULL) {
+		*bounds = icon_get_stand_in_rectangle (container, icon, TRUE);
+		return;
+	}
+
+	item = EEL_CANVAS_ITEM (icon->item);
+
+	if (entire_item) {
+		nemo_icon_canvas_item_get_bounds_for_entire_item (icon->item,
+								  &bounds->x0, &bounds->y0,
+								  &bounds->x1, &bounds->y1);
+	} else {
+		eel_canvas_item_get_bounds (item,
+					    &bounds->x0, &bounds->y0,
+					    &bounds->x1, &bounds->y1);
+	}
+
+	eel_canvas_item_i2w (item->parent, &bounds->x0, &bounds->y0);
+	eel_canvas_item_i2w (item->parent, &bounds->x1, &bounds->y1);
+}
+
+static gboolean
+icon_hit_test_rectangle (NemoIconContainer *container,
+			 NemoIcon *icon,
+			 EelIRect canvas_rect)
+{
+	EelDRect world_rect;
+	EelIRect icon_rect;
+
+	if (icon->item != NULL) {
+		return nemo_icon_canvas_item_hit_test_rectangle (icon->item, canvas_rect);
+	}
+
+	world_rect = icon_get_stand_in_rectangle (container, icon, TRUE);
+	eel_canvas_w2c (EEL_CANVAS (container),
+			world_rect.x0, world_rect.y0,
+			&icon_rect.x0, &icon_rect.y0);
+	eel_canvas_w2c (EEL_CANVAS (container),
+			world_rect.x1, world_rect.y1,
+			&icon_rect.x1, &icon_rect.y1);
+
+	return eel_irect_hits_irect (icon_rect, canvas_rect);
+}
+
+static void
+invalidate_spatial_index (NemoIconContainer *container)
+{
+	NemoIconSpatialIndex *index;
+	int i;
+
+	index = &container->details->spatial_index;
+
+	if (index->cells != NULL) {
+		for (i = 0; i < index->n_columns * index->n_rows; i++) {
+			if (index->cells[i] != NULL) {
+				g_ptr_array_free (index->cells[i], TRUE);
+			}
+		}
+		g_clear_pointer (&index->cells, g_free);
+	}
+
+	if (index->dirty != NULL) {
+		g_hash_table_remove_all (index->dirty);
+	}
+
+	index->valid = FALSE;
+}
+
+/* The whole extent the item can take, whatever its label shows right
+ * now, so selecting or prelighting an icon doesn't outgrow its cells. */
+static void
+get_spatial_index_bounds (NemoIconContainer *container,
+			  NemoIcon *icon,
+			  EelDRect *bounds)
+{
+	icon_get_world_bounds (container, icon, TRUE, bounds);
+
+	/* Leave room for rounding to canvas pixels */
+	bounds->x0 -= SPATIAL_INDEX_PADDING;
+	bounds->y0 -= SPATIAL_INDEX_PADDING;
+	bounds->x1 += SPATIAL_INDEX_PADDING;
+	bounds->y1 += SPATIAL_INDEX_PADDING;
+}
+
+static void
+get_spatial_index_cells (NemoIconSpatialIndex *index,
+			 const EelDRect *area,
+			 int *column0, int *row0,
+			 int *column1, int *row1)
+{
+	*column0 = CLAMP ((int) floor ((area->x0 - index->x0) / index->cell_size), 0, index->n_columns - 1);
+	*row0 = CLAMP ((int) floor ((area->y0 - index->y0) / index->cell_size), 0, index->n_rows - 1);
+	*column1 = CLAMP ((int) floor ((area->x1 - index->x0) / index->cell_size), 0, index->n_columns - 1);
+	*row1 = CLAMP ((int) floor ((area->y1 - index->y0) / index->cell_size), 0, index->n_rows - 1);
+}
+
+static void
+spatial_index_file_icon (NemoIconSpatialIndex *index,
+			 NemoIcon *icon,
+			 const EelDRect *bounds)
+{
+	GPtrArray **cell;
+	int column, row;
+
+	get_spatial_index_cells (index, bounds,
+				 &icon->spatial_column0, &icon->spatial_row0,
+				 &icon->spatial_column1, &icon->spatial_row1);
+
+	for (row = icon->spatial_row0; row <= icon->spatial_row1; row++) {
+		for (column = icon->spatial_column0; column <= icon->spatial_column1; column++) {
+			cell = &index->cells[row * index->n_columns + column];
+			if (*cell == NULL) {
+				*cell = g_ptr_array_new ();
+			}
+			g_ptr_array_add (*cell, icon);
+		}
+	}
+
+	icon->in_spatial_index = TRUE;
+}
+
+static void
+spatial_index_unfile_icon (NemoIconSpatialIndex *index,
+			   NemoIcon *icon)
+{
+	int column, row;
+
+	if (!icon->in_spatial_index) {
+		return;
+	}
+
+	for (row = icon->spatial_row0; row <= icon->spatial_row1; row++) {
+		for (column = icon->spatial_column0; column <= icon->spatial_column1; column++) {
+			g_ptr_array_remove_fast (index->cells[row * index->n_columns + column], icon);
+		}
+	}
+
+	icon->in_spatial_index = FALSE;
+}
+
+/* Called when @icon was added, moved or changed size. Only its own
+ * cells are updated, at the next lookup. */
+static void
+spatial_index_icon_changed (NemoIconContainer *container,
+			    NemoIcon *icon)
+{
+	NemoIconSpatialIndex *index;
+
+	index = &container->details->spatial_index;
+
+	if (!index->valid) {
+		return;
+	}
+
+	if (index->dirty == NULL) {
+		index->dirty = g_hash_table_new (NULL, NULL);
+	}
+	g_hash_table_add (index->dirty, icon);
+}
+
+/* Files the icons that changed since the last lookup again. Returns
+ * FALSE if one of them left the area the index covers, or so many
+ * changed that starting over is cheaper. */
+static gboolean
+update_spatial_index (NemoIconContainer *container)
+{
+	NemoIconSpatialIndex *index;
+	GHashTableIter iter;
+	gpointer key;
+	NemoIcon *icon;
+	EelDRect bounds;
+
+	index = &container->details->spatial_index;
+
+	if (index->dirty == NULL || g_hash_table_size (index->dirty) == 0) {
+		return TRUE;
+	}
+
+	if (g_hash_table_size (index->dirty) > get_icon_count (container) / 2) {
+		return FALSE;
+	}
+
+	g_hash_table_iter_init (&iter, index->dirty);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		icon = key;
+
+		get_spatial_index_bounds (container, icon, &bounds);
+		if (bounds.x0 < index->x0 ||
+		    bounds.y0 < index->y0 ||
+		    bounds.x1 >= index->x0 + index->n_columns * index->cell_size ||
+		    bounds.y1 >= index->y0 + index->n_rows * index->cell_size) {
+			return FALSE;
+		}
+
+		spatial_index_unfile_icon (index, icon);
+		spatial_index_file_icon (index, icon, &bounds);
+		g_hash_table_iter_remove (&iter);
+	}
+
+	return TRUE;
+}
+
+static void
+ensure_spatial_index (NemoIconContainer *container)
+{
+	NemoIconSpatialIndex *index;
+	GPtrArray *icons;
+	EelDRect *bounds, extent;
+	double max_size;
+	int max_cells;
+	guint i;
+
+	index = &container->details->spatial_index;
+
+	if (index->valid) {
+		if (update_spatial_index (container)) {
+			return;
+		}
+		invalidate_spatial_index (container);
+	}
+
+	icons = get_icon_array (container);
+	bounds = g_new (EelDRect, MAX (icons->len, 1));
+
+	extent.x0 = extent.y0 = G_MAXDOUBLE;
+	extent.x1 = extent.y1 = -G_MAXDOUBLE;
+	max_size = 1;
+
+	for (i = 0; i < icons->len; i++) {
+		get_spatial_index_bounds (container, g_ptr_array_index (icons, i), &bounds[i]);
+
+		extent.x0 = MIN (extent.x0, bounds[i].x0);
+		extent.y0 = MIN (extent.y0, bounds[i].y0);
+		extent.x1 = MAX (extent.x1, bounds[i].x1);
+		extent.y1 = MAX (extent.y1, bounds[i].y1);
+		max_size = MAX (max_size, bounds[i].x1 - bounds[i].x0);
+		max_size = MAX (max_size, bounds[i].y1 - bounds[i].y0);
+	}
+
+	if (icons->len == 0) {
+		extent.x0 = extent.y0 = extent.x1 = extent.y1 = 0;
+	}
+
+	/* Cells about the size of the largest icon, so most icons fall in
+	 * a handful of cells, but no more cells than a few per icon when
+	 * the icons are scattered over a large area.
+	 */
+	max_cells = MAX (icons->len * 4, 16);
+	index->cell_size = max_size;
+	do {
+		index->n_columns = (int) ceil ((extent.x1 - extent.x0) / index->cell_size) + 1;
+		index->n_rows = (int) ceil ((extent.y1 - extent.y0) / index->cell_size) + 1;
+		if (index->n_columns * index->n_rows <= max_cells) {
+			break;
+		}
+		index->cell_size *= 2;
+	} while (TRUE);
+
+	index->x0 = extent.x0;
+	index->y0 = extent.y0;
+	index->cells = g_new0 (GPtrArray *, index->n_columns * index->n_rows);
+
+	for (i = 0; i < icons->len; i++) {
+		spatial_index_file_icon (index, g_ptr_array_index (icons, i), &bounds[i]);
+	}
+
+	g_free (bounds);
+	index->valid = TRUE;
+}
+
+static gint
+compare_icons_by_index (gconstpointer a,
+			gconstpointer b)
+{
+	const NemoIcon *icon_a = *(NemoIcon **) a;
+	const NemoIcon *icon_b = *(NemoIcon **) b;
+
+	return (icon_a->index > icon_b->index) - (icon_a->index < icon_b->index);
+}
+
+/**
+ * nemo_icon_container_get_icons_in_area:
+ * @container: An icon container widget.
+ * @area: A rectangle in world coordinates.
+ *
+ * Returns the icons that may intersect @area, in the order of the
+ * icon list. Callers still have to hit-test them. Free the array with
+ * g_ptr_array_unref().
+ **/
+GPtrArray *
+nemo_icon_container_get_icons_in_area (NemoIconContainer *container,
+				       const EelDRect *area)
+{
+	NemoIconSpatialIndex *index;
+	GPtrArray *result, *cell;
+	int column, row, column0, row0, column1, row1;
+	guint i, n;
+
+	ensure_spatial_index (container);
+	index = &container->details->spatial_index;
+
+	result = g_ptr_array_new ();
+
+	if (area->x1 < index->x0 ||
+	    area->y1 < index->y0 ||
+	    area->x0 >= index->x0 + index->n_columns * index->cell_size ||
+	    area->y0 >= index->y0 + index->n_rows * index->cell_size) {
+		return result;
+	}
+
+	get_spatial_index_cells (index, area, &column0, &row0, &column1, &row1);
+
+	for (row = row0; row <= row1; row++) {
+		for (column = column0; column <= column1; column++) {
+			cell = index->cells[row * index->n_columns + column];
+			if (cell == NULL) {
+				continue;
+			}
+			for (i = 0; i < cell->len; i++) {
+				g_ptr_array_add (result, g_ptr_array_index (cell, i));
+			}
+		}
+	}
+
+	/* Cells that were updated in place are in no particular order */
+	get_icon_array (container);
+	g_ptr_array_sort (result, compare_icons_by_index);
+
+	/* Icons spanning several cells were collected more than once */
+	if (row1 > row0 || column1 > column0) {
+		for (i = 0, n = 0; i < result->len; i++) {
+			if (n == 0 || g_ptr_array_index (result, i) != g_ptr_array_index (result, n - 1)) {
+				g_ptr_array_index (result, n++) = g_ptr_array_index (result, i);
+			}
+		}
+		g_ptr_array_set_size (result, n);
+	}
+
+	return result;
+}
+
+/* Canvas items.
+ *
+ * With a plain grid layout an icon's position follows from its index,
+ * so icons only need a canvas item while they are in or near the
+ * visible area. update_visible_icons_cb () takes the items of icons
+ * that scrolled away and keeps them as spares for the icons that
+ * scroll in. Any other layout measures every item, so all icons get
+ * one.
+ */
+static gboolean
+icon_items_can_be_lazy (NemoIconContainer *container)
+{
+	NemoIconContainerDetails *details;
+
+	details = container->details;
+
+	return details->auto_layout &&
+	       !details->is_desktop &&
+	       !nemo_icon_container_is_layout_vertical (container) &&
+	       details->label_position != NEMO_ICON_LABEL_POSITION_BESIDE;
+}
+
+/* Gives @icon a spare or new item, in the icon's state but without its
+ * image and text yet. */
+static void
+icon_attach_item (NemoIconContainer *container,
+		  NemoIcon *icon)
+{
+	NemoIconContainerDetails *details;
+	EelCanvasItem *item, *band;
+
+	details = container->details;
+
+	item = g_queue_pop_head (details->spare_items);
+	if (item == NULL) {
+		item = eel_canvas_item_new (EEL_CANVAS_GROUP (EEL_CANVAS (container)->root),
+					    nemo_icon_canvas_item_get_type (),
+					    "visible", FALSE,
+					    NULL);
+
+		g_signal_connect_object (item, "event",
+					 G_CALLBACK (item_event_callback), container, 0);
+
+		/* Make sure the icon is under the selection_rectangle */
+		band = details->rubberband_info.selection_rectangle;
+		if (band) {
+			eel_canvas_item_send_behind (item, band);
+		}
+	}
+
+	icon->item = NEMO_ICON_CANVAS_ITEM (item);
+	icon->item->user_data = icon;
+
+	eel_canvas_item_set (item,
+			     "highlighted_for_selection", (gboolean) icon->is_selected,
+			     "highlighted_as_keyboard_focus", icon == details->keyboard_focus,
+			     "highlighted_for_clipboard", (gboolean) icon->is_highlighted_for_clipboard,
+			     NULL);
+
+	/* Spare and new items sit at the origin */
+	if (nemo_icon_container_icon_is_positioned (icon)) {
+		eel_canvas_item_move (item, icon->x, icon->y);
+	}
+}
+
+/**
+ * nemo_icon_container_ensure_icon_item:
+ * @container: An icon container widget.
+ * @icon: An icon in @container.
+ *
+ * Gives @icon its canvas item if it has none, for code that needs
+ * more than the icon's geometry. The icon keeps the item until it is
+ * away from the visible area again and nothing else refers to it.
+ **/
+void
+nemo_icon_container_ensure_icon_item (NemoIconContainer *container,
+				      NemoIcon *icon)
+{
+	NemoIconGrid *grid;
+	EelDRect icon_rect;
+	double x, y;
+	guint n_rows;
+
+	if (icon->item != NULL) {
+		return;
+	}
+
+	grid = &container->details->grid;
+
+	icon_attach_item (container, icon);
+	nemo_icon_container_update_icon (container, icon);
+
+	/* Line the real image up with the square that stood in for it */
+	if (nemo_icon_container_icon_is_positioned (icon)) {
+		icon_rect = nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+		x = icon->x + (grid->icon_size - (icon_rect.x1 - icon_rect.x0)) / 2;
+		y = icon->y + grid->icon_size - (icon_rect.y1 - icon_rect.y0);
+
+		nemo_icon_container_icon_set_position (container, icon, x, y);
+		icon->saved_ltr_x = nemo_icon_container_is_layout_rtl (container) ?
+			nemo_icon_container_get_mirror_x_position (container, icon, icon->x) : icon->x;
+	}
+
+	if (grid->valid) {
+		n_rows = (grid->n_icons + grid->n_columns - 1) / grid->n_columns;
+		nemo_icon_canvas_item_set_entire_text (icon->item,
+						       get_icon_index (container, icon) / grid->n_columns == n_rows - 1);
+	}
+
+	spatial_index_icon_changed (container, icon);
+	eel_canvas_item_show (EEL_CANVAS_ITEM (icon->item));
+}
+
+/* Whether the icon's item could go back to the spares. Icons that are
+ * being interacted with, or waited for, keep theirs. */
+static gboolean
+icon_item_is_releasable (NemoIconContainer *container,
+			 NemoIcon *icon)
+{
+	NemoIconContainerDetails *details;
+
+	details = container->details;
+
+	return icon->item != NULL &&
+	       icon != details->keyboard_focus &&
+	       icon != details->stretch_icon &&
+	       icon != details->drag_icon &&
+	       icon != details->drop_target &&
+	       icon != details->pending_icon_to_reveal &&
+	       icon != details->pending_icon_to_rename &&
+	       icon != nemo_icon_container_get_icon_being_renamed (container);
+}
+
+static void
+icon_release_item (NemoIconContainer *container,
+		   NemoIcon *icon)
+{
+	NemoIconGrid *grid;
+	EelDRect icon_rect;
+
+	grid = &container->details->grid;
+
+	/* Back to the square of a grid cell */
+	if (nemo_icon_container_icon_is_positioned (icon)) {
+		icon_rect = nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+		icon->x += ((icon_rect.x1 - icon_rect.x0) - grid->icon_size) / 2;
+		icon->y += (icon_rect.y1 - icon_rect.y0) - grid->icon_size;
+	}
+
+	nemo_icon_canvas_item_recycle (icon->item);
+	g_queue_push_head (container->details->spare_items, icon->item);
+	icon->item = NULL;
+
+	spatial_index_icon_changed (container, icon);
+}
+
+/* Called when the layout settings may have changed. Outside of a grid
+ * layout every icon gets its item back, and the spares go. */
+static void
+update_lazy_items (NemoIconContainer *container)
+{
+	NemoIconContainerDetails *details;
+	EelCanvasItem *item;
+	GList *p;
+
+	details = container->details;
+
+	details->lazy_items = icon_items_can_be_lazy (container);
+	if (details->lazy_items) {
+		return;
+	}
+
+	for (p = details->icons; p != NULL; p = p->next) {
+		nemo_icon_container_ensure_icon_item (container, p->data);
+	}
+
+	while ((item = g_queue_pop_head (details->spare_items)) != NULL) {
+		eel_canvas_item_destroy (item);
+	}
+}
+
 /* Utility functions for NemoIconContainer.  */
 
 gboolean
@@ -448,6 +1107,7 @@ set_pending_icon_to_reveal (NemoIconContainer *container, NemoIcon *icon)
 	}
 
 	if (icon != NULL) {
+		nemo_icon_container_ensure_icon_item (container, icon);
 		g_signal_connect (icon->item, "destroy",
 				  G_CALLBACK (pending_icon_to_reveal_destroy_callback),
 				  container);
@@ -457,24 +1117,14 @@ set_pending_icon_to_reveal (NemoIconContainer *container, NemoIcon *icon)
 }
 
 static void
-item_get_canvas_bounds (NemoIconContainer *container,
-                        EelCanvasItem     *item,
+icon_get_canvas_bounds (NemoIconContainer *container,
+                        NemoIcon          *icon,
                         EelIRect          *bounds,
                         gboolean           safety_pad)
 {
 	EelDRect world_rect;
 
-	eel_canvas_item_get_bounds (item,
-				    &world_rect.x0,
-				    &world_rect.y0,
-				    &world_rect.x1,
-				    &world_rect.y1);
-	eel_canvas_item_i2w (item->parent,
-			     &world_rect.x0,
-			     &world_rect.y0);
-	eel_canvas_item_i2w (item->parent,
-			     &world_rect.x1,
-			     &world_rect.y1);
+	icon_get_world_bounds (container, icon, FALSE, &world_rect);
 	if (safety_pad) {
 		world_rect.x0 -= GET_VIEW_CONSTANT (container, icon_pad_left) + GET_VIEW_CONSTANT (container, icon_pad_right);
 		world_rect.x1 += GET_VIEW_CONSTANT (container, icon_pad_left) + GET_VIEW_CONSTANT (container, icon_pad_right);
@@ -483,12 +1133,12 @@ item_get_canvas_bounds (NemoIconContainer *container,
 		world_rect.y1 += GET_VIEW_CONSTANT (container, icon_pad_top) + GET_VIEW_CONSTANT (container, icon_pad_bottom);
 	}
 
-	eel_canvas_w2c (item->canvas,
+	eel_canvas_w2c (EEL_CANVAS (container),
 			world_rect.x0,
 			world_rect.y0,
 			&bounds->x0,
 			&bounds->y0);
-	eel_canvas_w2c (item->canvas,
+	eel_canvas_w2c (EEL_CANVAS (container),
 			world_rect.x1,
 			world_rect.y1,
 			&bounds->x1,
@@ -505,7 +1155,7 @@ icon_get_row_and_column_bounds (NemoIconContainer *container,
 	NemoIcon *one_icon;
 	EelIRect one_bounds;
 
-	item_get_canvas_bounds (container, EEL_CANVAS_ITEM (icon->item), bounds, safety_pad);
+	icon_get_canvas_bounds (container, icon, bounds, safety_pad);
 
 	for (p = container->details->icons; p != NULL; p = p->next) {
 		one_icon = p->data;
@@ -515,13 +1165,13 @@ icon_get_row_and_column_bounds (NemoIconContainer *container,
 		}
 
 		if (compare_icons_horizontal (container, icon, one_icon) == 0) {
-			item_get_canvas_bounds (container, EEL_CANVAS_ITEM (one_icon->item), &one_bounds, safety_pad);
+			icon_get_canvas_bounds (container, one_icon, &one_bounds, safety_pad);
 			bounds->x0 = MIN (bounds->x0, one_bounds.x0);
 			bounds->x1 = MAX (bounds->x1, one_bounds.x1);
 		}
 
 		if (compare_icons_vertical (container, icon, one_icon) == 0) {
-			item_get_canvas_bounds (container, EEL_CANVAS_ITEM (one_icon->item), &one_bounds, safety_pad);
+			icon_get_canvas_bounds (container, one_icon, &one_bounds, safety_pad);
 			bounds->y0 = MIN (bounds->y0, one_bounds.y0);
 			bounds->y1 = MAX (bounds->y1, one_bounds.y1);
 		}
@@ -554,7 +1204,7 @@ reveal_icon (NemoIconContainer *container,
 		/* ensure that we reveal the entire row/column */
 		icon_get_row_and_column_bounds (container, icon, &bounds, TRUE);
 	} else {
-		item_get_canvas_bounds (container, EEL_CANVAS_ITEM (icon->item), &bounds, TRUE);
+		icon_get_canvas_bounds (container, icon, &bounds, TRUE);
 	}
 	if (bounds.y0 < gtk_adjustment_get_value (vadj)) {
 		gtk_adjustment_set_value (vadj, bounds.y0);
@@ -647,7 +1297,8 @@ schedule_keyboard_icon_reveal (NemoIconContainer *container,
 static void
 clear_keyboard_focus (NemoIconContainer *container)
 {
-        if (container->details->keyboard_focus != NULL) {
+        if (container->details->keyboard_focus != NULL &&
+	    container->details->keyboard_focus->item != NULL) {
 		eel_canvas_item_set (EEL_CANVAS_ITEM (container->details->keyboard_focus->item),
 				       "highlighted_as_keyboard_focus", 0,
 				       NULL);
@@ -678,6 +1329,7 @@ set_keyboard_focus (NemoIconContainer *container,
 
 	container->details->keyboard_focus = icon;
 
+	nemo_icon_container_ensure_icon_item (container, icon);
 	eel_canvas_item_set (EEL_CANVAS_ITEM (container->details->keyboard_focus->item),
 			       "highlighted_as_keyboard_focus", 1,
 			       NULL);
@@ -911,7 +1563,29 @@ nemo_icon_container_update_scroll_region (NemoIconContainer *container)
 		container->details->reset_scroll_region_trigger = FALSE;
 	}
 
-	nemo_icon_container_get_all_icon_bounds (container, &x1, &y1, &x2, &y2, BOUNDS_USAGE_FOR_ENTIRE_ITEM);
+	if (nemo_icon_container_is_auto_layout (container) && icon_grid_is_current (container)) {
+		NemoIconGrid *grid = &container->details->grid;
+		GList *l;
+		guint n_rows, n_last_row;
+		int item_y2;
+
+		n_rows = (grid->n_icons + grid->n_columns - 1) / grid->n_columns;
+
+		x1 = 0;
+		y1 = 0;
+		x2 = grid->n_columns * grid->cell_width;
+		y2 = grid->start_y + n_rows * grid->row_height;
+
+		/* Only the last row shows its labels in full and may overflow its cell */
+		n_last_row = grid->n_icons - (n_rows - 1) * grid->n_columns;
+		for (l = g_list_last (container->details->icons); l != NULL && n_last_row > 0; l = l->prev, n_last_row--) {
+			nemo_icon_container_icon_get_bounding_box (container, l->data, NULL, NULL, NULL, &item_y2,
+								   BOUNDS_USAGE_FOR_ENTIRE_ITEM);
+			y2 = MAX (y2, item_y2);
+		}
+	} else {
+		nemo_icon_container_get_all_icon_bounds (container, &x1, &y1, &x2, &y2, BOUNDS_USAGE_FOR_ENTIRE_ITEM);
+	}
 
 	/* Add border at the "end"of the layout (i.e. after the icons), to
 	 * ensure we get some space when scrolled to the end.
@@ -997,10 +1671,108 @@ align_icons (NemoIconContainer *container)
     NEMO_ICON_CONTAINER_GET_CLASS (container)->align_icons (container);
 }
 
+static guint
+find_sorted_position (NemoIconContainer *container, NemoIcon **sorted, guint n_sorted, NemoIcon *icon)
+{
+    NemoIconContainerClass *klass;
+    guint low, high, middle;
+
+    klass = NEMO_ICON_CONTAINER_GET_CLASS (container);
+
+    /* First position whose icon sorts after @icon */
+    low = 0;
+    high = n_sorted;
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (klass->compare_icons (container, sorted[middle]->data, icon->data) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/* Puts the icons that changed since the last layout back in order: the
+ * others are still sorted, so each changed one is placed by a binary
+ * search instead of sorting everything again. All changes since the
+ * last layout are handled in one pass.
+ */
+static void
+resort_changed_icons (NemoIconContainer *container)
+{
+    NemoIconContainerDetails *details;
+    NemoIcon **sorted;
+    GList *changed, *l, *c;
+    guint n_icons, n_changed, n_sorted, i, position;
+
+    details = container->details;
+    n_changed = g_hash_table_size (details->resort_icons);
+
+    if (n_changed == 0) {
+        return;
+    }
+
+    n_icons = get_icon_count (container);
+
+    /* Past this, a full sort is cheaper */
+    if (n_changed * 4 > n_icons) {
+        nemo_icon_container_resort (container);
+        g_hash_table_remove_all (details->resort_icons);
+        return;
+    }
+
+    sorted = g_new (NemoIcon *, n_icons);
+    n_sorted = 0;
+    for (l = details->icons; l != NULL; l = l->next) {
+        if (!g_hash_table_contains (details->resort_icons, l->data)) {
+            sorted[n_sorted++] = l->data;
+        }
+    }
+
+    changed = g_hash_table_get_keys (details->resort_icons);
+    nemo_icon_container_sort_icons (container, &changed);
+    g_hash_table_remove_all (details->resort_icons);
+
+    /* Merge, reusing the links of the icon list */
+    i = 0;
+    c = changed;
+    position = find_sorted_position (container, sorted, n_sorted, c->data);
+
+    for (l = details->icons; l != NULL; l = l->next) {
+        if (c != NULL && i >= position) {
+            l->data = c->data;
+            c = c->next;
+            if (c != NULL) {
+                position = MAX (position, find_sorted_position (container, sorted, n_sorted, c->data));
+            }
+        } else {
+            l->data = sorted[i++];
+        }
+    }
+
+    nemo_icon_container_invalidate_icon_array (container);
+
+    g_list_free (changed);
+    g_free (sorted);
+}
+
+/* The grid only describes the icons if none were added or removed
+ * since it was laid down; adding and removing icons invalidates it. */
+static gboolean
+icon_grid_is_current (NemoIconContainer *container)
+{
+    return container->details->grid.valid;
+}
+
 static void
 redo_layout_internal (NemoIconContainer *container)
 {
     container->details->fixed_text_height = -1;
+    container->details->grid.valid = FALSE;
+    invalidate_spatial_index (container);
+    update_lazy_items (container);
 
     if (NEMO_ICON_CONTAINER_GET_CLASS (container)->finish_adding_new_icons != NULL) {
         NEMO_ICON_CONTAINER_GET_CLASS (container)->finish_adding_new_icons (container);
@@ -1016,6 +1788,9 @@ redo_layout_internal (NemoIconContainer *container)
         if (container->details->needs_resort) {
             nemo_icon_container_resort (container);
             container->details->needs_resort = FALSE;
+            g_hash_table_remove_all (container->details->resort_icons);
+        } else {
+            resort_changed_icons (container);
         }
 
         NEMO_ICON_CONTAINER_GET_CLASS (container)->lay_down_icons (container, container->details->icons, 0);
@@ -1094,7 +1869,9 @@ invalidate_label_sizes (NemoIconContainer *container)
 	for (p = container->details->icons; p != NULL; p = p->next) {
 		icon = p->data;
 
-		nemo_icon_canvas_item_invalidate_label_size (icon->item);
+		if (icon->item != NULL) {
+			nemo_icon_canvas_item_invalidate_label_size (icon->item);
+		}
 	}
 }
 
@@ -1185,6 +1962,10 @@ select_one_unselect_others (NemoIconContainer *container,
 static gboolean
 unselect_all (NemoIconContainer *container)
 {
+	if (container->details->n_selected == 0) {
+		return FALSE;
+	}
+
 	return select_one_unselect_others (container, NULL);
 }
 
@@ -1194,43 +1975,51 @@ rubberband_select (NemoIconContainer *container,
 		   const EelDRect *previous_rect,
 		   const EelDRect *current_rect)
 {
-	GList *p;
-	gboolean selection_changed, is_in, canvas_rect_calculated;
+	GPtrArray *icons;
+	gboolean selection_changed, is_in;
 	NemoIcon *icon;
 	EelIRect canvas_rect;
+	EelDRect area;
 	EelCanvas *canvas;
+	guint i;
 
 	selection_changed = FALSE;
-	canvas_rect_calculated = FALSE;
 
-	for (p = container->details->icons; p != NULL; p = p->next) {
-		icon = p->data;
+	canvas = EEL_CANVAS (container);
+	eel_canvas_w2c (canvas,
+			current_rect->x0,
+			current_rect->y0,
+			&canvas_rect.x0,
+			&canvas_rect.y0);
+	eel_canvas_w2c (canvas,
+			current_rect->x1,
+			current_rect->y1,
+			&canvas_rect.x1,
+			&canvas_rect.y1);
+
+	/* Icons outside both the previous and the current band still have
+	 * the state they had when rubberbanding started, so only the ones
+	 * under either band need to be looked at.
+	 */
+	if (previous_rect != NULL) {
+		eel_drect_union (&area, previous_rect, current_rect);
+		icons = nemo_icon_container_get_icons_in_area (container, &area);
+	} else {
+		icons = g_ptr_array_ref (get_icon_array (container));
+	}
 
-		if (!canvas_rect_calculated) {
-			/* Only do this calculation once, since all the canvas items
-			 * we are interating are in the same coordinate space
-			 */
-			canvas = EEL_CANVAS_ITEM (icon->item)->canvas;
-			eel_canvas_w2c (canvas,
-					current_rect->x0,
-					current_rect->y0,
-					&canvas_rect.x0,
-					&canvas_rect.y0);
-			eel_canvas_w2c (canvas,
-					current_rect->x1,
-					current_rect->y1,
-					&canvas_rect.x1,
-					&canvas_rect.y1);
-			canvas_rect_calculated = TRUE;
-		}
+	for (i = 0; i < icons->len; i++) {
+		icon = g_ptr_array_index (icons, i);
 
-		is_in = nemo_icon_canvas_item_hit_test_rectangle (icon->item, canvas_rect);
+		is_in = icon_hit_test_rectangle (container, icon, canvas_rect);
 
 		selection_changed |= icon_set_selected
 			(container, icon,
 			 is_in ^ icon->was_selected_before_rubberband);
 	}
 
+	g_ptr_array_unref (icons);
+
 	if (selection_changed) {
 		g_signal_emit (container,
 				 signals[SELECTION_CHANGED], 0);
@@ -1387,6 +2176,9 @@ start_rubberbanding (NemoIconContainer *container,
 		(EEL_CANVAS (container), event->x, event->y,
 		 &band_info->start_x, &band_info->start_y);
 
+	band_info->prev_rect.x0 = band_info->prev_rect.x1 = band_info->start_x;
+	band_info->prev_rect.y0 = band_info->prev_rect.y1 = band_info->start_y;
+
 	context = gtk_widget_get_style_context (GTK_WIDGET (container));
 	gtk_style_context_save (context);
 	gtk_style_context_add_class (context, GTK_STYLE_CLASS_RUBBERBAND);
@@ -1583,14 +2375,14 @@ compare_icons_horizontal (NemoIconContainer *container,
 	EelDRect world_rect;
 	int ax, bx;
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_a->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_a);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
 		 get_cmp_point_y (container, world_rect),
 		 &ax,
 		 NULL);
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_b->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_b);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -1615,14 +2407,14 @@ compare_icons_vertical (NemoIconContainer *container,
 	EelDRect world_rect;
 	int ay, by;
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_a->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_a);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
 		 get_cmp_point_y (container, world_rect),
 		 NULL,
 		 &ay);
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_b->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_b);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -1647,14 +2439,14 @@ compare_icons_horizontal_first (NemoIconContainer *container,
 	EelDRect world_rect;
 	int ax, ay, bx, by;
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_a->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_a);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
 		 get_cmp_point_y (container, world_rect),
 		 &ax,
 		 &ay);
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_b->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_b);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -1685,14 +2477,14 @@ compare_icons_vertical_first (NemoIconContainer *container,
 	EelDRect world_rect;
 	int ax, ay, bx, by;
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_a->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_a);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
 		 get_cmp_point_y (container, world_rect),
 		 &ax,
 		 &ay);
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon_b->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon_b);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -1759,14 +2551,14 @@ static int
 compare_with_start_row (NemoIconContainer *container,
 			NemoIcon *icon)
 {
-	EelCanvasItem *item;
+	EelIRect bounds;
 
-	item = EEL_CANVAS_ITEM (icon->item);
+	icon_get_canvas_bounds (container, icon, &bounds, FALSE);
 
-	if (container->details->arrow_key_start_y < item->y1) {
+	if (container->details->arrow_key_start_y < bounds.y0) {
 		return -1;
 	}
-	if (container->details->arrow_key_start_y > item->y2) {
+	if (container->details->arrow_key_start_y > bounds.y1) {
 		return +1;
 	}
 	return 0;
@@ -1776,14 +2568,14 @@ static int
 compare_with_start_column (NemoIconContainer *container,
 			   NemoIcon *icon)
 {
-	EelCanvasItem *item;
+	EelIRect bounds;
 
-	item = EEL_CANVAS_ITEM (icon->item);
+	icon_get_canvas_bounds (container, icon, &bounds, FALSE);
 
-	if (container->details->arrow_key_start_x < item->x1) {
+	if (container->details->arrow_key_start_x < bounds.x0) {
 		return -1;
 	}
-	if (container->details->arrow_key_start_x > item->x2) {
+	if (container->details->arrow_key_start_x > bounds.x1) {
 		return +1;
 	}
 	return 0;
@@ -2151,7 +2943,7 @@ closest_in_90_degrees (NemoIconContainer *container,
 	int *best_dist;
 
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (candidate->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, candidate);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -2210,19 +3002,16 @@ closest_in_90_degrees (NemoIconContainer *container,
 }
 
 static EelDRect
-get_rubberband (NemoIcon *icon1,
+get_rubberband (NemoIconContainer *container,
+		NemoIcon *icon1,
 		NemoIcon *icon2)
 {
 	EelDRect rect1;
 	EelDRect rect2;
 	EelDRect ret;
 
-	eel_canvas_item_get_bounds (EEL_CANVAS_ITEM (icon1->item),
-				    &rect1.x0, &rect1.y0,
-				    &rect1.x1, &rect1.y1);
-	eel_canvas_item_get_bounds (EEL_CANVAS_ITEM (icon2->item),
-				    &rect2.x0, &rect2.y0,
-				    &rect2.x1, &rect2.y1);
+	icon_get_world_bounds (container, icon1, FALSE, &rect1);
+	icon_get_world_bounds (container, icon2, FALSE, &rect2);
 
 	eel_drect_union (&ret, &rect1, &rect2);
 
@@ -2261,7 +3050,8 @@ keyboard_move_to (NemoIconContainer *container,
 		set_keyboard_focus (container, icon);
 
 		if (icon && container->details->keyboard_rubberband_start) {
-			rect = get_rubberband (container->details->keyboard_rubberband_start,
+			rect = get_rubberband (container,
+					       container->details->keyboard_rubberband_start,
 					       icon);
 			rubberband_select (container, NULL, &rect);
 		}
@@ -2345,7 +3135,7 @@ record_arrow_key_start (NemoIconContainer *container,
 {
 	EelDRect world_rect;
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon);
 	eel_canvas_w2c
 		(EEL_CANVAS (container),
 		 get_cmp_point_x (container, world_rect),
@@ -2661,9 +3451,8 @@ select_previous_or_next_icon (NemoIconContainer *container,
 			      GdkEventKey *event)
 {
 	NemoIcon *icon;
-	const GList *item;
+	int index, n_icons;
 
-	item = NULL;
 	/* Chose the icon to start with.
 	 * If we have a keyboard focus, start with it.
 	 * Otherwise, use the single selected icon.
@@ -2673,24 +3462,22 @@ select_previous_or_next_icon (NemoIconContainer *container,
 		icon = get_first_selected_icon (container);
 	}
 
+	n_icons = get_icon_count (container);
+
 	if (icon != NULL) {
 		/* must have at least @icon in the list */
-		g_assert (container->details->icons != NULL);
-		item = g_list_find (container->details->icons, icon);
-		g_assert (item != NULL);
+		g_assert (n_icons > 0);
+		index = get_icon_index (container, icon);
 
-		item = next ? item->next : item->prev;
-		if (item == NULL) {
-			item = next ? g_list_first (container->details->icons) : g_list_last (container->details->icons);
-		}
+		/* wrap around at either end */
+		index = next ? (index + 1) % n_icons : (index + n_icons - 1) % n_icons;
+		icon = get_icon_at_index (container, index);
 
-	} else if (container->details->icons != NULL) {
+	} else if (n_icons > 0) {
 		/* no selection yet, pick the first or last item to select */
-		item = next ? g_list_first (container->details->icons) : g_list_last (container->details->icons);
+		icon = get_icon_at_index (container, next ? 0 : n_icons - 1);
 	}
 
-	icon = (item != NULL) ? item->data : NULL;
-
 	if (icon != NULL) {
 		keyboard_move_to (container, icon, NULL, event);
 	}
@@ -2745,6 +3532,8 @@ destroy (GtkWidget *object)
 
 	remove_search_entry_timeout (container);
 
+	nemo_thumbnail_remove_viewport (container);
+
 	GTK_WIDGET_CLASS (nemo_icon_container_parent_class)->destroy (object);
 }
 
@@ -2768,6 +3557,14 @@ finalize (GObject *object)
 
 	g_hash_table_destroy (details->icon_set);
 	details->icon_set = NULL;
+	g_hash_table_destroy (details->resort_icons);
+	details->resort_icons = NULL;
+	g_ptr_array_free (details->icon_array, TRUE);
+	details->icon_array = NULL;
+	g_queue_free (details->spare_items);
+	details->spare_items = NULL;
+	invalidate_spatial_index (NEMO_ICON_CONTAINER (object));
+	g_clear_pointer (&details->spatial_index.dirty, g_hash_table_destroy);
 
 	g_free (details->font);
 
@@ -4874,7 +5671,7 @@ update_selected (NemoIconContainer *container)
 
 	for (node = container->details->icons; node != NULL; node = node->next) {
 		icon = node->data;
-		if (icon->is_selected) {
+		if (icon->is_selected && icon->item != NULL) {
 			eel_canvas_item_request_update (EEL_CANVAS_ITEM (icon->item));
 		}
 	}
@@ -4906,6 +5703,9 @@ nemo_icon_container_init (NemoIconContainer *container)
 	details = g_new0 (NemoIconContainerDetails, 1);
 
 	details->icon_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	details->resort_icons = g_hash_table_new (g_direct_hash, g_direct_equal);
+	details->icon_array = g_ptr_array_new ();
+	details->spare_items = g_queue_new ();
 	details->layout_timestamp = UNDEFINED_TIME;
 	details->zoom_level = NEMO_ZOOM_LEVEL_STANDARD;
 
@@ -5239,9 +6039,14 @@ nemo_icon_container_clear (NemoIconContainer *container)
 	details->icons = NULL;
 	g_list_free (details->new_icons);
 	details->new_icons = NULL;
+	details->grid.valid = FALSE;
+	nemo_icon_container_invalidate_icon_array (container);
+	invalidate_spatial_index (container);
+	details->n_selected = 0;
 
  	g_hash_table_destroy (details->icon_set);
  	details->icon_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	g_hash_table_remove_all (details->resort_icons);
 }
 
 gboolean
@@ -5257,6 +6062,7 @@ nemo_icon_container_get_first_visible_icon (NemoIconContainer *container)
 	NemoIcon *icon, *best_icon;
 	double x, y;
 	double x1, y1, x2, y2;
+	EelDRect bounds;
 	double *pos, best_pos;
 	double hadj_v, vadj_v, h_page_size;
 	gboolean better_icon;
@@ -5285,8 +6091,11 @@ nemo_icon_container_get_first_visible_icon (NemoIconContainer *container)
 		icon = l->data;
 
 		if (nemo_icon_container_icon_is_positioned (icon)) {
-			eel_canvas_item_get_bounds (EEL_CANVAS_ITEM (icon->item),
-						    &x1, &y1, &x2, &y2);
+			icon_get_world_bounds (container, icon, FALSE, &bounds);
+			x1 = bounds.x0;
+			y1 = bounds.y0;
+			x2 = bounds.x1;
+			y2 = bounds.y1;
 
 			compare_lt = FALSE;
 			if (nemo_icon_container_is_layout_vertical (container)) {
@@ -5323,6 +6132,20 @@ nemo_icon_container_get_first_visible_icon (NemoIconContainer *container)
 	return best_icon ? best_icon->data : NULL;
 }
 
+/* Whether the icon is in, or within half a page of, the visible area,
+ * as of the last visibility update. */
+gboolean
+nemo_icon_container_is_icon_visible (NemoIconContainer *container,
+				     NemoIconData *data)
+{
+	NemoIcon *icon;
+
+	icon = g_hash_table_lookup (container->details->icon_set, data);
+
+	return icon != NULL && icon->item != NULL &&
+	       nemo_icon_canvas_item_get_is_visible (icon->item);
+}
+
 /* puts the icon at the top of the screen */
 void
 nemo_icon_container_scroll_to_icon (NemoIconContainer  *container,
@@ -5353,7 +6176,7 @@ nemo_icon_container_scroll_to_icon (NemoIconContainer  *container,
 				/* ensure that we reveal the entire row/column */
 				icon_get_row_and_column_bounds (container, icon, &bounds, TRUE);
 			} else {
-				item_get_canvas_bounds (container, EEL_CANVAS_ITEM (icon->item), &bounds, TRUE);
+				icon_get_canvas_bounds (container, icon, &bounds, TRUE);
 			}
 
 			if (nemo_icon_container_is_layout_vertical (container)) {
@@ -5427,19 +6250,39 @@ icon_destroy (NemoIconContainer *container,
 	NemoIconContainerDetails *details;
 	gboolean was_selected;
 	NemoIcon *icon_to_focus;
-	GList *item;
+	guint index, i;
 
 	details = container->details;
 
-	item = g_list_find (details->icons, icon);
-	item = item->next ? item->next : item->prev;
-	icon_to_focus = (item != NULL) ? item->data : NULL;
+	index = get_icon_index (container, icon);
+	icon_to_focus = get_icon_at_index (container, index + 1);
+	if (icon_to_focus == NULL) {
+		icon_to_focus = get_icon_at_index (container, (int) index - 1);
+	}
 
 	details->icons = g_list_remove (details->icons, icon);
+	details->grid.valid = FALSE;
+
+	/* Keep the array in step rather than rebuilding it for each
+	 * of a series of removals. */
+	g_ptr_array_remove_index (details->icon_array, index);
+	for (i = index; i < details->icon_array->len; i++) {
+		((NemoIcon *) g_ptr_array_index (details->icon_array, i))->index = i;
+	}
+	if (details->spatial_index.valid) {
+		spatial_index_unfile_icon (&details->spatial_index, icon);
+		if (details->spatial_index.dirty != NULL) {
+			g_hash_table_remove (details->spatial_index.dirty, icon);
+		}
+	}
 	details->new_icons = g_list_remove (details->new_icons, icon);
 	g_hash_table_remove (details->icon_set, icon->data);
+	g_hash_table_remove (details->resort_icons, icon);
 
 	was_selected = icon->is_selected;
+	if (was_selected) {
+		details->n_selected--;
+	}
 
 	if (details->keyboard_focus == icon ||
 	    details->keyboard_focus == NULL) {
@@ -5590,19 +6433,47 @@ nemo_icon_container_unfreeze_updates (NemoIconContainer *container)
 	klass->unfreeze_updates (container);
 }
 
+/* Whether the icon is within half a page of the visible area. */
+static gboolean
+icon_is_near_visible_area (NemoIconContainer *container,
+			   NemoIcon *icon,
+			   double min_x, double min_y,
+			   double max_x, double max_y)
+{
+	EelDRect bounds;
+	gint overshoot;
+
+	icon_get_world_bounds (container, icon, FALSE, &bounds);
+
+	if (nemo_icon_container_is_layout_vertical (container)) {
+		overshoot = (max_x - min_x) / 2;
+
+		return bounds.x1 >= min_x - overshoot && bounds.x0 <= max_x + overshoot;
+	}
+
+	overshoot = (max_y - min_y) / 2;
+
+	return bounds.y1 >= min_y - overshoot && bounds.y0 <= max_y + overshoot;
+}
+
 static gboolean
 update_visible_icons_cb (NemoIconContainer *container)
 {
 	GtkAdjustment *vadj, *hadj;
 	double min_y, max_y;
 	double min_x, max_x;
-	double x0, y0, x1, y1;
 	GList *node;
 	NemoIcon *icon;
 	gboolean visible;
 	GtkAllocation allocation;
+	GList *visible_files;
+	NemoIconGrid *grid;
+	gboolean use_grid;
+	guint index, first_visible, last_visible;
 
     container->details->update_visible_icons_id = 0;
+    visible_files = NULL;
+    grid = &container->details->grid;
 
 	hadj = gtk_scrollable_get_hadjustment (GTK_SCROLLABLE (container));
 	vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (container));
@@ -5619,36 +6490,39 @@ update_visible_icons_cb (NemoIconContainer *container)
 	eel_canvas_c2w (EEL_CANVAS (container),
 			max_x, max_y, &max_x, &max_y);
 
-	for (node = g_list_last (container->details->icons); node != NULL; node = node->prev) {
-		icon = node->data;
+	/* With a grid layout the visible icons are a range of indices, so
+	 * icons far off screen never have their labels measured here. */
+	use_grid = !nemo_icon_container_is_layout_vertical (container) &&
+		   icon_grid_is_current (container) &&
+		   grid->n_icons > 0;
+	first_visible = last_visible = 0;
 
-		if (nemo_icon_container_icon_is_positioned (icon)) {
-			eel_canvas_item_get_bounds (EEL_CANVAS_ITEM (icon->item),
-						    &x0,
-						    &y0,
-						    &x1,
-						    &y1);
-			eel_canvas_item_i2w (EEL_CANVAS_ITEM (icon->item)->parent,
-					     &x0,
-					     &y0);
-			eel_canvas_item_i2w (EEL_CANVAS_ITEM (icon->item)->parent,
-					     &x1,
-					     &y1);
-
-            gint overshoot;
+	if (use_grid) {
+		double overshoot_y, top, bottom;
 
-			if (nemo_icon_container_is_layout_vertical (container)) {
-                overshoot = (max_x - min_x) / 2;
+		overshoot_y = (max_y - min_y) / 2;
+		top = MAX (min_y - overshoot_y - grid->start_y, 0);
+		bottom = MAX (max_y + overshoot_y - grid->start_y, 0);
 
-				visible = x1 >= min_x - overshoot && x0 <= max_x + overshoot;
-			} else {
-                overshoot = (max_y - min_y) / 2;
+		first_visible = (guint) (top / grid->row_height) * grid->n_columns;
+		last_visible = ((guint) (bottom / grid->row_height) + 1) * grid->n_columns;
+	}
 
-				visible = y1 >= min_y - overshoot && y0 <= max_y + overshoot;
-			}
+	index = get_icon_count (container);
+
+	for (node = g_list_last (container->details->icons); node != NULL; node = node->prev) {
+		icon = node->data;
+		index--;
 
-			if (visible) {
-				nemo_icon_canvas_item_set_is_visible (icon->item, TRUE);
+		if (use_grid) {
+			visible = index >= first_visible && index < last_visible;
+		} else if (nemo_icon_container_icon_is_positioned (icon)) {
+			visible = icon_is_near_visible_area (container, icon, min_x, min_y, max_x, max_y);
+		} else {
+			continue;
+		}
+
+		if (visible) {
                 NemoFile *file = NEMO_FILE (icon->data);
 
                 if (!icon->ok_to_show_thumb) {
@@ -5660,19 +6534,34 @@ update_visible_icons_cb (NemoIconContainer *container)
                     }
 
                     nemo_file_invalidate_attributes (file, NEMO_FILE_DEFERRED_ATTRIBUTES);
+                }
+
+                visible_files = g_list_prepend (visible_files, file);
+
+                if (icon->item == NULL) {
+                    nemo_icon_container_ensure_icon_item (container, icon);
                 } else {
-                    gchar *uri = nemo_file_get_uri (file);
-                    nemo_thumbnail_prioritize (uri);
-                    g_free (uri);
+                    nemo_icon_container_update_icon (container, icon);
                 }
+			nemo_icon_canvas_item_set_is_visible (icon->item, TRUE);
+		} else if (use_grid && container->details->lazy_items &&
+			   icon_item_is_releasable (container, icon)) {
+			icon_release_item (container, icon);
+		} else if (icon->item != NULL) {
+			nemo_icon_canvas_item_set_is_visible (icon->item, FALSE);
+		}
+	}
 
-                nemo_icon_container_update_icon (container, icon);
-			} else {
-				nemo_icon_canvas_item_set_is_visible (icon->item, FALSE);
-			}
+	/* Keep about as many spares as there are icons in reach */
+	if (use_grid) {
+		while (g_queue_get_length (container->details->spare_items) > last_visible - first_visible) {
+			eel_canvas_item_destroy (g_queue_pop_tail (container->details->spare_items));
 		}
 	}
 
+    nemo_thumbnail_update_viewport (container, visible_files);
+    g_list_free (visible_files);
+
     return G_SOURCE_REMOVE;
 }
 
@@ -5755,7 +6644,6 @@ nemo_icon_container_add (NemoIconContainer *container,
 {
 	NemoIconContainerDetails *details;
 	NemoIcon *icon;
-	EelCanvasItem *band, *item;
 
 	g_return_val_if_fail (NEMO_IS_ICON_CONTAINER (container), FALSE);
 	g_return_val_if_fail (data != NULL, FALSE);
@@ -5778,23 +6666,19 @@ nemo_icon_container_add (NemoIconContainer *container,
 	 */
 	icon->has_lazy_position = is_old_or_unknown_icon_data (container, data);
 	icon->scale = 1.0;
- 	icon->item = NEMO_ICON_CANVAS_ITEM
-		(eel_canvas_item_new (EEL_CANVAS_GROUP (EEL_CANVAS (container)->root),
-				      nemo_icon_canvas_item_get_type (),
-				      "visible", FALSE,
-				      NULL));
-	icon->item->user_data = icon;
 
-	/* Make sure the icon is under the selection_rectangle */
-	item = EEL_CANVAS_ITEM (icon->item);
-	band = NEMO_ICON_CONTAINER (item->canvas)->details->rubberband_info.selection_rectangle;
-	if (band) {
-		eel_canvas_item_send_behind (item, band);
+	/* A grid layout gives icons their item once they get near the
+	 * visible area. */
+	if (!details->lazy_items) {
+		icon_attach_item (container, icon);
 	}
 
 	/* Put it on both lists. */
 	details->icons = g_list_prepend (details->icons, icon);
 	details->new_icons = g_list_prepend (details->new_icons, icon);
+	details->grid.valid = FALSE;
+	nemo_icon_container_invalidate_icon_array (container);
+	spatial_index_icon_changed (container, icon);
 
 	g_hash_table_insert (details->icon_set, data, icon);
 
@@ -5844,7 +6728,7 @@ nemo_icon_container_remove (NemoIconContainer *container,
 		return FALSE;
 	}
 
-    gtk_widget_set_tooltip_text (GTK_WIDGET (EEL_CANVAS_ITEM (icon->item)->canvas), "");
+    gtk_widget_set_tooltip_text (GTK_WIDGET (container), "");
 	icon_destroy (container, icon);
 	schedule_redo_layout (container);
 
@@ -5873,7 +6757,7 @@ nemo_icon_container_request_update (NemoIconContainer *container,
 
 	if (icon != NULL) {
 		nemo_icon_container_update_icon (container, icon);
-		container->details->needs_resort = TRUE;
+		g_hash_table_add (container->details->resort_icons, icon);
 		schedule_redo_layout (container);
 	}
 }
@@ -5890,7 +6774,9 @@ nemo_icon_container_invalidate_labels (NemoIconContainer *container)
     for (p = container->details->icons; p != NULL; p = p->next) {
         icon = p->data;
 
-        nemo_icon_canvas_item_invalidate_label (icon->item);
+        if (icon->item != NULL) {
+            nemo_icon_canvas_item_invalidate_label (icon->item);
+        }
     }
 }
 
@@ -5961,14 +6847,17 @@ GList *
 nemo_icon_container_get_real_selection (NemoIconContainer *container)
 {
     GList *list, *p;
+    guint n_found;
 
     list = NULL;
-    for (p = container->details->icons; p != NULL; p = p->next) {
+    n_found = 0;
+    for (p = container->details->icons; p != NULL && n_found < container->details->n_selected; p = p->next) {
         NemoIcon *icon;
 
         icon = p->data;
         if (icon->is_selected) {
             list = g_list_prepend (list, icon->data);
+            n_found++;
         }
     }
 
@@ -6305,6 +7194,10 @@ get_nth_selected_icon (NemoIconContainer *container, int index)
 
 	g_assert (index > 0);
 
+	if ((guint) index > container->details->n_selected) {
+		return NULL;
+	}
+
 	/* Find the nth selected icon. */
 	selection_count = 0;
 	for (p = container->details->icons; p != NULL; p = p->next) {
@@ -6327,28 +7220,19 @@ get_first_selected_icon (NemoIconContainer *container)
 static gboolean
 has_multiple_selection (NemoIconContainer *container)
 {
-        return get_nth_selected_icon (container, 2) != NULL;
+        return container->details->n_selected > 1;
 }
 
 static gboolean
 all_selected (NemoIconContainer *container)
 {
-	GList *p;
-	NemoIcon *icon;
-
-	for (p = container->details->icons; p != NULL; p = p->next) {
-		icon = p->data;
-		if (!icon->is_selected) {
-			return FALSE;
-		}
-	}
-	return TRUE;
+	return container->details->n_selected == get_icon_count (container);
 }
 
 static gboolean
 has_selection (NemoIconContainer *container)
 {
-        return get_nth_selected_icon (container, 1) != NULL;
+        return container->details->n_selected > 0;
 }
 
 /**
@@ -6382,6 +7266,7 @@ nemo_icon_container_show_stretch_handles (NemoIconContainer *container)
 		ungrab_stretch_icon (container);
 		emit_stretch_ended (container, details->stretch_icon);
 	}
+	nemo_icon_container_ensure_icon_item (container, icon);
 	nemo_icon_canvas_item_set_show_stretch_handles (icon->item, TRUE);
 	details->stretch_icon = icon;
 
@@ -6580,6 +7465,7 @@ nemo_icon_container_set_auto_layout (NemoIconContainer *container,
 
     container->details->stored_auto_layout = auto_layout;
 	container->details->auto_layout = auto_layout;
+	update_lazy_items (container);
 
 	if (!auto_layout) {
 		reload_icon_positions (container);
@@ -6617,6 +7503,7 @@ nemo_icon_container_set_horizontal_layout (NemoIconContainer *container,
     }
 
     container->details->layout_mode = layout_mode;
+    update_lazy_items (container);
 }
 
 gboolean
@@ -6697,6 +7584,7 @@ nemo_icon_container_set_layout_mode (NemoIconContainer *container,
 	g_return_if_fail (NEMO_IS_ICON_CONTAINER (container));
 
 	container->details->layout_mode = mode;
+	update_lazy_items (container);
 
 	container->details->needs_resort = TRUE;
 
@@ -6715,6 +7603,7 @@ nemo_icon_container_set_label_position (NemoIconContainer *container,
 
 	if (container->details->label_position != position) {
 		container->details->label_position = position;
+		update_lazy_items (container);
 
 		nemo_icon_container_invalidate_labels (container);
 		nemo_icon_container_request_update_all (container);
@@ -6816,6 +7705,7 @@ set_pending_icon_to_rename (NemoIconContainer *container, NemoIcon *icon)
 	}
 
 	if (icon != NULL) {
+		nemo_icon_container_ensure_icon_item (container, icon);
 		g_signal_connect (icon->item, "destroy",
 				  G_CALLBACK (pending_icon_to_rename_destroy_callback), container);
 	}
@@ -6897,6 +7787,7 @@ nemo_icon_container_start_renaming_selected_item (NemoIconContainer *container,
 	}
 
 	set_pending_icon_to_rename (container, NULL);
+	nemo_icon_container_ensure_icon_item (container, icon);
 
 	/* Make a copy of the original editable text for a later compare */
 	editable_text = nemo_icon_canvas_item_get_editable_text (icon->item);
@@ -7126,6 +8017,7 @@ nemo_icon_container_set_is_desktop (NemoIconContainer *container,
     g_return_if_fail (NEMO_IS_ICON_CONTAINER (container));
 
     container->details->is_desktop = is_desktop;
+    update_lazy_items (container);
 
     g_signal_handlers_disconnect_by_func (nemo_icon_view_preferences,
                                           text_ellipsis_limit_changed_container_callback,
@@ -7307,19 +8199,29 @@ nemo_icon_container_set_highlighted_for_clipboard (NemoIconContainer *container,
 {
 	GList *l;
 	NemoIcon *icon;
+	GHashTable *clipboard_set;
 	gboolean highlighted_for_clipboard;
 
 	g_return_if_fail (NEMO_IS_ICON_CONTAINER (container));
 
+	clipboard_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (l = clipboard_icon_data; l != NULL; l = l->next) {
+		g_hash_table_add (clipboard_set, l->data);
+	}
+
 	for (l = container->details->icons; l != NULL; l = l->next) {
 		icon = l->data;
-		highlighted_for_clipboard = (g_list_find (clipboard_icon_data, icon->data) != NULL);
+		highlighted_for_clipboard = g_hash_table_contains (clipboard_set, icon->data);
+		icon->is_highlighted_for_clipboard = highlighted_for_clipboard;
 
-		eel_canvas_item_set (EEL_CANVAS_ITEM (icon->item),
-				     "highlighted-for-clipboard", highlighted_for_clipboard,
-				     NULL);
+		if (icon->item != NULL) {
+			eel_canvas_item_set (EEL_CANVAS_ITEM (icon->item),
+					     "highlighted-for-clipboard", highlighted_for_clipboard,
+					     NULL);
+		}
 	}
 
+	g_hash_table_destroy (clipboard_set);
 }
 
 /* NemoIconContainerAccessible */
@@ -7455,20 +8357,30 @@ nemo_icon_container_accessible_update_selection (AtkObject *accessible)
 
 	priv = accessible_get_priv (accessible);
 
-	if (priv->selection) {
-		g_list_free (priv->selection);
-		priv->selection = NULL;
+	if (priv->selection == NULL) {
+		priv->selection = g_ptr_array_new ();
 	}
+	g_ptr_array_set_size (priv->selection, 0);
 
-	for (l = container->details->icons; l != NULL; l = l->next) {
+	for (l = container->details->icons;
+	     l != NULL && priv->selection->len < container->details->n_selected;
+	     l = l->next) {
 		icon = l->data;
 		if (icon->is_selected) {
-			priv->selection = g_list_prepend (priv->selection,
-							  icon);
+			g_ptr_array_add (priv->selection, icon);
 		}
 	}
+}
 
-	priv->selection = g_list_reverse (priv->selection);
+static NemoIcon *
+accessible_get_selected_icon (NemoIconContainerAccessiblePrivate *priv,
+			      int i)
+{
+	if (i < 0 || (guint) i >= priv->selection->len) {
+		return NULL;
+	}
+
+	return g_ptr_array_index (priv->selection, i);
 }
 
 static void
@@ -7491,9 +8403,10 @@ nemo_icon_container_accessible_icon_added_cb (NemoIconContainer *container,
 	icon = g_hash_table_lookup (container->details->icon_set, icon_data);
 	if (icon) {
 		atk_parent = ATK_OBJECT (data);
-		atk_child = atk_gobject_accessible_for_object
-			(G_OBJECT (icon->item));
-		index = g_list_index (container->details->icons, icon);
+		/* Icons away from the visible area may have no item yet */
+		atk_child = icon->item != NULL ?
+			atk_gobject_accessible_for_object (G_OBJECT (icon->item)) : NULL;
+		index = get_icon_index (container, icon);
 
 		g_signal_emit_by_name (atk_parent, "children_changed::add",
 				       index, atk_child, NULL);
@@ -7513,9 +8426,9 @@ nemo_icon_container_accessible_icon_removed_cb (NemoIconContainer *container,
 	icon = g_hash_table_lookup (container->details->icon_set, icon_data);
 	if (icon) {
 		atk_parent = ATK_OBJECT (data);
-		atk_child = atk_gobject_accessible_for_object
-			(G_OBJECT (icon->item));
-		index = g_list_index (container->details->icons, icon);
+		atk_child = icon->item != NULL ?
+			atk_gobject_accessible_for_object (G_OBJECT (icon->item)) : NULL;
+		index = get_icon_index (container, icon);
 
 		g_signal_emit_by_name (atk_parent, "children_changed::remove",
 				       index, atk_child, NULL);
@@ -7546,7 +8459,7 @@ nemo_icon_container_accessible_add_selection (AtkSelection *accessible,
 
         container = NEMO_ICON_CONTAINER (widget);
 
-	icon = g_list_nth_data (container->details->icons, i);
+	icon = get_icon_at_index (container, i);
 	if (icon) {
 		selection = nemo_icon_container_get_selection (container);
 		selection = g_list_prepend (selection,
@@ -7584,13 +8497,16 @@ nemo_icon_container_accessible_ref_selection (AtkSelection *accessible,
 {
 	AtkObject *atk_object;
 	NemoIconContainerAccessiblePrivate *priv;
+	NemoIconContainer *container;
 	NemoIcon *icon;
 
 	nemo_icon_container_accessible_update_selection (ATK_OBJECT (accessible));
 	priv = accessible_get_priv (ATK_OBJECT (accessible));
 
-	icon = g_list_nth_data (priv->selection, i);
+	icon = accessible_get_selected_icon (priv, i);
 	if (icon) {
+		container = NEMO_ICON_CONTAINER (gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible)));
+		nemo_icon_container_ensure_icon_item (container, icon);
 		atk_object = atk_gobject_accessible_for_object (G_OBJECT (icon->item));
 		if (atk_object) {
 			g_object_ref (atk_object);
@@ -7611,7 +8527,7 @@ nemo_icon_container_accessible_get_selection_count (AtkSelection *accessible)
 	nemo_icon_container_accessible_update_selection (ATK_OBJECT (accessible));
 	priv = accessible_get_priv (ATK_OBJECT (accessible));
 
-	count = g_list_length (priv->selection);
+	count = priv->selection->len;
 
 	return count;
 }
@@ -7631,7 +8547,7 @@ nemo_icon_container_accessible_is_child_selected (AtkSelection *accessible,
 
         container = NEMO_ICON_CONTAINER (widget);
 
-	icon = g_list_nth_data (container->details->icons, i);
+	icon = get_icon_at_index (container, i);
 	return icon ? icon->is_selected : FALSE;
 }
 
@@ -7655,7 +8571,7 @@ nemo_icon_container_accessible_remove_selection (AtkSelection *accessible,
 
         container = NEMO_ICON_CONTAINER (widget);
 
-	icon = g_list_nth_data (priv->selection, i);
+	icon = accessible_get_selected_icon (priv, i);
 	if (icon) {
 		selection = nemo_icon_container_get_selection (container);
 		selection = g_list_remove (selection, icon->data);
@@ -7756,14 +8672,15 @@ nemo_icon_container_accessible_ref_child (AtkObject *accessible, int i)
 
         container = NEMO_ICON_CONTAINER (widget);
 
-        icon = g_list_nth_data (container->details->icons, i);
+        icon = get_icon_at_index (container, i);
         if (icon) {
+                nemo_icon_container_ensure_icon_item (container, icon);
                 atk_object = atk_gobject_accessible_for_object (G_OBJECT (icon->item));
                 g_object_ref (atk_object);
 
                 return atk_object;
         } else {
-		if (i == (int)g_list_length (container->details->icons)) {
+		if (i == (int) get_icon_count (container)) {
 			if (container->details->rename_widget) {
 				atk_object = gtk_widget_get_accessible (container->details->rename_widget);
 				g_object_ref (atk_object);
@@ -7819,7 +8736,7 @@ nemo_icon_container_accessible_finalize (GObject *object)
 
 	priv = accessible_get_priv (ATK_OBJECT (object));
 	if (priv->selection) {
-		g_list_free (priv->selection);
+		g_ptr_array_free (priv->selection, TRUE);
 	}
 
 	for (i = 0; i < LAST_ACTION; i++) {
@@ -7998,7 +8915,7 @@ nemo_icon_container_get_mirror_x_position (NemoIconContainer *container, NemoIco
     GtkAllocation allocation;
 
     gtk_widget_get_allocation (GTK_WIDGET (container), &allocation);
-    icon_bounds = nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+    icon_bounds = nemo_icon_container_icon_get_rectangle (container, icon);
 
     return nemo_icon_container_get_canvas_width (container, allocation) - x - (icon_bounds.x1 - icon_bounds.x0);
 }
@@ -8026,17 +8943,41 @@ nemo_icon_container_sort_icons (NemoIconContainer *container,
         GList                **icons)
 {
     NemoIconContainerClass *klass;
+    NemoIcon **array;
+    GList *l;
+    guint n_icons, i;
 
     klass = NEMO_ICON_CONTAINER_GET_CLASS (container);
     g_assert (klass->compare_icons != NULL);
 
-    *icons = g_list_sort_with_data (*icons, compare_icons, container);
+    if (klass->sort_icons == NULL) {
+        *icons = g_list_sort_with_data (*icons, compare_icons, container);
+        return;
+    }
+
+    n_icons = g_list_length (*icons);
+    array = g_new (NemoIcon *, n_icons);
+
+    for (l = *icons, i = 0; l != NULL; l = l->next, i++) {
+        array[i] = l->data;
+    }
+
+    klass->sort_icons (container, array, n_icons);
+
+    /* Reuse the list links in the new order */
+    for (l = *icons, i = 0; l != NULL; l = l->next, i++) {
+        l->data = array[i];
+    }
+
+    g_free (array);
 }
 
 void
 nemo_icon_container_resort (NemoIconContainer *container)
 {
     nemo_icon_container_sort_icons (container, &container->details->icons);
+    nemo_icon_container_invalidate_icon_array (container);
+    container->details->grid.valid = FALSE;
 }
 
 void
@@ -8044,6 +8985,10 @@ nemo_icon_container_icon_raise (NemoIconContainer *container, NemoIcon *icon)
 {
     EelCanvasItem *item, *band;
 
+    if (icon->item == NULL) {
+        return;
+    }
+
     item = EEL_CANVAS_ITEM (icon->item);
     band = container->details->rubberband_info.selection_rectangle;
 
@@ -8054,10 +8999,9 @@ void
 nemo_icon_container_finish_adding_icon (NemoIconContainer *container,
             NemoIcon *icon)
 {
-    eel_canvas_item_show (EEL_CANVAS_ITEM (icon->item));
-
-    g_signal_connect_object (icon->item, "event",
-                 G_CALLBACK (item_event_callback), container, 0);
+    if (icon->item != NULL) {
+        eel_canvas_item_show (EEL_CANVAS_ITEM (icon->item));
+    }
 
     g_signal_emit (container, signals[ICON_ADDED], 0, icon->data);
 }
@@ -8087,6 +9031,8 @@ nemo_icon_container_move_icon (NemoIconContainer *container,
                    gboolean snap,
                    gboolean update_position)
 {
+    spatial_index_icon_changed (container, icon);
+
     NEMO_ICON_CONTAINER_GET_CLASS (container)->move_icon (container,
                                                           icon,
                                                           x, y,
@@ -8102,6 +9048,8 @@ nemo_icon_container_icon_set_position (NemoIconContainer *container,
                                        gdouble            x,
                                        gdouble            y)
 {
+    spatial_index_icon_changed (container, icon);
+
     NEMO_ICON_CONTAINER_GET_CLASS (container)->icon_set_position (container, icon, x, y);
 }
 
@@ -8112,6 +9060,27 @@ nemo_icon_container_icon_get_bounding_box (NemoIconContainer *container,
                                            int *x2_return, int *y2_return,
                                            NemoIconCanvasItemBoundsUsage usage)
 {
+    EelDRect bounds;
+
+    if (icon->item == NULL) {
+        bounds = icon_get_stand_in_rectangle (container, icon, TRUE);
+
+        if (x1_return != NULL) {
+            *x1_return = bounds.x0;
+        }
+        if (y1_return != NULL) {
+            *y1_return = bounds.y0;
+        }
+        if (x2_return != NULL) {
+            *x2_return = bounds.x1;
+        }
+        if (y2_return != NULL) {
+            *y2_return = bounds.y1;
+        }
+
+        return;
+    }
+
     NEMO_ICON_CONTAINER_GET_CLASS (container)->icon_get_bounding_box (icon, x1_return, y1_return, x2_return, y2_return, usage);
 }
 
@@ -8128,6 +9097,15 @@ nemo_icon_container_update_icon (NemoIconContainer *container,
              (nemo_file_get_load_deferred_attrs (file) == NEMO_FILE_LOAD_DEFERRED_ATTRS_PRELOAD);
     }
 
+    if (icon != NULL) {
+        /* Brought up to date once it gets an item */
+        if (icon->item == NULL) {
+            return;
+        }
+
+        spatial_index_icon_changed (container, icon);
+    }
+
     NEMO_ICON_CONTAINER_GET_CLASS (container)->update_icon (container, icon, ok);
 }
 
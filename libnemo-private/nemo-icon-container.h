@@ -159,6 +159,10 @@ typedef struct {
 	int          (* compare_icons)            (NemoIconContainer *container,
 						   NemoIconData *icon_a,
 						   NemoIconData *icon_b);
+	/* Optional, sorts an array of NemoIcons in the compare_icons order */
+	void         (* sort_icons)               (NemoIconContainer *container,
+						   NemoIcon         **icons,
+						   guint              n_icons);
 	void         (* freeze_updates)           (NemoIconContainer *container);
 	void         (* unfreeze_updates)         (NemoIconContainer *container);
 
@@ -266,6 +270,8 @@ gboolean          nemo_icon_container_is_empty                      (NemoIconCon
 NemoIconData *nemo_icon_container_get_first_visible_icon        (NemoIconContainer  *container);
 void              nemo_icon_container_scroll_to_icon                (NemoIconContainer  *container,
 									 NemoIconData       *data);
+gboolean          nemo_icon_container_is_icon_visible               (NemoIconContainer  *container,
+									 NemoIconData       *data);
 
 void              nemo_icon_container_begin_loading                 (NemoIconContainer  *container);
 void              nemo_icon_container_end_loading                   (NemoIconContainer  *container,
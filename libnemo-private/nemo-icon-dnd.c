@@ -292,7 +292,7 @@ icon_get_data_binder (NemoIcon *icon, gpointer data)
 
 	container = NEMO_ICON_CONTAINER (context->iterator_context);
 
-	world_rect = nemo_icon_canvas_item_get_icon_rectangle (icon->item);
+	world_rect = nemo_icon_container_icon_get_rectangle (container, icon);
 
 	canvas_rect_world_to_widget (EEL_CANVAS (container), &world_rect, &widget_rect);
 
@@ -596,8 +596,10 @@ static NemoIcon *
 nemo_icon_container_item_at (NemoIconContainer *container,
                                 int x, int y)
 {
-	GList *p;
+	GPtrArray *icons;
+	NemoIcon *icon, *hit;
 	int size;
+	guint i;
 	EelDRect point;
 	EelIRect canvas_point;
 
@@ -611,26 +613,33 @@ nemo_icon_container_item_at (NemoIconContainer *container,
 	point.x1 = x + size;
 	point.y1 = y + size;
 
-	for (p = container->details->icons; p != NULL; p = p->next) {
-		NemoIcon *icon;
-		icon = p->data;
-
-		eel_canvas_w2c (EEL_CANVAS (container),
-				point.x0,
-				point.y0,
-				&canvas_point.x0,
-				&canvas_point.y0);
-		eel_canvas_w2c (EEL_CANVAS (container),
-				point.x1,
-				point.y1,
-				&canvas_point.x1,
-				&canvas_point.y1);
-		if (nemo_icon_canvas_item_hit_test_rectangle (icon->item, canvas_point)) {
-			return icon;
+	eel_canvas_w2c (EEL_CANVAS (container),
+			point.x0,
+			point.y0,
+			&canvas_point.x0,
+			&canvas_point.y0);
+	eel_canvas_w2c (EEL_CANVAS (container),
+			point.x1,
+			point.y1,
+			&canvas_point.x1,
+			&canvas_point.y1);
+
+	hit = NULL;
+	icons = nemo_icon_container_get_icons_in_area (container, &point);
+
+	for (i = 0; i < icons->len; i++) {
+		icon = g_ptr_array_index (icons, i);
+
+		if (icon->item != NULL &&
+		    nemo_icon_canvas_item_hit_test_rectangle (icon->item, canvas_point)) {
+			hit = icon;
+			break;
 		}
 	}
 
-	return NULL;
+	g_ptr_array_unref (icons);
+
+	return hit;
 }
 
 static char *
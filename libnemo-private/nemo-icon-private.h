@@ -122,12 +122,43 @@ typedef struct {
     gboolean tight;
 } NemoPlacementGrid;
 
+typedef struct {
+    gboolean valid;
+    guint n_icons;
+    guint n_columns;
+    double start_y;
+    double cell_width;
+    double row_height;
+    /* Icons without a canvas item are taken to be an icon_size
+     * square, with a label_height label below it. */
+    double icon_size;
+    double label_height;
+} NemoIconGrid;
+
+typedef struct {
+    gboolean valid;
+    double x0, y0;
+    double cell_size;
+    int n_columns;
+    int n_rows;
+    GPtrArray **cells; /* n_columns * n_rows, NULL where empty */
+    GHashTable *dirty; /* icons to file again before the next lookup */
+} NemoIconSpatialIndex;
+
 struct NemoIconContainerDetails {
 	/* List of icons. */
 	GList *icons;
 	GList *new_icons;
 	GHashTable *icon_set;
 
+	/* The icons in list order, for lookups by position. Rebuilt
+	 * on demand after the list changes. */
+	GPtrArray *icon_array;
+	gboolean icon_array_valid;
+
+	/* Number of icons with is_selected set. */
+	guint n_selected;
+
 	/* Current icon for keyboard navigation. */
 	NemoIcon *keyboard_focus;
 	NemoIcon *keyboard_rubberband_start;
@@ -309,6 +340,25 @@ struct NemoIconContainerDetails {
     GList *current_selection;
     gint current_selection_count;
     gint fixed_text_height;
+
+    /* Icons whose sort position may have changed, repositioned at the
+     * next layout unless the whole list gets resorted anyway. */
+    GHashTable *resort_icons;
+
+    /* Uniform cells of the last auto-layout, if it was a plain grid.
+     * Lets visibility and the scroll region be worked out from an
+     * icon's index instead of measuring every item. */
+    NemoIconGrid grid;
+
+    /* Whether icons only get a canvas item near the visible area, and
+     * the items given up by icons that scrolled away. */
+    gboolean lazy_items;
+    GQueue *spare_items;
+
+    /* Buckets icons by their bounds, so rubberbanding and hit-testing
+     * only look at icons near the area in question. Rebuilt on demand
+     * after icons move, change or go away. */
+    NemoIconSpatialIndex spatial_index;
 };
 
 typedef struct {
@@ -357,6 +407,10 @@ void              nemo_icon_container_icon_set_position (NemoIconContainer *cont
                                                          NemoIcon          *icon,
                                                          gdouble            x,
                                                          gdouble            y);
+void              nemo_icon_container_ensure_icon_item (NemoIconContainer *container,
+                                                        NemoIcon          *icon);
+EelDRect          nemo_icon_container_icon_get_rectangle (NemoIconContainer *container,
+                                                          NemoIcon          *icon);
 void              nemo_icon_container_icon_get_bounding_box (NemoIconContainer *container, NemoIcon *icon,
                                                              int *x1_return, int *y1_return,
                                                              int *x2_return, int *y2_return,
@@ -378,6 +432,9 @@ gboolean      nemo_icon_container_icon_is_positioned (const NemoIcon *icon);
 void          nemo_icon_container_sort_icons (NemoIconContainer *container,
                                               GList            **icons);
 void          nemo_icon_container_resort (NemoIconContainer *container);
+void          nemo_icon_container_invalidate_icon_array (NemoIconContainer *container);
+GPtrArray    *nemo_icon_container_get_icons_in_area (NemoIconContainer *container,
+                                                     const EelDRect    *area);
 void          nemo_icon_container_get_all_icon_bounds (NemoIconContainer *container,
                                                        double *x1, double *y1,
                                                        double *x2, double *y2,
@@ -43,7 +43,9 @@ typedef struct {
 	/* Object represented by this icon. */
 	NemoIconData *data;
 
-	/* Canvas item for the icon. */
+	/* Canvas item for the icon. NULL while the icon is away from the
+	 * visible area of a grid layout, see
+	 * nemo_icon_container_ensure_icon_item (). */
 	NemoIconCanvasItem *item;
 
 	/* X/Y coordinates. */
@@ -60,18 +62,32 @@ typedef struct {
 	/* Scale factor (stretches icon). */
 	double scale;
 
+	/* Position in the container's icon list, valid while its
+	 * icon array is. */
+	guint index;
+
+	/* Cells it was filed under in the container's spatial index,
+	 * valid while in_spatial_index is set and the index is. */
+	int spatial_column0, spatial_row0;
+	int spatial_column1, spatial_row1;
+
 	/* Whether this item is selected. */
 	eel_boolean_bit is_selected : 1;
 
 	/* Whether this item was selected before rubberbanding. */
 	eel_boolean_bit was_selected_before_rubberband : 1;
 
+	/* Whether this item is shown as cut to the clipboard. */
+	eel_boolean_bit is_highlighted_for_clipboard : 1;
+
 	/* Whether this item is visible in the view. */
 	eel_boolean_bit is_visible : 1;
 
 	eel_boolean_bit has_lazy_position : 1;
 
     eel_boolean_bit ok_to_show_thumb : 1;
+
+	eel_boolean_bit in_spatial_index : 1;
 } NemoIcon;
 
 #endif /* NEMO_ICON_CONTAINER_PRIVATE_H */
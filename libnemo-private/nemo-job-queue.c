@@ -28,7 +28,11 @@ struct _NemoJobQueuePriv {
 	GList *queued_jobs;
     GList *running_jobs;
     gulong pref_changed_id;
+    gulong jobs_per_device_changed_id;
+    gulong device_overrides_changed_id;
     gboolean skip_queue;
+    gint jobs_per_device;
+    GVariant *device_overrides;
 };
 
 enum {
@@ -41,6 +45,7 @@ typedef struct {
     gpointer user_data;
     NemoProgressInfo *info;
     GCancellable *cancellable;
+    gchar **devices; /* filesystem ids, NULL if unknown */
 } Job;
 
 static NemoJobQueue *singleton = NULL;
@@ -64,6 +69,18 @@ nemo_job_queue_finalize (GObject *obj)
         self->priv->pref_changed_id = 0;
     }
 
+    if (self->priv->jobs_per_device_changed_id != 0) {
+        g_signal_handler_disconnect (nemo_preferences, self->priv->jobs_per_device_changed_id);
+        self->priv->jobs_per_device_changed_id = 0;
+    }
+
+    if (self->priv->device_overrides_changed_id != 0) {
+        g_signal_handler_disconnect (nemo_preferences, self->priv->device_overrides_changed_id);
+        self->priv->device_overrides_changed_id = 0;
+    }
+
+    g_clear_pointer (&self->priv->device_overrides, g_variant_unref);
+
 	G_OBJECT_CLASS (nemo_job_queue_parent_class)->finalize (obj);
 }
 
@@ -94,6 +111,19 @@ pref_changed_cb (NemoJobQueue *self)
                                                      NEMO_PREFERENCES_NEVER_QUEUE_FILE_OPS);
 }
 
+static void
+device_pref_changed_cb (NemoJobQueue *self)
+{
+    self->priv->jobs_per_device = g_settings_get_int (nemo_preferences,
+                                                      NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE);
+
+    g_clear_pointer (&self->priv->device_overrides, g_variant_unref);
+    self->priv->device_overrides = g_settings_get_value (nemo_preferences,
+                                                         NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE_OVERRIDES);
+
+    nemo_job_queue_start_next_job (self);
+}
+
 static void
 nemo_job_queue_init (NemoJobQueue *self)
 {
@@ -108,6 +138,15 @@ nemo_job_queue_init (NemoJobQueue *self)
                                                     G_CALLBACK (pref_changed_cb), self);
 
     pref_changed_cb (self);
+
+    self->priv->jobs_per_device_changed_id = g_signal_connect_swapped (nemo_preferences,
+                                                    "changed::" NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE,
+                                                    G_CALLBACK (device_pref_changed_cb), self);
+    self->priv->device_overrides_changed_id = g_signal_connect_swapped (nemo_preferences,
+                                                    "changed::" NEMO_PREFERENCES_FILE_OPS_JOBS_PER_DEVICE_OVERRIDES,
+                                                    G_CALLBACK (device_pref_changed_cb), self);
+
+    device_pref_changed_cb (self);
 }
 
 static void
@@ -163,6 +202,7 @@ job_finished_cb (NemoJobQueue *self,
     self->priv->running_jobs = g_list_remove (self->priv->running_jobs, job);
     self->priv->queued_jobs = g_list_remove (self->priv->queued_jobs, job);
 
+    g_strfreev (job->devices);
     g_free (job);
 
     nemo_job_queue_start_next_job (self);
@@ -182,6 +222,7 @@ nemo_job_queue_add_new_job (NemoJobQueue         *self,
                             gpointer              user_data,
                             GCancellable         *cancellable,
                             NemoProgressInfo     *info,
+                            const gchar * const  *devices,
                             gboolean              start_immediately)
 {
 	if (g_list_find_custom (self->priv->queued_jobs, user_data, (GCompareFunc) compare_job_data_func) != NULL) {
@@ -194,6 +235,7 @@ nemo_job_queue_add_new_job (NemoJobQueue         *self,
     new_job->user_data = user_data;
     new_job->cancellable = cancellable;
     new_job->info = info;
+    new_job->devices = g_strdupv ((gchar **) devices);
 
 	self->priv->queued_jobs =
 		g_list_append (self->priv->queued_jobs, new_job);
@@ -225,11 +267,107 @@ start_job (NemoJobQueue *self, Job *job)
     self->priv->running_jobs = g_list_append (self->priv->running_jobs, job);
 }
 
+static gint
+get_device_limit (NemoJobQueue *self,
+                  const gchar  *device)
+{
+    gint limit;
+
+    if (self->priv->device_overrides != NULL &&
+        g_variant_lookup (self->priv->device_overrides, device, "i", &limit)) {
+        return MAX (limit, 1);
+    }
+
+    return MAX (self->priv->jobs_per_device, 1);
+}
+
+static guint
+count_jobs_on_device (GList       *jobs,
+                      const gchar *device)
+{
+    GList *l;
+    guint count;
+
+    count = 0;
+
+    for (l = jobs; l != NULL; l = l->next) {
+        Job *job = l->data;
+
+        if (job->devices != NULL && g_strv_contains ((const gchar * const *) job->devices, device)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static gboolean
+any_job_on_unknown_device (GList *jobs)
+{
+    GList *l;
+
+    for (l = jobs; l != NULL; l = l->next) {
+        if (((Job *) l->data)->devices == NULL) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/* Jobs on different devices run side by side, jobs sharing a device
+ * wait until it has a free slot. A job we don't know the devices of
+ * only runs alone, like every job used to. Queued jobs that can't
+ * start yet keep their devices for themselves, so later jobs don't
+ * overtake them there.
+ */
+static gboolean
+can_start_job (NemoJobQueue *self,
+               Job          *job,
+               GList        *waiting_jobs)
+{
+    gint i;
+
+    if (self->priv->running_jobs == NULL) {
+        return TRUE;
+    }
+
+    if (job->devices == NULL ||
+        any_job_on_unknown_device (self->priv->running_jobs) ||
+        any_job_on_unknown_device (waiting_jobs)) {
+        return FALSE;
+    }
+
+    for (i = 0; job->devices[i] != NULL; i++) {
+        if (count_jobs_on_device (waiting_jobs, job->devices[i]) > 0 ||
+            count_jobs_on_device (self->priv->running_jobs, job->devices[i]) >= (guint) get_device_limit (self, job->devices[i])) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 void
 nemo_job_queue_start_next_job (NemoJobQueue *self)
 {
-    if (g_list_length (self->priv->running_jobs) == 0 && g_list_length (self->priv->queued_jobs) > 0)
-        start_job (self, self->priv->queued_jobs->data);
+    GList *l, *next, *waiting_jobs;
+
+    waiting_jobs = NULL;
+
+    for (l = self->priv->queued_jobs; l != NULL; l = next) {
+        Job *job = l->data;
+
+        next = l->next;
+
+        if (can_start_job (self, job, waiting_jobs)) {
+            start_job (self, job);
+        } else {
+            waiting_jobs = g_list_prepend (waiting_jobs, job);
+        }
+    }
+
+    g_list_free (waiting_jobs);
 }
 
 void
@@ -277,7 +277,7 @@ nemo_progress_info_cancel (NemoProgressInfo *info)
 	g_cancellable_cancel (info->cancellable);
 
     info->paused = FALSE;
-    g_cond_signal (info->cond);
+    g_cond_broadcast (info->cond);
 
 	g_mutex_unlock (&info->info_lock);
 }
@@ -486,7 +486,7 @@ nemo_progress_info_resume (NemoProgressInfo *info)
         }
 	}
 
-    g_cond_signal (info->cond);
+    g_cond_broadcast (info->cond);
 
 	g_mutex_unlock (&info->info_lock);
 }
@@ -634,9 +634,21 @@ nemo_progress_info_pulse_progress (NemoProgressInfo *info)
 }
 
 void
-nemo_progress_info_set_progress (NemoProgressInfo *info,
-				     double                current,
-				     double                total)
+nemo_progress_info_wait_while_paused (NemoProgressInfo *info)
+{
+	g_mutex_lock (&info->info_lock);
+
+    while (info->paused) {
+        g_cond_wait (info->cond, &info->info_lock);
+    }
+
+	g_mutex_unlock (&info->info_lock);
+}
+
+void
+nemo_progress_info_update_progress (NemoProgressInfo *info,
+				    double                current,
+				    double                total)
 {
 	double current_percent;
 	
@@ -665,12 +677,16 @@ nemo_progress_info_set_progress (NemoProgressInfo *info,
 		queue_idle (info, FALSE);
 	}
 
-    while (info->paused) {
-        g_cond_wait (info->cond, &info->info_lock);
-    }
-
 	g_mutex_unlock (&info->info_lock);
+}
 
+void
+nemo_progress_info_set_progress (NemoProgressInfo *info,
+				     double                current,
+				     double                total)
+{
+	nemo_progress_info_update_progress (info, current, total);
+	nemo_progress_info_wait_while_paused (info);
 }
 
 gdouble
@@ -82,7 +82,13 @@ void          nemo_progress_info_take_details    (NemoProgressInfo *info,
 void          nemo_progress_info_set_progress    (NemoProgressInfo *info,
 						      double                current,
 						      double                total);
+/* Like nemo_progress_info_set_progress (), but doesn't block while the
+   job is paused, so it can be used from the main loop. */
+void          nemo_progress_info_update_progress (NemoProgressInfo *info,
+						      double                current,
+						      double                total);
 void          nemo_progress_info_pulse_progress  (NemoProgressInfo *info);
+void          nemo_progress_info_wait_while_paused (NemoProgressInfo *info);
 
 gdouble       nemo_progress_info_get_elapsed_time (NemoProgressInfo *info);
 
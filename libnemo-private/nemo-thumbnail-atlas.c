@@ -0,0 +1,610 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   nemo-thumbnail-atlas.c: Packed per-directory thumbnail cache.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street - Suite 500,
+   Boston, MA 02110-1335, USA.
+*/
+
+#include <config.h>
+#include "nemo-thumbnail-atlas.h"
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEBUG_FLAG NEMO_DEBUG_THUMBNAILS
+#include <libnemo-private/nemo-debug.h>
+
+/* File layout, host byte order (it never leaves the machine):
+ *
+ *   AtlasHeader
+ *   AtlasEntry[n_tiles]
+ *   names, NUL terminated
+ *   pixel data of every tile, each starting on a TILE_ALIGNMENT boundary
+ *
+ * Tiles are stored with GdkPixbuf's own layout (8 bit RGB or RGBA,
+ * unpremultiplied), which is what NemoFile keeps as its thumbnail, so
+ * a lookup only has to wrap the mapping in a pixbuf.
+ */
+
+#define ATLAS_MAGIC 0x3141544e /* "NTA1" */
+#define ATLAS_VERSION 1
+#define TILE_ALIGNMENT 16
+
+/* Don't let a single folder's atlas grow beyond this */
+#define ATLAS_MAX_BYTES (128 * 1024 * 1024)
+
+/* Atlases not opened for this long are removed, and the oldest ones go
+ * once all of them together get bigger than ATLAS_CACHE_MAX_BYTES.
+ * Checked at most every ATLAS_PRUNE_INTERVAL when an atlas is saved.
+ */
+#define ATLAS_MAX_AGE (30 * 24 * 60 * 60)
+#define ATLAS_CACHE_MAX_BYTES (G_GINT64_CONSTANT (512) * 1024 * 1024)
+#define ATLAS_PRUNE_INTERVAL (60 * 60)
+
+typedef struct {
+	guint32 magic;
+	guint32 version;
+	guint32 max_size;
+	guint32 n_tiles;
+	guint64 names_offset;
+	guint64 names_size;
+} AtlasHeader;
+
+typedef struct {
+	guint64 pixels_offset;
+	gint64 mtime;
+	gint64 thumb_mtime;
+	guint32 name_offset;
+	guint32 name_length;
+	guint32 width;
+	guint32 height;
+	guint32 rowstride;
+	guint32 has_alpha;
+} AtlasEntry;
+
+struct NemoThumbnailAtlas {
+	GMappedFile *mapped_file;
+	GHashTable *entries; /* name in the mapping -> AtlasEntry in the mapping */
+};
+
+typedef struct {
+	char *path;
+	int max_size;
+	GList *tiles;
+} SaveData;
+
+static char *
+get_atlas_dir (void)
+{
+	return g_build_filename (g_get_user_cache_dir (),
+				 "icarus-fm", "thumbnail-atlas", NULL);
+}
+
+static char *
+get_atlas_path (GFile *directory_location,
+		int    max_size)
+{
+	char *uri, *digest, *filename, *dir, *path;
+
+	uri = g_file_get_uri (directory_location);
+	digest = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+	filename = g_strdup_printf ("%s-%d.atlas", digest, max_size);
+
+	dir = get_atlas_dir ();
+	path = g_build_filename (dir, filename, NULL);
+	g_free (dir);
+
+	g_free (filename);
+	g_free (digest);
+	g_free (uri);
+
+	return path;
+}
+
+static gsize
+tile_rowstride (GdkPixbuf *pixbuf)
+{
+	gsize row;
+
+	row = (gsize) gdk_pixbuf_get_width (pixbuf) * gdk_pixbuf_get_n_channels (pixbuf);
+
+	return (row + 3) & ~((gsize) 3);
+}
+
+NemoThumbnailAtlasTile *
+nemo_thumbnail_atlas_tile_new (const char *name,
+			       time_t      mtime,
+			       time_t      thumb_mtime,
+			       GdkPixbuf  *pixbuf)
+{
+	NemoThumbnailAtlasTile *tile;
+
+	tile = g_new0 (NemoThumbnailAtlasTile, 1);
+	tile->name = g_strdup (name);
+	tile->mtime = mtime;
+	tile->thumb_mtime = thumb_mtime;
+	tile->pixbuf = g_object_ref (pixbuf);
+
+	return tile;
+}
+
+void
+nemo_thumbnail_atlas_tile_free (NemoThumbnailAtlasTile *tile)
+{
+	g_free (tile->name);
+	g_object_unref (tile->pixbuf);
+	g_free (tile);
+}
+
+NemoThumbnailAtlas *
+nemo_thumbnail_atlas_open (GFile *directory_location,
+			   int    max_size)
+{
+	NemoThumbnailAtlas *atlas;
+	GMappedFile *mapped_file;
+	const AtlasHeader *header;
+	const AtlasEntry *entries;
+	const char *contents, *names;
+	gsize length;
+	guint32 i;
+	char *path;
+
+	path = get_atlas_path (directory_location, max_size);
+	/* Private mapping: a pixbuf user scribbling on a tile never reaches the file */
+	mapped_file = g_mapped_file_new (path, TRUE, NULL);
+
+	if (mapped_file == NULL) {
+		g_free (path);
+		return NULL;
+	}
+
+	/* The expiry goes by mtime, mark the atlas as used */
+	g_utime (path, NULL);
+	g_free (path);
+
+	contents = g_mapped_file_get_contents (mapped_file);
+	length = g_mapped_file_get_length (mapped_file);
+	header = (const AtlasHeader *) contents;
+
+	if (length < sizeof (AtlasHeader) ||
+	    header->magic != ATLAS_MAGIC ||
+	    header->version != ATLAS_VERSION ||
+	    header->max_size != (guint32) max_size ||
+	    sizeof (AtlasHeader) + (guint64) header->n_tiles * sizeof (AtlasEntry) > header->names_offset ||
+	    header->names_offset + header->names_size > length) {
+		DEBUG ("Ignoring invalid thumbnail atlas");
+		g_mapped_file_unref (mapped_file);
+		return NULL;
+	}
+
+	atlas = g_new0 (NemoThumbnailAtlas, 1);
+	atlas->mapped_file = mapped_file;
+	atlas->entries = g_hash_table_new (g_str_hash, g_str_equal);
+
+	entries = (const AtlasEntry *) (contents + sizeof (AtlasHeader));
+	names = contents + header->names_offset;
+
+	for (i = 0; i < header->n_tiles; i++) {
+		const AtlasEntry *entry = &entries[i];
+
+		if ((guint64) entry->name_offset + entry->name_length >= header->names_size ||
+		    names[entry->name_offset + entry->name_length] != '\0' ||
+		    entry->rowstride < entry->width * (entry->has_alpha ? 4 : 3) ||
+		    entry->pixels_offset + (guint64) entry->rowstride * entry->height > length) {
+			continue;
+		}
+
+		g_hash_table_insert (atlas->entries,
+				     (gpointer) (names + entry->name_offset),
+				     (gpointer) entry);
+	}
+
+	DEBUG ("Opened thumbnail atlas with %u tiles", g_hash_table_size (atlas->entries));
+
+	return atlas;
+}
+
+void
+nemo_thumbnail_atlas_free (NemoThumbnailAtlas *atlas)
+{
+	/* Pixbufs handed out keep their own ref on the mapping */
+	g_hash_table_destroy (atlas->entries);
+	g_mapped_file_unref (atlas->mapped_file);
+	g_free (atlas);
+}
+
+static void
+unref_mapped_file (guchar   *pixels,
+		   gpointer  data)
+{
+	g_mapped_file_unref (data);
+}
+
+static GdkPixbuf *
+pixbuf_for_entry (NemoThumbnailAtlas *atlas,
+		  const AtlasEntry   *entry)
+{
+	const char *contents;
+	GdkPixbuf *pixbuf;
+	char *thumb_mtime;
+
+	contents = g_mapped_file_get_contents (atlas->mapped_file);
+
+	pixbuf = gdk_pixbuf_new_from_data ((const guchar *) contents + entry->pixels_offset,
+					   GDK_COLORSPACE_RGB,
+					   entry->has_alpha,
+					   8,
+					   entry->width,
+					   entry->height,
+					   entry->rowstride,
+					   unref_mapped_file,
+					   g_mapped_file_ref (atlas->mapped_file));
+
+	/* Checked by thumbnail_done(), as for thumbnails read from the cache */
+	thumb_mtime = g_strdup_printf ("%" G_GINT64_FORMAT, entry->thumb_mtime);
+	gdk_pixbuf_set_option (pixbuf, "tEXt::Thumb::MTime", thumb_mtime);
+	g_free (thumb_mtime);
+
+	return pixbuf;
+}
+
+GdkPixbuf *
+nemo_thumbnail_atlas_lookup (NemoThumbnailAtlas *atlas,
+			     const char         *name,
+			     time_t              mtime)
+{
+	const AtlasEntry *entry;
+
+	entry = g_hash_table_lookup (atlas->entries, name);
+
+	if (entry == NULL || entry->mtime != (gint64) mtime) {
+		return NULL;
+	}
+
+	return pixbuf_for_entry (atlas, entry);
+}
+
+static gboolean
+write_padding (FILE    *out,
+	       guint64  from,
+	       guint64  to)
+{
+	static const char zeros[TILE_ALIGNMENT] = { 0 };
+
+	return to == from || fwrite (zeros, 1, to - from, out) == to - from;
+}
+
+static gboolean
+write_atlas (FILE     *out,
+	     int       max_size,
+	     GList    *tiles)
+{
+	AtlasHeader header = { 0 };
+	AtlasEntry *entries;
+	NemoThumbnailAtlasTile *tile;
+	guint64 offset, name_offset;
+	guint i, n_tiles;
+	GList *l;
+	gboolean ok;
+
+	n_tiles = g_list_length (tiles);
+	entries = g_new0 (AtlasEntry, n_tiles);
+
+	name_offset = 0;
+	for (l = tiles, i = 0; l != NULL; l = l->next, i++) {
+		tile = l->data;
+
+		entries[i].name_offset = name_offset;
+		entries[i].name_length = strlen (tile->name);
+		entries[i].mtime = tile->mtime;
+		entries[i].thumb_mtime = tile->thumb_mtime;
+		entries[i].width = gdk_pixbuf_get_width (tile->pixbuf);
+		entries[i].height = gdk_pixbuf_get_height (tile->pixbuf);
+		entries[i].rowstride = tile_rowstride (tile->pixbuf);
+		entries[i].has_alpha = gdk_pixbuf_get_has_alpha (tile->pixbuf);
+
+		name_offset += entries[i].name_length + 1;
+	}
+
+	header.magic = ATLAS_MAGIC;
+	header.version = ATLAS_VERSION;
+	header.max_size = max_size;
+	header.n_tiles = n_tiles;
+	header.names_offset = sizeof (AtlasHeader) + (guint64) n_tiles * sizeof (AtlasEntry);
+	header.names_size = name_offset;
+
+	offset = header.names_offset + header.names_size;
+	for (i = 0; i < n_tiles; i++) {
+		offset = (offset + TILE_ALIGNMENT - 1) & ~((guint64) TILE_ALIGNMENT - 1);
+		entries[i].pixels_offset = offset;
+		offset += (guint64) entries[i].rowstride * entries[i].height;
+	}
+
+	ok = fwrite (&header, sizeof (AtlasHeader), 1, out) == 1 &&
+	     (n_tiles == 0 || fwrite (entries, sizeof (AtlasEntry), n_tiles, out) == n_tiles);
+
+	for (l = tiles; ok && l != NULL; l = l->next) {
+		tile = l->data;
+		ok = fwrite (tile->name, 1, strlen (tile->name) + 1, out) == strlen (tile->name) + 1;
+	}
+
+	offset = header.names_offset + header.names_size;
+	for (l = tiles, i = 0; ok && l != NULL; l = l->next, i++) {
+		const guchar *pixels;
+		gsize row_bytes;
+		int y, rowstride;
+
+		tile = l->data;
+
+		ok = write_padding (out, offset, entries[i].pixels_offset);
+		offset = entries[i].pixels_offset;
+
+		pixels = gdk_pixbuf_read_pixels (tile->pixbuf);
+		rowstride = gdk_pixbuf_get_rowstride (tile->pixbuf);
+		row_bytes = (gsize) entries[i].width * gdk_pixbuf_get_n_channels (tile->pixbuf);
+
+		for (y = 0; ok && y < (int) entries[i].height; y++) {
+			ok = fwrite (pixels + (gsize) y * rowstride, 1, row_bytes, out) == row_bytes &&
+			     write_padding (out, row_bytes, entries[i].rowstride);
+		}
+
+		offset += (guint64) entries[i].rowstride * entries[i].height;
+	}
+
+	g_free (entries);
+
+	return ok;
+}
+
+typedef struct {
+	char *path;
+	gint64 mtime;
+	gint64 size;
+} CachedAtlas;
+
+static gint
+compare_cached_atlas_by_age (gconstpointer a,
+			     gconstpointer b)
+{
+	const CachedAtlas *atlas_a = a;
+	const CachedAtlas *atlas_b = b;
+
+	/* Newest first */
+	return (atlas_a->mtime < atlas_b->mtime) - (atlas_a->mtime > atlas_b->mtime);
+}
+
+static void
+cached_atlas_free (CachedAtlas *atlas)
+{
+	g_free (atlas->path);
+	g_free (atlas);
+}
+
+static void
+prune_cache (void)
+{
+	static gint64 last_prune = 0;
+	G_LOCK_DEFINE_STATIC (last_prune);
+	CachedAtlas *atlas;
+	GStatBuf statbuf;
+	GList *atlases, *l;
+	const char *name;
+	char *dir_path;
+	gint64 now, total;
+	GDir *dir;
+
+	now = g_get_real_time () / G_USEC_PER_SEC;
+
+	G_LOCK (last_prune);
+	if (last_prune != 0 && now - last_prune < ATLAS_PRUNE_INTERVAL) {
+		G_UNLOCK (last_prune);
+		return;
+	}
+	last_prune = now;
+	G_UNLOCK (last_prune);
+
+	dir_path = get_atlas_dir ();
+	dir = g_dir_open (dir_path, 0, NULL);
+	if (dir == NULL) {
+		g_free (dir_path);
+		return;
+	}
+
+	atlases = NULL;
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		atlas = g_new0 (CachedAtlas, 1);
+		atlas->path = g_build_filename (dir_path, name, NULL);
+
+		if (g_stat (atlas->path, &statbuf) != 0 || !S_ISREG (statbuf.st_mode)) {
+			cached_atlas_free (atlas);
+			continue;
+		}
+
+		atlas->mtime = statbuf.st_mtime;
+		atlas->size = statbuf.st_size;
+		atlases = g_list_prepend (atlases, atlas);
+	}
+	g_dir_close (dir);
+	g_free (dir_path);
+
+	atlases = g_list_sort (atlases, compare_cached_atlas_by_age);
+
+	total = 0;
+	for (l = atlases; l != NULL; l = l->next) {
+		atlas = l->data;
+		total += atlas->size;
+
+		/* Also catches temporary files left by a crashed save */
+		if (now - atlas->mtime > ATLAS_MAX_AGE || total > ATLAS_CACHE_MAX_BYTES) {
+			DEBUG ("Removing thumbnail atlas %s", atlas->path);
+			g_unlink (atlas->path);
+		}
+	}
+
+	g_list_free_full (atlases, (GDestroyNotify) cached_atlas_free);
+}
+
+static void
+save_data_free (SaveData *data)
+{
+	g_free (data->path);
+	g_list_free_full (data->tiles, (GDestroyNotify) nemo_thumbnail_atlas_tile_free);
+	g_free (data);
+}
+
+static void
+save_thread (GTask        *task,
+	     gpointer      source_object,
+	     gpointer      task_data,
+	     GCancellable *cancellable)
+{
+	SaveData *data = task_data;
+	char *dirname, *tmp_path;
+	FILE *out;
+	int fd;
+	gboolean ok;
+
+	if (data->tiles == NULL) {
+		g_unlink (data->path);
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+
+	dirname = g_path_get_dirname (data->path);
+	g_mkdir_with_parents (dirname, 0700);
+	g_free (dirname);
+
+	tmp_path = g_strconcat (data->path, ".XXXXXX", NULL);
+	fd = g_mkstemp (tmp_path);
+
+	if (fd == -1) {
+		g_free (tmp_path);
+		g_task_return_boolean (task, FALSE);
+		return;
+	}
+
+	out = fdopen (fd, "wb");
+	if (out == NULL) {
+		close (fd);
+		ok = FALSE;
+	} else {
+		ok = write_atlas (out, data->max_size, data->tiles);
+		ok = fclose (out) == 0 && ok;
+	}
+
+	if (ok) {
+		ok = g_rename (tmp_path, data->path) == 0;
+	}
+
+	if (!ok) {
+		g_unlink (tmp_path);
+	}
+
+	DEBUG ("Wrote thumbnail atlas %s with %u tiles: %s",
+	       data->path, g_list_length (data->tiles), ok ? "ok" : "failed");
+
+	g_free (tmp_path);
+
+	prune_cache ();
+
+	g_task_return_boolean (task, ok);
+}
+
+void
+nemo_thumbnail_atlas_save_async (GFile              *directory_location,
+				 int                 max_size,
+				 GList              *tiles,
+				 NemoThumbnailAtlas *previous,
+				 GHashTable         *existing_names)
+{
+	SaveData *data;
+	GTask *task;
+	GList *l, *next;
+	GHashTable *names;
+	GHashTableIter iter;
+	gpointer key, value;
+	guint64 total;
+
+	/* Tiles of files that were deleted meanwhile */
+	if (existing_names != NULL) {
+		for (l = tiles; l != NULL; l = next) {
+			NemoThumbnailAtlasTile *tile = l->data;
+
+			next = l->next;
+			if (!g_hash_table_contains (existing_names, tile->name)) {
+				nemo_thumbnail_atlas_tile_free (tile);
+				tiles = g_list_delete_link (tiles, l);
+			}
+		}
+	}
+
+	/* Carry over tiles of the previous atlas that weren't replaced. They
+	 * share its mapping, so it's fine for it to go away meanwhile. */
+	if (previous != NULL) {
+		names = g_hash_table_new (g_str_hash, g_str_equal);
+		for (l = tiles; l != NULL; l = l->next) {
+			g_hash_table_add (names, ((NemoThumbnailAtlasTile *) l->data)->name);
+		}
+
+		g_hash_table_iter_init (&iter, previous->entries);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			const AtlasEntry *entry = value;
+			GdkPixbuf *pixbuf;
+
+			if (g_hash_table_contains (names, key) ||
+			    (existing_names != NULL && !g_hash_table_contains (existing_names, key))) {
+				continue;
+			}
+
+			pixbuf = pixbuf_for_entry (previous, entry);
+			tiles = g_list_append (tiles,
+					       nemo_thumbnail_atlas_tile_new (key,
+									      entry->mtime,
+									      entry->thumb_mtime,
+									      pixbuf));
+			g_object_unref (pixbuf);
+		}
+
+		g_hash_table_destroy (names);
+	}
+
+	/* Keep the atlas bounded, dropping whatever doesn't fit */
+	total = 0;
+	for (l = tiles; l != NULL; l = next) {
+		NemoThumbnailAtlasTile *tile = l->data;
+
+		next = l->next;
+		total += tile_rowstride (tile->pixbuf) * gdk_pixbuf_get_height (tile->pixbuf) + TILE_ALIGNMENT;
+
+		if (total > ATLAS_MAX_BYTES) {
+			nemo_thumbnail_atlas_tile_free (tile);
+			tiles = g_list_delete_link (tiles, l);
+		}
+	}
+
+	data = g_new0 (SaveData, 1);
+	data->path = get_atlas_path (directory_location, max_size);
+	data->max_size = max_size;
+	data->tiles = tiles;
+
+	task = g_task_new (NULL, NULL, NULL, NULL);
+	g_task_set_task_data (task, data, (GDestroyNotify) save_data_free);
+	g_task_run_in_thread (task, save_thread);
+	g_object_unref (task);
+}
@@ -0,0 +1,72 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   nemo-thumbnail-atlas.h: Packed per-directory thumbnail cache.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin Street - Suite 500,
+   Boston, MA 02110-1335, USA.
+*/
+
+#ifndef NEMO_THUMBNAIL_ATLAS_H
+#define NEMO_THUMBNAIL_ATLAS_H
+
+#include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+/* An atlas holds the already decoded and scaled thumbnails of one
+ * directory in a single mmap-able file under the user cache, so
+ * re-entering a folder needs one open instead of one PNG read and
+ * decode per file.
+ */
+typedef struct NemoThumbnailAtlas NemoThumbnailAtlas;
+
+typedef struct {
+	char *name;
+	time_t mtime;       /* of the thumbnailed file */
+	time_t thumb_mtime; /* Thumb::MTime of the thumbnail */
+	GdkPixbuf *pixbuf;
+} NemoThumbnailAtlasTile;
+
+/* Returns NULL if there is no usable atlas for the directory at this size. */
+NemoThumbnailAtlas *nemo_thumbnail_atlas_open    (GFile              *directory_location,
+						  int                 max_size);
+void                nemo_thumbnail_atlas_free    (NemoThumbnailAtlas *atlas);
+
+/* Returns a pixbuf sharing the atlas mapping, or NULL if the file
+ * has no tile or the tile is older than @mtime.
+ */
+GdkPixbuf *         nemo_thumbnail_atlas_lookup  (NemoThumbnailAtlas *atlas,
+						  const char         *name,
+						  time_t              mtime);
+
+/* Writes a new atlas from @tiles in a thread, replacing any existing
+ * one. Tiles of @previous that aren't in @tiles are kept. If
+ * @existing_names isn't NULL, tiles of names that aren't keys in it
+ * are dropped. Takes ownership of @tiles.
+ *
+ * Also expires atlases of folders that weren't visited for a while.
+ */
+void                nemo_thumbnail_atlas_save_async (GFile              *directory_location,
+						     int                 max_size,
+						     GList              *tiles,
+						     NemoThumbnailAtlas *previous,
+						     GHashTable         *existing_names);
+
+NemoThumbnailAtlasTile *nemo_thumbnail_atlas_tile_new  (const char *name,
+							time_t      mtime,
+							time_t      thumb_mtime,
+							GdkPixbuf  *pixbuf);
+void                    nemo_thumbnail_atlas_tile_free (NemoThumbnailAtlasTile *tile);
+
+#endif /* NEMO_THUMBNAIL_ATLAS_H */
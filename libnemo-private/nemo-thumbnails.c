@@ -39,6 +39,7 @@
 #include <gtk/gtk.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -63,11 +64,19 @@
 #define NEMO_THUMBNAIL_FRAME_RIGHT 3
 #define NEMO_THUMBNAIL_FRAME_BOTTOM 3
 
+/* Average generation time above which a mime type counts as heavyweight.
+   Only a few heavyweight thumbnailers (video, documents...) run at once. */
+#define HEAVY_THUMBNAIL_USEC (300 * G_TIME_SPAN_MILLISECOND)
+
+/* How often the pool size is re-evaluated against system load */
+#define POOL_ADJUST_INTERVAL (2 * G_TIME_SPAN_SECOND)
+
 
 typedef enum {
     THUMBNAIL_ADD,
     THUMBNAIL_REMOVE,
     THUMBNAIL_BUMP,
+    THUMBNAIL_PRUNE,
     THUMBNAIL_THREAD_EXIT
 } ThumbnailCommandType;
 
@@ -78,9 +87,19 @@ typedef struct {
     time_t original_file_mtime;
     gint64 add_time;
     ThumbnailCommandType cmd_type;
+    gconstpointer client; /* View that last reported the file in sight, if any */
+    GHashTable *keep_uris; /* THUMBNAIL_PRUNE only */
     guint cancelled : 1;
+    guint parked : 1;
+    guint heavy : 1;
 } NemoThumbnailInfo;
 
+/* Measured generation cost for one mime type */
+typedef struct {
+    gint64 avg_usec;
+    guint count;
+} NemoThumbnailCost;
+
 /* How it works:
  * 
  * When nemo_create_thumbnail(), nemo_thumbnail_remove_from_queue or nemo_thumbnail_prioritize are called,
@@ -101,6 +120,19 @@ typedef struct {
  * - nemo_thumbnail_prioritize (THUMBNAIL_BUMP): The info is looked up by uri in thumbnails_to_make_hash. If found,
  *   it gets moved to the front of the threadpool queue.
  *
+ * - nemo_thumbnail_update_viewport (THUMBNAIL_BUMP, THUMBNAIL_PRUNE): Views report the files in or near their
+ *   viewport. Those still being thumbnailed are bumped, which also tags the queued info with the reporting
+ *   view, then a prune for that view carrying the uris visible in every view is sent. Any queued info tagged
+ *   with that view and not in the set is cancelled the same way as THUMBNAIL_REMOVE, but also marked parked,
+ *   so the worker clears the file's is_thumbnailing flag and the thumbnail gets queued again once the file
+ *   scrolls back into view. Infos no view has reported (properties dialog, sidebar, ...) are never pruned.
+ *   nemo_thumbnail_remove_viewport sends a final prune for the view going away.
+ *
+ *
+ * The threadpool is resized every POOL_ADJUST_INTERVAL from the processor count and the system load.
+ * Workers time each thumbnail per mime type. Types that turn out to be expensive (or are expected to
+ * be, like video) are limited to a few concurrent runs; extra ones wait in deferred_heavy and get
+ * pushed back to the pool as running ones finish.
  *
  * - No mutex locking occurs in the public methods, only in the feeder and threadpool threads.
  * - NemoThumbnailInfos are garbage-collected in the threadpool worker only.
@@ -120,25 +152,43 @@ static GTask *feeder_task = NULL;
 /* Causes the feeder_task to end. Only called when Nemo is shutting down. */
 GCancellable *cancellable = NULL;
 
+/* Cost model, heavyweight throttling and throughput statistics. Protected by stats_mutex. */
+static GMutex stats_mutex;
+static GHashTable *mime_costs = NULL;
+static GQueue deferred_heavy = G_QUEUE_INIT;
+static gint running_heavy = 0;
+static gint max_heavy = 1;
+static gint64 last_adjust_time = 0;
+static guint generated_count = 0;
+static guint failed_count = 0;
+static guint window_count = 0;
+static gdouble per_second = 0.0;
+
+/* Mainloop only. Maps each view reporting its viewport to the uris it has in view. */
+static GHashTable *viewports = NULL;
+
 static GnomeDesktopThumbnailFactory *thumbnail_factory = NULL;
 
 static gint
 get_max_threads (void) {
     gint max_threads = 1;
     gint num_processors = g_get_num_processors ();
+    gdouble load = 0.0;
 
     gint pref = g_settings_get_int (nemo_preferences, NEMO_PREFERENCES_MAX_THUMBNAIL_THREADS);
 
     if (pref == -1) {
-        if (num_processors >= 8) {
-            max_threads = 4;
-        }
-        else if (num_processors >= 4) {
-            max_threads = 2;
-        }
-        else {
-            max_threads = 1;
+        /* Use the processors nobody else is using. Our own threads add to the
+           load average, so count them as available. */
+        max_threads = num_processors;
+
+        if (getloadavg (&load, 1) == 1) {
+            gint own = tpool != NULL ? (gint) g_thread_pool_get_num_threads ((GThreadPool *) tpool) : 0;
+
+            max_threads = (gint) (num_processors - load + own + 0.5);
         }
+
+        max_threads = MIN (max_threads, num_processors);
     } else {
         max_threads = pref;
     }
@@ -146,14 +196,162 @@ get_max_threads (void) {
     max_threads = MAX (1, max_threads);
 
 #if DEBUG_THREADS
-    g_message ("Thumbnailer threads: %d (setting: %d, system count: %d)", max_threads, pref, num_processors);
+    g_message ("Thumbnailer threads: %d (setting: %d, system count: %d, load: %.2f)", max_threads, pref, num_processors, load);
 #else
-    DEBUG ("Thumbnailer threads: %d (setting: %d, system count: %d)", max_threads, pref, num_processors);
+    DEBUG ("Thumbnailer threads: %d (setting: %d, system count: %d, load: %.2f)", max_threads, pref, num_processors, load);
 #endif
 
     return max_threads;
 }
 
+/* Always on thumbnail thread, stats_mutex held */
+static gboolean
+is_heavy_mime_type (const gchar *mime_type)
+{
+    NemoThumbnailCost *cost;
+
+    if (mime_type == NULL)
+        return FALSE;
+
+    cost = mime_costs != NULL ? g_hash_table_lookup (mime_costs, mime_type) : NULL;
+
+    if (cost != NULL && cost->count >= 2) {
+        return cost->avg_usec >= HEAVY_THUMBNAIL_USEC;
+    }
+
+    /* Nothing measured yet, guess */
+    return g_str_has_prefix (mime_type, "video/") ||
+           g_strcmp0 (mime_type, "application/pdf") == 0 ||
+           g_strcmp0 (mime_type, "application/postscript") == 0;
+}
+
+/* Always on thumbnail thread. Returns FALSE if the info was deferred
+   because too many heavyweight thumbnailers are already running. */
+static gboolean
+acquire_thumbnail_slot (NemoThumbnailInfo *info)
+{
+    gboolean ret = TRUE;
+
+    g_mutex_lock (&stats_mutex);
+
+    if (is_heavy_mime_type (info->mime_type)) {
+        if (running_heavy < max_heavy) {
+            running_heavy++;
+            info->heavy = TRUE;
+        } else {
+            DEBUG ("(Thumbnail Thread) Deferring heavyweight file: %s", info->image_uri);
+            g_queue_push_tail (&deferred_heavy, info);
+            ret = FALSE;
+        }
+    }
+
+    g_mutex_unlock (&stats_mutex);
+
+    return ret;
+}
+
+/* Always on thumbnail thread */
+static void
+adjust_pool_size (gint64 now)
+{
+    gint threads;
+    gdouble elapsed;
+    GList *requeue = NULL, *l;
+
+    threads = get_max_threads ();
+
+    g_mutex_lock (&stats_mutex);
+
+    elapsed = (gdouble) (now - last_adjust_time) / G_TIME_SPAN_SECOND;
+    per_second = window_count / elapsed;
+    window_count = 0;
+    last_adjust_time = now;
+
+    max_heavy = MAX (1, threads / 4);
+
+    while (running_heavy + (gint) g_list_length (requeue) < max_heavy &&
+           !g_queue_is_empty (&deferred_heavy)) {
+        requeue = g_list_prepend (requeue, g_queue_pop_head (&deferred_heavy));
+    }
+
+    DEBUG ("(Thumbnail Thread) Pool: %d threads, %d/%d heavyweight, %.1f thumbnails/s, %u generated, %u failed",
+           threads, running_heavy, max_heavy, per_second, generated_count, failed_count);
+
+    g_mutex_unlock (&stats_mutex);
+
+    g_thread_pool_set_max_threads ((GThreadPool *) tpool, threads, NULL);
+
+    for (l = requeue; l != NULL; l = l->next) {
+        g_thread_pool_push ((GThreadPool *) tpool, l->data, NULL);
+    }
+
+    g_list_free (requeue);
+}
+
+/* Always on thumbnail thread */
+static void
+record_thumbnail_cost (NemoThumbnailInfo *info,
+                       gint64             elapsed,
+                       gboolean           success)
+{
+    NemoThumbnailCost *cost;
+    NemoThumbnailInfo *next = NULL;
+    gint64 now;
+    gboolean adjust;
+
+    now = g_get_monotonic_time ();
+
+    g_mutex_lock (&stats_mutex);
+
+    if (mime_costs == NULL) {
+        mime_costs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    }
+
+    if (info->mime_type != NULL) {
+        cost = g_hash_table_lookup (mime_costs, info->mime_type);
+
+        if (cost == NULL) {
+            cost = g_new0 (NemoThumbnailCost, 1);
+            cost->avg_usec = elapsed;
+            g_hash_table_insert (mime_costs, g_strdup (info->mime_type), cost);
+        } else {
+            cost->avg_usec = (cost->avg_usec * 3 + elapsed) / 4;
+        }
+
+        cost->count++;
+    }
+
+    if (success) {
+        generated_count++;
+    } else {
+        failed_count++;
+    }
+
+    window_count++;
+
+    if (info->heavy) {
+        running_heavy--;
+        info->heavy = FALSE;
+
+        if (!g_cancellable_is_cancelled (cancellable)) {
+            next = g_queue_pop_head (&deferred_heavy);
+        }
+    }
+
+    adjust = now - last_adjust_time >= POOL_ADJUST_INTERVAL &&
+             !g_cancellable_is_cancelled (cancellable);
+
+    g_mutex_unlock (&stats_mutex);
+
+    if (next != NULL) {
+        g_thread_pool_push ((GThreadPool *) tpool, next, NULL);
+    }
+
+    if (adjust) {
+        adjust_pool_size (now);
+    }
+}
+
 static gint
 lifo_sorter (gconstpointer a,
              gconstpointer b,
@@ -195,6 +393,7 @@ free_thumbnail_info (NemoThumbnailInfo *info)
 {
     g_free (info->image_uri);
     g_free (info->mime_type);
+    g_clear_pointer (&info->keep_uris, g_hash_table_unref);
     g_free (info);
 }
 
@@ -273,6 +472,113 @@ pixbuf_can_load_type (const char *mime_type)
     return g_hash_table_contains (image_mime_types, mime_type);
 }
 
+/* Raster types thumbnailed in-process instead of through the factory, which may
+   spawn an external thumbnailer for every file. */
+static const gchar * const fast_thumbnail_types[] = {
+    "image/jpeg",
+    "image/png",
+    "image/webp",
+    "image/bmp",
+    NULL
+};
+
+/* Shrink to the large thumbnail size while decoding. For JPEG this makes the
+   loader decode at a reduced DCT scale instead of at full resolution. */
+static void
+fast_thumbnail_size_prepared (GdkPixbufLoader *loader,
+                              gint             width,
+                              gint             height,
+                              gpointer         user_data)
+{
+    gint *original_size = user_data;
+    gint thumb_size = 256; /* GNOME_DESKTOP_THUMBNAIL_SIZE_LARGE */
+
+    original_size[0] = width;
+    original_size[1] = height;
+
+    if (MAX (width, height) <= thumb_size) {
+        return;
+    }
+
+    if (width > height) {
+        height = MAX (1, (gint) ((gdouble) height * thumb_size / width + 0.5));
+        width = thumb_size;
+    } else {
+        width = MAX (1, (gint) ((gdouble) width * thumb_size / height + 0.5));
+        height = thumb_size;
+    }
+
+    gdk_pixbuf_loader_set_size (loader, width, height);
+}
+
+/* Thumbnail thread. Returns NULL if the file should go through the factory instead. */
+static GdkPixbuf *
+generate_thumbnail_in_process (const gchar *image_uri,
+                               const gchar *mime_type)
+{
+    GdkPixbufLoader *loader;
+    GdkPixbuf *pixbuf = NULL;
+    gchar *path, *contents, *str;
+    gsize length;
+    gint original_size[2] = { 0, 0 };
+    gboolean res;
+
+    if (mime_type == NULL ||
+        !g_strv_contains (fast_thumbnail_types, mime_type) ||
+        !pixbuf_can_load_type (mime_type)) {
+        return NULL;
+    }
+
+    path = g_filename_from_uri (image_uri, NULL, NULL);
+
+    if (path == NULL) {
+        return NULL;
+    }
+
+    if (!g_file_get_contents (path, &contents, &length, NULL)) {
+        g_free (path);
+        return NULL;
+    }
+
+    g_free (path);
+
+    loader = gdk_pixbuf_loader_new_with_mime_type (mime_type, NULL);
+
+    if (loader == NULL) {
+        g_free (contents);
+        return NULL;
+    }
+
+    g_signal_connect (loader, "size-prepared",
+                      G_CALLBACK (fast_thumbnail_size_prepared), original_size);
+
+    res = gdk_pixbuf_loader_write (loader, (const guchar *) contents, length, NULL);
+    res = gdk_pixbuf_loader_close (loader, NULL) && res;
+
+    g_free (contents);
+
+    if (res && gdk_pixbuf_loader_get_pixbuf (loader) != NULL) {
+        pixbuf = gdk_pixbuf_apply_embedded_orientation (gdk_pixbuf_loader_get_pixbuf (loader));
+    }
+
+    g_object_unref (loader);
+
+    if (pixbuf == NULL) {
+        DEBUG ("(Thumbnail Thread) In-process thumbnailing failed, falling back: %s", image_uri);
+        return NULL;
+    }
+
+    /* Picked up by gnome_desktop_thumbnail_factory_save_thumbnail() */
+    str = g_strdup_printf ("%d", original_size[0]);
+    gdk_pixbuf_set_option (pixbuf, "tEXt::Thumb::Image::Width", str);
+    g_free (str);
+    str = g_strdup_printf ("%d", original_size[1]);
+    gdk_pixbuf_set_option (pixbuf, "tEXt::Thumb::Image::Height", str);
+    g_free (str);
+
+    return pixbuf;
+}
+
 /* This is a one-shot idle callback called from the main loop to call
    notify_file_changed() for a thumbnail. It frees the uri afterwards.
    We do this in an idle callback as I don't think nemo_file_changed() is
@@ -299,12 +605,37 @@ thumbnail_thread_notify_file_changed (gpointer image_uri)
     return G_SOURCE_REMOVE;
 }
 
+/* Idle callback for a thumbnail that was dropped from the queue because its file
+   scrolled out of view. Clearing is_thumbnailing lets nemo_file_get_icon() queue it
+   again when the file is next shown. */
+static gboolean
+thumbnail_thread_notify_parked (gpointer image_uri)
+{
+    NemoFile *file;
+
+    file = nemo_file_get_by_uri ((char *) image_uri);
+
+    DEBUG ("(Thumbnail Thread) Parked out of view file: %p uri: %s", file, (char*) image_uri);
+
+    if (file != NULL) {
+        nemo_file_set_is_thumbnailing (file, FALSE);
+        nemo_file_unref (file);
+    }
+
+    g_free (image_uri);
+
+    return G_SOURCE_REMOVE;
+}
+
 /* Always on thumbnail thread */
 static void
 remove_from_hash_table (NemoThumbnailInfo *info)
 {
     g_mutex_lock (&thumbnails_mutex);
-    g_hash_table_remove (thumbnails_to_make_hash, info->image_uri);
+    /* A cancelled info may have been replaced by a newer one for the same uri. */
+    if (g_hash_table_lookup (thumbnails_to_make_hash, info->image_uri) == info) {
+        g_hash_table_remove (thumbnails_to_make_hash, info->image_uri);
+    }
     g_mutex_unlock (&thumbnails_mutex);
 
     free_thumbnail_info (info);
@@ -320,9 +651,15 @@ thumbnail_thread (gpointer data,
     time_t current_time;
     gchar *image_uri = info->image_uri;
     gboolean free_uri = FALSE;
+    gint64 start_time;
 
     if (g_cancellable_is_cancelled (cancellable) || info->cancelled) {
         DEBUG ("Skipping cancelled file: %s", info->image_uri);
+
+        if (info->parked && !g_cancellable_is_cancelled (cancellable)) {
+            g_idle_add (thumbnail_thread_notify_parked, g_strdup (info->image_uri));
+        }
+
         remove_from_hash_table (info);
         return;
     }
@@ -342,9 +679,15 @@ thumbnail_thread (gpointer data,
         return;
     }
 
+    if (!acquire_thumbnail_slot (info)) {
+        return;
+    }
+
     /* Create the thumbnail. */
     DEBUG ("(Thumbnail Thread) Creating thumbnail: %s", info->image_uri);
 
+    start_time = g_get_monotonic_time ();
+
     if (eel_uri_is_network (info->image_uri)) {
         GFile *file = g_file_new_for_uri (info->image_uri);
         GError *err = NULL;
@@ -367,13 +710,19 @@ thumbnail_thread (gpointer data,
      * because of that we have to convert our path from the network URI to a local file:// URI or else any
      * thumbnailers that use %i wont generate thumbnails correctly
      */
-    pixbuf = gnome_desktop_thumbnail_factory_generate_thumbnail (thumbnail_factory,
-                                                                 image_uri,
-                                                                 info->mime_type);
+    pixbuf = generate_thumbnail_in_process (image_uri, info->mime_type);
+
+    if (pixbuf == NULL) {
+        pixbuf = gnome_desktop_thumbnail_factory_generate_thumbnail (thumbnail_factory,
+                                                                     image_uri,
+                                                                     info->mime_type);
+    }
     if (free_uri) {
         g_free (image_uri);
     }
 
+    record_thumbnail_cost (info, g_get_monotonic_time () - start_time, pixbuf != NULL);
+
     if (pixbuf) {
         gnome_desktop_thumbnail_factory_save_thumbnail (thumbnail_factory,
                                                         pixbuf,
@@ -481,11 +830,42 @@ feeder_thread (GTask        *task,
                 if (existing_info) {
                     DEBUG ("(Prioritize) Moving to front: %s", feeder_info->image_uri);
                     existing_info->add_time = g_get_monotonic_time ();
+
+                    if (feeder_info->client != NULL) {
+                        existing_info->client = feeder_info->client;
+                    }
+
                     g_thread_pool_move_to_front ((GThreadPool *) tpool, existing_info);
                 }
                 DEBUG ("(Prioritize) Unlocking mutex");
                 g_mutex_unlock (&thumbnails_mutex);
                 break;
+            case THUMBNAIL_PRUNE:
+                if (!thumbnails_to_make_hash)
+                    break;
+
+                DEBUG ("(Prune) Locking mutex");
+                g_mutex_lock (&thumbnails_mutex);
+                {
+                    GHashTableIter iter;
+                    gpointer value;
+
+                    g_hash_table_iter_init (&iter, thumbnails_to_make_hash);
+                    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+                        existing_info = (NemoThumbnailInfo *) value;
+
+                        if (existing_info->client == feeder_info->client &&
+                            !g_hash_table_contains (feeder_info->keep_uris, existing_info->image_uri)) {
+                            DEBUG ("(Prune) Parking out of view file: %s", existing_info->image_uri);
+                            existing_info->cancelled = TRUE;
+                            existing_info->parked = TRUE;
+                            g_hash_table_iter_remove (&iter);
+                        }
+                    }
+                }
+                DEBUG ("(Prune) Unlocking mutex");
+                g_mutex_unlock (&thumbnails_mutex);
+                break;
             case THUMBNAIL_THREAD_EXIT:
                 DEBUG ("(Finalize) Received THUMBNAIL_THREAD_EXIT, cancelling");
                 g_cancellable_cancel (cancellable);
@@ -532,7 +912,13 @@ finalize_thumbnailer (void)
     // This will drain and free any remaining infos.
     g_thread_pool_free ((GThreadPool *) tpool, FALSE, TRUE);
 
+    g_queue_foreach (&deferred_heavy, (GFunc) free_thumbnail_info, NULL);
+    g_queue_clear (&deferred_heavy);
+    g_clear_pointer (&mime_costs, g_hash_table_destroy);
+
     g_hash_table_destroy (thumbnails_to_make_hash);
+
+    g_clear_pointer (&viewports, g_hash_table_destroy);
 }
 
 /* Mainloop */
@@ -549,6 +935,7 @@ nemo_create_thumbnail (NemoFile *file)
                                    get_max_threads (),
                                    FALSE, NULL);
         g_thread_pool_set_sort_function ((GThreadPool *) tpool, (GCompareDataFunc) lifo_sorter, NULL);
+        last_adjust_time = g_get_monotonic_time ();
 
         feeder_queue = g_async_queue_new ();
         cancellable = g_cancellable_new ();
@@ -627,9 +1014,9 @@ nemo_thumbnail_remove_from_queue (const char *file_uri)
     g_async_queue_push (feeder_queue, info);
 }
 
-/* Mainloop */
-void
-nemo_thumbnail_prioritize (const char *file_uri)
+static void
+queue_bump (const char    *file_uri,
+            gconstpointer  client)
 {
     if (feeder_queue == NULL)
         return;
@@ -638,6 +1025,7 @@ nemo_thumbnail_prioritize (const char *file_uri)
 
     info = g_new0 (NemoThumbnailInfo, 1);
     info->image_uri = g_strdup (file_uri);
+    info->client = client;
     info->cmd_type = THUMBNAIL_BUMP;
 
 #if DEBUG_THREADS
@@ -647,6 +1035,133 @@ nemo_thumbnail_prioritize (const char *file_uri)
     g_async_queue_push (feeder_queue, info);
 }
 
+/* Mainloop */
+void
+nemo_thumbnail_prioritize (const char *file_uri)
+{
+    queue_bump (file_uri, NULL);
+}
+
+/* Mainloop. Drops @client's queued files that no view has in sight. */
+static void
+queue_prune (gconstpointer client)
+{
+    NemoThumbnailInfo *info;
+    GHashTable *keep_uris;
+    GHashTableIter iter;
+    gpointer value, key;
+
+    if (feeder_queue == NULL)
+        return;
+
+    /* Keep whatever any view still shows, drop the rest. */
+    keep_uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+    if (viewports != NULL) {
+        g_hash_table_iter_init (&iter, viewports);
+        while (g_hash_table_iter_next (&iter, NULL, &value)) {
+            GHashTableIter uri_iter;
+
+            g_hash_table_iter_init (&uri_iter, (GHashTable *) value);
+            while (g_hash_table_iter_next (&uri_iter, &key, NULL)) {
+                g_hash_table_add (keep_uris, g_strdup ((gchar *) key));
+            }
+        }
+    }
+
+    info = g_new0 (NemoThumbnailInfo, 1);
+    info->client = client;
+    info->keep_uris = keep_uris;
+    info->cmd_type = THUMBNAIL_PRUNE;
+
+#if DEBUG_THREADS
+    g_message ("Push to feeder (Prune) %i items in feeder", g_async_queue_length (feeder_queue));
+#endif
+
+    g_async_queue_push (feeder_queue, info);
+}
+
+/* Mainloop */
+void
+nemo_thumbnail_update_viewport (gconstpointer  client,
+                                GList         *files)
+{
+    GHashTable *visible_uris;
+    GList *l;
+
+    if (viewports == NULL) {
+        viewports = g_hash_table_new_full (NULL, NULL, NULL,
+                                           (GDestroyNotify) g_hash_table_unref);
+    }
+
+    visible_uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+    /* The queue is LIFO, so bump the least important file first. */
+    for (l = g_list_last (files); l != NULL; l = l->prev) {
+        NemoFile *file = NEMO_FILE (l->data);
+        gchar *uri = nemo_file_get_uri (file);
+
+        if (nemo_file_is_thumbnailing (file)) {
+            queue_bump (uri, client);
+        }
+
+        g_hash_table_add (visible_uris, uri);
+    }
+
+    g_hash_table_replace (viewports, (gpointer) client, visible_uris);
+
+    DEBUG ("Viewport update: %u files in view", g_hash_table_size (visible_uris));
+
+    queue_prune (client);
+}
+
+/* Mainloop */
+void
+nemo_thumbnail_remove_viewport (gconstpointer client)
+{
+    if (viewports == NULL)
+        return;
+
+    g_hash_table_remove (viewports, client);
+
+    /* What the view had queued goes too, unless another view shows it */
+    queue_prune (client);
+}
+
+/* Any thread */
+guint
+nemo_thumbnail_get_queue_depth (void)
+{
+    guint depth;
+
+    if (thumbnails_to_make_hash == NULL)
+        return 0;
+
+    g_mutex_lock (&thumbnails_mutex);
+    depth = g_hash_table_size (thumbnails_to_make_hash);
+    g_mutex_unlock (&thumbnails_mutex);
+
+    return depth;
+}
+
+/* Any thread */
+void
+nemo_thumbnail_get_stats (NemoThumbnailStats *stats)
+{
+    g_return_if_fail (stats != NULL);
+
+    g_mutex_lock (&stats_mutex);
+    stats->generated = generated_count;
+    stats->failed = failed_count;
+    stats->heavy_running = running_heavy;
+    stats->heavy_deferred = g_queue_get_length (&deferred_heavy);
+    stats->per_second = per_second;
+    g_mutex_unlock (&stats_mutex);
+
+    stats->threads = tpool != NULL ? (gint) g_thread_pool_get_max_threads ((GThreadPool *) tpool) : 0;
+    stats->queued = nemo_thumbnail_get_queue_depth ();
+}
+
 gboolean
 nemo_can_thumbnail_internally (NemoFile *file)
 {
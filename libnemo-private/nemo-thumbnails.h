@@ -31,6 +31,17 @@
 /* Cool-off period between last file modification time and thumbnail creation */
 #define THUMBNAIL_CREATION_DELAY_SECS 3
 
+/* Thumbnailer throughput, for diagnostics */
+typedef struct {
+	guint generated;
+	guint failed;
+	guint queued;
+	gint threads;
+	gint heavy_running;
+	guint heavy_deferred;
+	gdouble per_second;
+} NemoThumbnailStats;
+
 /* Returns NULL if there's no thumbnail yet. */
 void       nemo_create_thumbnail                (NemoFile *file);
 gboolean   nemo_can_thumbnail                   (NemoFile *file);
@@ -41,6 +52,15 @@ void       nemo_thumbnail_pad_top_and_bottom    (GdkPixbuf **pixbuf,
 /* Queue handling: */
 void       nemo_thumbnail_remove_from_queue     (const char   *file_uri);
 void       nemo_thumbnail_prioritize            (const char   *file_uri);
+/* Views report the files in or near their viewport, most important first.
+ * Thumbnails a view had queued are dropped once no view has them in sight,
+ * and re-queued when shown again. Requests from elsewhere are left alone. */
+void       nemo_thumbnail_update_viewport       (gconstpointer  client,
+                                                 GList         *files);
+void       nemo_thumbnail_remove_viewport       (gconstpointer  client);
+/* Number of thumbnails waiting to be generated, for diagnostics. */
+guint      nemo_thumbnail_get_queue_depth       (void);
+void       nemo_thumbnail_get_stats             (NemoThumbnailStats *stats);
 
 gboolean   nemo_thumbnail_factory_check_status          (void);
 
@@ -39,6 +39,7 @@ struct NemoTrashMonitorDetails {
 	GIcon *icon;
     const gchar *symbolic_icon_name;
 	GFileMonitor *file_monitor;
+	guint update_id;
 };
 
 enum {
@@ -49,6 +50,11 @@ enum {
 static guint signals[LAST_SIGNAL] = { 0 };
 static NemoTrashMonitor *nemo_trash_monitor = NULL;
 
+/* Trashing many files at once sends a change per file, only
+ * query the trash once they have settled down.
+ */
+#define UPDATE_INFO_DELAY 200
+
 G_DEFINE_TYPE(NemoTrashMonitor, nemo_trash_monitor, G_TYPE_OBJECT)
 
 static void
@@ -66,6 +72,10 @@ nemo_trash_monitor_finalize (GObject *object)
 		g_object_unref (trash_monitor->details->file_monitor);
 	}
 
+	if (trash_monitor->details->update_id != 0) {
+		g_source_remove (trash_monitor->details->update_id);
+	}
+
 	G_OBJECT_CLASS (nemo_trash_monitor_parent_class)->finalize (object);
 }
 
@@ -168,6 +178,19 @@ schedule_update_info (NemoTrashMonitor *trash_monitor)
 	g_object_unref (location);
 }
 
+static gboolean
+update_info_timeout (gpointer user_data)
+{
+	NemoTrashMonitor *trash_monitor;
+
+	trash_monitor = NEMO_TRASH_MONITOR (user_data);
+	trash_monitor->details->update_id = 0;
+
+	schedule_update_info (trash_monitor);
+
+	return FALSE;
+}
+
 static void
 file_changed (GFileMonitor* monitor,
 	      GFile *child,
@@ -179,7 +202,10 @@ file_changed (GFileMonitor* monitor,
 
 	trash_monitor = NEMO_TRASH_MONITOR (user_data);
 
-	schedule_update_info (trash_monitor);
+	if (trash_monitor->details->update_id == 0) {
+		trash_monitor->details->update_id =
+			g_timeout_add (UPDATE_INFO_DELAY, update_info_timeout, trash_monitor);
+	}
 }
 
 static void
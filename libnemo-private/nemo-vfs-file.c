@@ -251,20 +251,24 @@ vfs_file_get_deep_counts (NemoFile *file,
 	}
 
 	if (file->details->deep_counts_status != NEMO_REQUEST_NOT_STARTED) {
+		const NemoFileRareDetails *rare;
+
+		rare = nemo_file_peek_rare_details (file);
+
 		if (directory_count != NULL) {
-			*directory_count = file->details->deep_directory_count;
+			*directory_count = rare->deep_directory_count;
 		}
 		if (file_count != NULL) {
-			*file_count = file->details->deep_file_count;
+			*file_count = rare->deep_file_count;
 		}
 		if (unreadable_directory_count != NULL) {
-			*unreadable_directory_count = file->details->deep_unreadable_count;
+			*unreadable_directory_count = rare->deep_unreadable_count;
 		}
 		if (total_size != NULL) {
-			*total_size = file->details->deep_size;
+			*total_size = rare->deep_size;
 		}
         if (hidden_count != NULL) {
-            *hidden_count = file->details->deep_hidden_count;
+            *hidden_count = rare->deep_hidden_count;
         }
 		return file->details->deep_counts_status;
 	}
@@ -324,11 +328,11 @@ vfs_file_get_date (NemoFile *file,
         return TRUE;
 	case NEMO_DATE_TYPE_TRASHED:
 		/* Before we have info on a file, the date is unknown. */
-		if (file->details->trash_time == 0) {
+		if (nemo_file_peek_rare_details (file)->trash_time == 0) {
 			return FALSE;
 		}
 		if (date != NULL) {
-			*date = file->details->trash_time;
+			*date = nemo_file_peek_rare_details (file)->trash_time;
 		}
 		return TRUE;
 	case NEMO_DATE_TYPE_PERMISSIONS_CHANGED:
@@ -513,6 +513,40 @@ nemo_icon_view_container_compare_icons (NemoIconContainer *container,
 					   (NemoFile *)icon_b);
 }
 
+static NemoFile *
+icon_get_file (gpointer data)
+{
+	return NEMO_FILE (((NemoIcon *) data)->data);
+}
+
+static int
+compare_desktop_icons_cover (gconstpointer a, gconstpointer b, gpointer container)
+{
+	const NemoIcon *icon_a = *(NemoIcon * const *) a;
+	const NemoIcon *icon_b = *(NemoIcon * const *) b;
+
+	return fm_desktop_icon_container_icons_compare (container, icon_a->data, icon_b->data);
+}
+
+static void
+nemo_icon_view_container_sort_icons (NemoIconContainer *container,
+				     NemoIcon         **icons,
+				     guint              n_icons)
+{
+	NemoIconView *icon_view;
+
+	icon_view = get_icon_view (container);
+	g_return_if_fail (icon_view != NULL);
+
+	if (NEMO_ICON_VIEW_CONTAINER (container)->sort_for_desktop) {
+		g_qsort_with_data (icons, n_icons, sizeof (NemoIcon *),
+				   compare_desktop_icons_cover, container);
+		return;
+	}
+
+	nemo_icon_view_sort_items (icon_view, (gpointer *) icons, n_icons, icon_get_file);
+}
+
 static void
 nemo_icon_view_container_freeze_updates (NemoIconContainer *container)
 {
@@ -702,6 +736,79 @@ lay_down_one_column (NemoIconContainer *container,
 #define COLUMN_GAP 4
 #define ROW_GAP 10
 
+/* Labels below icons: every cell has the same width and every row the
+ * same height, so positions follow from the icon's index alone and no
+ * label has to be measured. Only the icon rectangle, which is known
+ * without Pango, is used to center the icon in its cell.
+ */
+static void
+lay_down_icons_grid (NemoIconContainer *container,
+                     GList *icons,
+                     double start_y,
+                     double canvas_width,
+                     double grid_width,
+                     int icon_size,
+                     int icon_text_gap,
+                     int column_gap,
+                     int row_gap)
+{
+    NemoIconGrid *grid;
+    GList *p;
+    NemoIcon *icon;
+    EelDRect icon_bounds;
+    guint i, n_rows, row, column;
+    double x, y;
+    gboolean is_rtl;
+
+    grid = &container->details->grid;
+    is_rtl = nemo_icon_container_is_layout_rtl (container);
+
+    if (container->details->fixed_text_height == -1) {
+        icon = icons->data;
+        nemo_icon_container_ensure_icon_item (container, icon);
+        container->details->fixed_text_height = nemo_icon_canvas_item_get_fixed_text_height_for_layout (icon->item) / EEL_CANVAS (container)->pixels_per_unit;
+    }
+
+    /* Same wrapping rule as the line-at-a-time layout: an icon starts a
+     * new line once the line would reach the canvas width. */
+    grid->n_columns = MAX ((int) ceil (canvas_width / grid_width) - 1, 1);
+    grid->n_icons = g_list_length (icons);
+    grid->start_y = start_y + row_gap;
+    grid->cell_width = grid_width;
+    grid->row_height = icon_text_gap + icon_size + container->details->fixed_text_height + row_gap;
+    grid->icon_size = icon_size;
+    grid->label_height = icon_text_gap + container->details->fixed_text_height;
+
+    n_rows = (grid->n_icons + grid->n_columns - 1) / grid->n_columns;
+
+    for (p = icons, i = 0; p != NULL; p = p->next, i++) {
+        icon = p->data;
+
+        row = i / grid->n_columns;
+        column = i % grid->n_columns;
+
+        /* Icons without an item stand in as an icon_size square */
+        icon_bounds = nemo_icon_container_icon_get_rectangle (container, icon);
+
+        x = column_gap + column * grid_width + (grid_width - (icon_bounds.x1 - icon_bounds.x0)) / 2;
+        /* Bottom of the icon sits on the row's baseline */
+        y = grid->start_y + row * grid->row_height + icon_text_gap + icon_size - (icon_bounds.y1 - icon_bounds.y0);
+
+        nemo_icon_container_icon_set_position
+            (container, icon,
+             is_rtl ? nemo_icon_container_get_mirror_x_position (container, icon, x) : x,
+             y);
+        if (icon->item != NULL) {
+            nemo_icon_canvas_item_set_entire_text (icon->item, row == n_rows - 1);
+        }
+
+        icon->saved_ltr_x = is_rtl ? nemo_icon_container_get_mirror_x_position (container, icon, icon->x) : icon->x;
+    }
+
+    /* Placing a few unpositioned icons doesn't describe the others */
+    grid->valid = icons == container->details->icons;
+}
+
 static void
 lay_down_icons_horizontal (NemoIconContainer *container,
                GList *icons,
@@ -770,6 +877,11 @@ lay_down_icons_horizontal (NemoIconContainer *container,
         num_columns = MAX (num_columns, 1);
         /* -1 prevents jitter */
         grid_width = (((device_canvas_width / num_columns) / ppu) - 1.0);
+
+        lay_down_icons_grid (container, icons, start_y, canvas_width, grid_width,
+                             icon_size, icon_text_gap, column_gap, row_gap);
+        g_array_free (positions, TRUE);
+        return;
     }
 
     line_width = container->details->label_position == NEMO_ICON_LABEL_POSITION_BESIDE ? column_gap : 0;
@@ -1375,9 +1487,11 @@ nemo_icon_view_container_icon_set_position (NemoIconContainer *container,
         icon->y = 0;
     }
 
-    eel_canvas_item_move (EEL_CANVAS_ITEM (icon->item),
-                x - icon->x,
-                y - icon->y);
+    if (icon->item != NULL) {
+        eel_canvas_item_move (EEL_CANVAS_ITEM (icon->item),
+                    x - icon->x,
+                    y - icon->y);
+    }
 
     icon->x = x;
     icon->y = y;
@@ -2094,6 +2208,7 @@ nemo_icon_view_container_class_init (NemoIconViewContainerClass *klass)
     ic_class->get_max_layout_lines = nemo_icon_view_container_get_max_layout_lines;
 
 	ic_class->compare_icons = nemo_icon_view_container_compare_icons;
+	ic_class->sort_icons = nemo_icon_view_container_sort_icons;
 	ic_class->freeze_updates = nemo_icon_view_container_freeze_updates;
 	ic_class->unfreeze_updates = nemo_icon_view_container_unfreeze_updates;
     ic_class->lay_down_icons = nemo_icon_view_container_lay_down_icons;
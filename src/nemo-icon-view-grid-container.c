@@ -702,6 +702,7 @@ update_visual_selection_state (NemoIconContainer *container)
         container->details->icons = g_list_sort_with_data (container->details->icons,
                                                            order_icons_by_visual_position,
                                                            grid);
+        nemo_icon_container_invalidate_icon_array (container);
 
         nemo_centered_placement_grid_free (grid);
     }
@@ -978,6 +979,7 @@ nemo_icon_view_grid_container_align_icons (NemoIconContainer *container)
 
     old_list = container->details->icons;
     container->details->icons = unplaced_icons;
+    nemo_icon_container_invalidate_icon_array (container);
 
     g_list_free (old_list);
 
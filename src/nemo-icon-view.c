@@ -1768,6 +1768,22 @@ nemo_icon_view_compare_files (NemoIconView   *icon_view,
          NULL);
 }
 
+/* Same order as nemo_icon_view_compare_files(), for many files at once */
+void
+nemo_icon_view_sort_items (NemoIconView         *icon_view,
+			   gpointer             *items,
+			   guint                 n_items,
+			   NemoFileSortItemFunc  get_file)
+{
+	nemo_file_sort_items
+		(items, n_items, get_file,
+		 icon_view->details->sort->sort_type,
+		 nemo_view_should_sort_directories_first ((NemoView *)icon_view),
+		 nemo_view_should_sort_favorites_first ((NemoView *)icon_view),
+		 icon_view->details->sort_reversed,
+		 NULL);
+}
+
 static int
 compare_files (NemoView   *icon_view,
 	       NemoFile *a,
@@ -2500,6 +2516,15 @@ icon_view_scroll_to_file (NemoView *view,
 	}
 }
 
+static gboolean
+icon_view_is_file_visible (NemoView *view,
+			   NemoFile *file,
+			   NemoDirectory *directory)
+{
+	return nemo_icon_container_is_icon_visible (get_icon_container (NEMO_ICON_VIEW (view)),
+						    NEMO_ICON_CONTAINER_ICON_DATA (file));
+}
+
 static const char *
 nemo_icon_view_get_id (NemoView *view)
 {
@@ -2736,6 +2761,7 @@ nemo_icon_view_class_init (NemoIconViewClass *klass)
 	nemo_view_class->get_view_id = nemo_icon_view_get_id;
 	nemo_view_class->get_first_visible_file = icon_view_get_first_visible_file;
 	nemo_view_class->scroll_to_file = icon_view_scroll_to_file;
+	nemo_view_class->is_file_visible = icon_view_is_file_visible;
 
 	properties[PROP_COMPACT] =
 		g_param_spec_boolean ("compact",
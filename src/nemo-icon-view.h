@@ -64,6 +64,10 @@ GType   nemo_icon_view_get_type      (void);
 int     nemo_icon_view_compare_files (NemoIconView   *icon_view,
 					  NemoFile *a,
 					  NemoFile *b);
+void    nemo_icon_view_sort_items    (NemoIconView         *icon_view,
+					  gpointer             *items,
+					  guint                 n_items,
+					  NemoFileSortItemFunc  get_file);
 gboolean nemo_icon_view_is_compact   (NemoIconView *icon_view);
 
 void    nemo_icon_view_register         (void);
@@ -53,6 +53,9 @@ static GQuark attribute_name_q,
 /* msec delay after Loading... dummy row turns into (empty) */
 #define LOADING_TO_EMPTY_DELAY 100
 
+/* Plain theme icons shared between rows, dropped wholesale beyond this */
+#define MAX_SHARED_ICON_SURFACES 256
+
 static guint list_model_signals[LAST_SIGNAL] = { 0 };
 
 static int nemo_list_model_file_entry_compare_func (gconstpointer a,
@@ -85,6 +88,15 @@ struct NemoListModelDetails {
 
 	GList *highlight_files;
     gboolean temp_unsorted;
+
+	/* NemoIconInfo -> cairo_surface_t, for rows showing an unmodified
+	 * theme icon, so thousands of rows share a handful of surfaces. */
+	GHashTable *shared_icon_surfaces;
+
+	/* While sorting is frozen, changed rows are only collected here
+	 * and repositioned together when it's thawed. */
+	guint sort_frozen;
+	GHashTable *resort_entries;
 };
 
 typedef struct {
@@ -102,6 +114,15 @@ struct FileEntry {
 	FileEntry *parent;
 	GSequence *files;
 	GSequenceIter *ptr;
+
+	/* Last rendered icon and what it was rendered for. Dropped in
+	 * nemo_list_model_file_changed(). */
+	cairo_surface_t *icon_surface;
+	int icon_column;
+	int icon_scale;
+	NemoFileIconFlags icon_flags;
+	guint icon_highlighted : 1;
+
 	guint loaded : 1;
     guint expanding : 1;
     guint ok_to_show_thumb : 1;
@@ -136,6 +157,7 @@ file_entry_free (FileEntry *file_entry)
 	if (file_entry->files != NULL) {
 		g_sequence_free (file_entry->files);
 	}
+	g_clear_pointer (&file_entry->icon_surface, cairo_surface_destroy);
 	g_free (file_entry);
 }
 
@@ -314,6 +336,7 @@ nemo_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int colu
             GdkPixbuf *icon, *rendered_icon;
             NemoIconInfo *icon_info;
             GList *emblem_icons, *l;
+            gboolean highlighted, shared;
 
 			zoom_level = nemo_list_model_get_zoom_level_from_column_id (column);
 			icon_size = nemo_get_list_icon_size_for_zoom_level (zoom_level);
@@ -344,9 +367,26 @@ nemo_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int colu
 				}
 			}
 
+			highlighted = model->details->highlight_files != NULL &&
+				      g_list_find_custom (model->details->highlight_files,
+							  file, (GCompareFunc) nemo_file_compare_location) != NULL;
+
+			if (file_entry->icon_surface != NULL &&
+			    file_entry->icon_column == column &&
+			    file_entry->icon_scale == icon_scale &&
+			    file_entry->icon_flags == flags &&
+			    file_entry->icon_highlighted == highlighted) {
+				g_value_set_boxed (value, file_entry->icon_surface);
+				break;
+			}
+
             icon_info = nemo_file_get_icon (file, icon_size, 0, icon_scale, flags);
             emblem_icons = nemo_file_get_emblem_icons (file, parent_file);
 
+            /* Thumbnails and emblemed icons are unique to the row */
+            shared = emblem_icons == NULL && !highlighted &&
+                     !nemo_file_has_loaded_thumbnail (file);
+
             if (emblem_icons) {
                 GdkPixbuf *initial_pixbuf;
                 GIcon *gicon, *emblemed_icon, *emblem_icon;
@@ -388,25 +428,55 @@ nemo_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int colu
                 g_object_unref (gicon);
             }
 
-			icon = nemo_icon_info_get_pixbuf_at_size (icon_info, icon_size * icon_scale);
+			surface = NULL;
+			if (shared && model->details->shared_icon_surfaces != NULL) {
+				surface = g_hash_table_lookup (model->details->shared_icon_surfaces, icon_info);
+				if (surface != NULL) {
+					cairo_surface_reference (surface);
+				}
+			}
+
+			if (surface == NULL) {
+				icon = nemo_icon_info_get_pixbuf_at_size (icon_info, icon_size * icon_scale);
 
-			nemo_icon_info_unref (icon_info);
+				if (highlighted) {
+					rendered_icon = eel_create_spotlight_pixbuf (icon);
+
+					if (rendered_icon != NULL) {
+						g_object_unref (icon);
+						icon = rendered_icon;
+					}
+				}
 
-			if (model->details->highlight_files != NULL &&
-			    g_list_find_custom (model->details->highlight_files,
-			                        file, (GCompareFunc) nemo_file_compare_location))
-			{
-				rendered_icon = eel_create_spotlight_pixbuf (icon);
+				surface = gdk_cairo_surface_create_from_pixbuf (icon, icon_scale, NULL);
+				g_object_unref (icon);
+
+				if (shared) {
+					if (model->details->shared_icon_surfaces == NULL) {
+						model->details->shared_icon_surfaces =
+							g_hash_table_new_full (g_direct_hash, g_direct_equal,
+									       (GDestroyNotify) nemo_icon_info_unref,
+									       (GDestroyNotify) cairo_surface_destroy);
+					} else if (g_hash_table_size (model->details->shared_icon_surfaces) >= MAX_SHARED_ICON_SURFACES) {
+						g_hash_table_remove_all (model->details->shared_icon_surfaces);
+					}
 
-				if (rendered_icon != NULL) {
-					g_object_unref (icon);
-					icon = rendered_icon;
+					g_hash_table_insert (model->details->shared_icon_surfaces,
+							     nemo_icon_info_ref (icon_info),
+							     cairo_surface_reference (surface));
 				}
 			}
 
-            surface = gdk_cairo_surface_create_from_pixbuf (icon, icon_scale, NULL);
+			nemo_icon_info_unref (icon_info);
+
+			g_clear_pointer (&file_entry->icon_surface, cairo_surface_destroy);
+			file_entry->icon_surface = cairo_surface_reference (surface);
+			file_entry->icon_column = column;
+			file_entry->icon_scale = icon_scale;
+			file_entry->icon_flags = flags;
+			file_entry->icon_highlighted = highlighted;
+
             g_value_take_boxed (value, surface);
-			g_object_unref (icon);
 		}
 		break;
 	case NEMO_LIST_MODEL_FILE_NAME_IS_EDITABLE_COLUMN:
@@ -753,6 +823,12 @@ nemo_list_model_compare_func (NemoListModel *model,
 	return result;
 }
 
+static NemoFile *
+file_entry_get_file (gpointer data)
+{
+	return ((FileEntry *) data)->file;
+}
+
 static void
 nemo_list_model_sort_file_entries (NemoListModel *model, GSequence *files, GtkTreePath *path)
 {
@@ -763,6 +839,9 @@ nemo_list_model_sort_file_entries (NemoListModel *model, GSequence *files, GtkTr
 	int i;
 	FileEntry *file_entry;
 	gboolean has_iter;
+	NemoFileSortType sort_type;
+	gpointer *entries;
+	int n_entries;
 
 	length = g_sequence_get_length (files);
 
@@ -786,7 +865,38 @@ nemo_list_model_sort_file_entries (NemoListModel *model, GSequence *files, GtkTr
 	}
 
 	/* sort */
-	g_sequence_sort (files, nemo_list_model_file_entry_compare_func, model);
+	sort_type = nemo_file_get_sort_type_for_attribute_q (model->details->sort_attribute);
+	if (sort_type != NEMO_FILE_SORT_NONE) {
+		/* Sort an array on precomputed keys, then move the entries
+		 * into place; moving keeps the persistent iters valid. */
+		entries = g_new (gpointer, length);
+		n_entries = 0;
+
+		/* Dummy rows have no file and always come first */
+		for (i = 0; i < length; ++i) {
+			file_entry = g_sequence_get (old_order[i]);
+			if (file_entry->file == NULL) {
+				g_sequence_move (file_entry->ptr, g_sequence_get_end_iter (files));
+			} else {
+				entries[n_entries++] = file_entry;
+			}
+		}
+
+		nemo_file_sort_items (entries, n_entries, file_entry_get_file, sort_type,
+				      model->details->sort_directories_first,
+				      model->details->sort_favorites_first,
+				      model->details->order == GTK_SORT_DESCENDING,
+				      model->details->view_dir);
+
+		for (i = 0; i < n_entries; ++i) {
+			file_entry = entries[i];
+			g_sequence_move (file_entry->ptr, g_sequence_get_end_iter (files));
+		}
+
+		g_free (entries);
+	} else {
+		g_sequence_sort (files, nemo_list_model_file_entry_compare_func, model);
+	}
 
 	/* generate new order */
 	new_order = g_new (int, length);
@@ -992,18 +1102,73 @@ add_dummy_row (NemoListModel *model, FileEntry *parent_entry)
 	gtk_tree_path_free (path);
 }
 
+static FileEntry *
+file_entry_new (NemoFile *file)
+{
+	FileEntry *file_entry;
+
+	file_entry = g_new0 (FileEntry, 1);
+	file_entry->file = nemo_file_ref (file);
+	file_entry->parent = NULL;
+	file_entry->subdirectory = NULL;
+	file_entry->files = NULL;
+    file_entry->ok_to_show_thumb =
+        nemo_file_get_load_deferred_attrs (file) == NEMO_FILE_LOAD_DEFERRED_ATTRS_PRELOAD;
+
+	return file_entry;
+}
+
+/* Announces a row that was just put in its sequence, and gives
+ * directories their (dummy) child list. */
+static void
+file_entry_inserted (NemoListModel *model,
+		     FileEntry *file_entry,
+		     gboolean replace_dummy)
+{
+	GtkTreeIter iter;
+	GtkTreePath *path;
+
+	iter.stamp = model->details->stamp;
+	iter.user_data = file_entry->ptr;
+
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+	if (replace_dummy) {
+		gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+	} else {
+		gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+	}
+
+    if (nemo_file_is_directory (file_entry->file)) {
+        guint count;
+        gboolean got_count, unreadable;
+
+        file_entry->files = g_sequence_new ((GDestroyNotify)file_entry_free);
+
+        got_count = nemo_file_get_directory_item_count (file_entry->file, &count, &unreadable);
+
+        if ((!got_count && !unreadable) || count > 0) {
+            add_dummy_row (model, file_entry);
+            gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (model),
+                                                  path, &iter);
+        }
+    }
+
+    gtk_tree_path_free (path);
+}
+
 gboolean
 nemo_list_model_add_file (NemoListModel *model, NemoFile *file,
 			      NemoDirectory *directory)
 {
-	GtkTreeIter iter;
-	GtkTreePath *path;
 	FileEntry *file_entry;
 	GSequenceIter *ptr, *parent_ptr;
 	GSequence *files;
 	gboolean replace_dummy;
 	GHashTable *parent_hash;
 
+	/* Inserting needs the rows in order */
+	nemo_list_model_apply_pending_sort (model);
+
 	parent_ptr = g_hash_table_lookup (model->details->directory_reverse_map,
 					  directory);
 	if (parent_ptr) {
@@ -1019,13 +1184,7 @@ nemo_list_model_add_file (NemoListModel *model, NemoFile *file,
 		return FALSE;
 	}
 
-	file_entry = g_new0 (FileEntry, 1);
-	file_entry->file = nemo_file_ref (file);
-	file_entry->parent = NULL;
-	file_entry->subdirectory = NULL;
-	file_entry->files = NULL;
-    file_entry->ok_to_show_thumb =
-        nemo_file_get_load_deferred_attrs (file) == NEMO_FILE_LOAD_DEFERRED_ATTRS_PRELOAD;
+	file_entry = file_entry_new (file);
 	files = model->details->files;
 	parent_hash = model->details->top_reverse_map;
 
@@ -1061,34 +1220,117 @@ nemo_list_model_add_file (NemoListModel *model, NemoFile *file,
 
 	g_hash_table_insert (parent_hash, file, file_entry->ptr);
 
-	iter.stamp = model->details->stamp;
-	iter.user_data = file_entry->ptr;
+	file_entry_inserted (model, file_entry, replace_dummy);
 
-	path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
-	if (replace_dummy) {
-		gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
-	} else {
-		gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+	return TRUE;
+}
+
+static int
+file_entry_compare_indirect (gconstpointer a,
+			     gconstpointer b,
+			     gpointer      user_data)
+{
+	return nemo_list_model_file_entry_compare_func (*(FileEntry * const *) a,
+							*(FileEntry * const *) b,
+							user_data);
+}
+
+/**
+ * nemo_list_model_add_files:
+ * @model: A NemoListModel
+ * @files: (element-type NemoFile): files to add
+ * @directory: The directory the files are in
+ *
+ * Adds many files at once. They are sorted among themselves once and
+ * then merged into the rows already there in a single pass, instead of
+ * each going through g_sequence_insert_sorted(). Files in expanded
+ * subdirectories are added one by one.
+ */
+void
+nemo_list_model_add_files (NemoListModel *model,
+			   GList *files,
+			   NemoDirectory *directory)
+{
+	GPtrArray *entries;
+	GHashTable *seen;
+	FileEntry *file_entry, *existing;
+	GSequenceIter *ptr;
+	NemoFileSortType sort_type;
+	GList *l;
+	guint i, n_rows;
+	gboolean merge;
+
+	nemo_list_model_apply_pending_sort (model);
+
+	if (g_hash_table_lookup (model->details->directory_reverse_map, directory) != NULL) {
+		for (l = files; l != NULL; l = l->next) {
+			nemo_list_model_add_file (model, l->data, directory);
+		}
+		return;
 	}
 
-    if (nemo_file_is_directory (file)) {
-        guint count;
-        gboolean got_count, unreadable;
+	entries = g_ptr_array_sized_new (g_list_length (files));
+	seen = g_hash_table_new (NULL, NULL);
 
-        file_entry->files = g_sequence_new ((GDestroyNotify)file_entry_free);
+	for (l = files; l != NULL; l = l->next) {
+		if (g_hash_table_lookup (model->details->top_reverse_map, l->data) != NULL ||
+		    !g_hash_table_add (seen, l->data)) {
+			g_warning ("file already in tree!!!\n");
+			continue;
+		}
 
-        got_count = nemo_file_get_directory_item_count (file, &count, &unreadable);
+		g_ptr_array_add (entries, file_entry_new (l->data));
+	}
 
-        if ((!got_count && !unreadable) || count > 0) {
-            add_dummy_row (model, file_entry);
-            gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (model),
-                                                  path, &iter);
-        }
-    }
+	g_hash_table_destroy (seen);
 
-    gtk_tree_path_free (path);
+	if (!model->details->temp_unsorted) {
+		sort_type = nemo_file_get_sort_type_for_attribute_q (model->details->sort_attribute);
+		if (sort_type != NEMO_FILE_SORT_NONE) {
+			nemo_file_sort_items (entries->pdata, entries->len, file_entry_get_file, sort_type,
+					      model->details->sort_directories_first,
+					      model->details->sort_favorites_first,
+					      model->details->order == GTK_SORT_DESCENDING,
+					      model->details->view_dir);
+		} else {
+			g_qsort_with_data (entries->pdata, entries->len, sizeof (gpointer),
+					   file_entry_compare_indirect, model);
+		}
+	}
 
-	return TRUE;
+	/* Merge: both runs are sorted, so the insertion point only ever
+	 * moves forward. That walks every row though, so a batch that is
+	 * small next to the model searches for each insertion point. */
+	n_rows = g_sequence_get_length (model->details->files);
+	merge = (guint64) entries->len * g_bit_storage (n_rows) >= n_rows;
+
+	ptr = g_sequence_get_begin_iter (model->details->files);
+
+	for (i = 0; i < entries->len; i++) {
+		file_entry = g_ptr_array_index (entries, i);
+
+		if (model->details->temp_unsorted) {
+			ptr = g_sequence_get_end_iter (model->details->files);
+		} else if (!merge) {
+			ptr = g_sequence_search (model->details->files, file_entry,
+						 nemo_list_model_file_entry_compare_func, model);
+		}
+
+		while (merge && !g_sequence_iter_is_end (ptr)) {
+			existing = g_sequence_get (ptr);
+			if (nemo_list_model_file_entry_compare_func (existing, file_entry, model) > 0) {
+				break;
+			}
+			ptr = g_sequence_iter_next (ptr);
+		}
+
+		file_entry->ptr = g_sequence_insert_before (ptr, file_entry);
+		g_hash_table_insert (model->details->top_reverse_map, file_entry->file, file_entry->ptr);
+
+		file_entry_inserted (model, file_entry, FALSE);
+	}
+
+	g_ptr_array_free (entries, TRUE);
 }
 
 static gboolean
@@ -1135,6 +1377,156 @@ update_dummy_row (NemoListModel *model,
     return changed;
 }
 
+/* Moves the changed rows of one level back into order, then tells the
+ * view with a single rows-reordered. */
+static void
+resort_entries_in_sequence (NemoListModel *model,
+			    GSequence *files,
+			    FileEntry *parent_entry,
+			    GPtrArray *entries)
+{
+	GSequenceIter **old_order, *ptr;
+	GSequence *detached;
+	GtkTreeIter iter;
+	GtkTreePath *path;
+	FileEntry *file_entry;
+	int *new_order;
+	int length, i, position;
+	gboolean moved;
+
+	length = g_sequence_get_length (files);
+
+	old_order = g_new (GSequenceIter *, length);
+	for (ptr = g_sequence_get_begin_iter (files), i = 0;
+	     !g_sequence_iter_is_end (ptr);
+	     ptr = g_sequence_iter_next (ptr), i++) {
+		old_order[i] = ptr;
+	}
+
+	/* Take the changed rows out first, so each one is placed by a
+	 * binary search over rows that are all in order. Moving keeps
+	 * the iters, and with them the view's iters, valid. */
+	detached = g_sequence_new (NULL);
+	for (i = 0; i < (int) entries->len; i++) {
+		file_entry = g_ptr_array_index (entries, i);
+		g_sequence_move (file_entry->ptr, g_sequence_get_end_iter (detached));
+	}
+
+	for (i = 0; i < (int) entries->len; i++) {
+		file_entry = g_ptr_array_index (entries, i);
+		ptr = g_sequence_search (files, file_entry,
+					 nemo_list_model_file_entry_compare_func, model);
+		g_sequence_move (file_entry->ptr, ptr);
+	}
+
+	g_sequence_free (detached);
+
+	/* Note: new_order[newpos] = oldpos */
+	new_order = g_new (int, length);
+	moved = FALSE;
+	for (i = 0; i < length; i++) {
+		position = g_sequence_iter_get_position (old_order[i]);
+		new_order[position] = i;
+		moved |= position != i;
+	}
+
+	if (moved) {
+		if (parent_entry == NULL) {
+			path = gtk_tree_path_new ();
+		} else {
+			nemo_list_model_ptr_to_iter (model, parent_entry->ptr, &iter);
+			path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+		}
+
+		gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model),
+					       path, parent_entry != NULL ? &iter : NULL, new_order);
+		gtk_tree_path_free (path);
+	}
+
+	g_free (old_order);
+	g_free (new_order);
+}
+
+/**
+ * nemo_list_model_apply_pending_sort:
+ * @model: A NemoListModel
+ *
+ * Repositions the rows that changed while sorting was frozen.
+ */
+void
+nemo_list_model_apply_pending_sort (NemoListModel *model)
+{
+	GHashTable *levels;
+	GHashTableIter iter;
+	FileEntry *file_entry;
+	GPtrArray *entries;
+	gpointer key;
+
+	if (model->details->resort_entries == NULL ||
+	    g_hash_table_size (model->details->resort_entries) == 0) {
+		return;
+	}
+
+	/* Parent entry (or the model for the top level) -> changed rows */
+	levels = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+
+	g_hash_table_iter_init (&iter, model->details->resort_entries);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		file_entry = key;
+
+		entries = g_hash_table_lookup (levels, file_entry->parent ? (gpointer) file_entry->parent : model);
+		if (entries == NULL) {
+			entries = g_ptr_array_new ();
+			g_hash_table_insert (levels, file_entry->parent ? (gpointer) file_entry->parent : model, entries);
+		}
+
+		g_ptr_array_add (entries, file_entry);
+	}
+
+	g_hash_table_remove_all (model->details->resort_entries);
+
+	g_hash_table_iter_init (&iter, levels);
+	while (g_hash_table_iter_next (&iter, &key, (gpointer *) &entries)) {
+		if (key == model) {
+			resort_entries_in_sequence (model, model->details->files, NULL, entries);
+		} else {
+			file_entry = key;
+			resort_entries_in_sequence (model, file_entry->files, file_entry, entries);
+		}
+	}
+
+	g_hash_table_destroy (levels);
+}
+
+/**
+ * nemo_list_model_freeze_sort:
+ * @model: A NemoListModel
+ *
+ * Stops nemo_list_model_file_changed() from moving rows one at a time.
+ * Rows that changed are put back in order by one pass in
+ * nemo_list_model_thaw_sort(), with a single rows-reordered per level,
+ * so a burst of changes doesn't reorder the view once per file.
+ */
+void
+nemo_list_model_freeze_sort (NemoListModel *model)
+{
+	if (model->details->resort_entries == NULL) {
+		model->details->resort_entries = g_hash_table_new (NULL, NULL);
+	}
+
+	model->details->sort_frozen++;
+}
+
+void
+nemo_list_model_thaw_sort (NemoListModel *model)
+{
+	g_return_if_fail (model->details->sort_frozen > 0);
+
+	if (--model->details->sort_frozen == 0) {
+		nemo_list_model_apply_pending_sort (model);
+	}
+}
+
 void
 nemo_list_model_file_changed (NemoListModel *model, NemoFile *file,
 				  NemoDirectory *directory)
@@ -1153,12 +1545,20 @@ nemo_list_model_file_changed (NemoListModel *model, NemoFile *file,
 		return;
 	}
 
-	pos_before = g_sequence_iter_get_position (ptr);
+	g_clear_pointer (&((FileEntry *) g_sequence_get (ptr))->icon_surface,
+			 cairo_surface_destroy);
+
+	if (model->details->sort_frozen > 0 && !model->details->temp_unsorted) {
+		g_hash_table_add (model->details->resort_entries, g_sequence_get (ptr));
+		pos_before = pos_after = 0;
+	} else {
+		pos_before = g_sequence_iter_get_position (ptr);
 
-        if (!model->details->temp_unsorted)
-                g_sequence_sort_changed (ptr, nemo_list_model_file_entry_compare_func, model);
+		if (!model->details->temp_unsorted)
+			g_sequence_sort_changed (ptr, nemo_list_model_file_entry_compare_func, model);
 
-	pos_after = g_sequence_iter_get_position (ptr);
+		pos_after = g_sequence_iter_get_position (ptr);
+	}
 
 	if (pos_before != pos_after) {
 		/* The file moved, we need to send rows_reordered */
@@ -1257,6 +1657,10 @@ nemo_list_model_remove (NemoListModel *model, GtkTreeIter *iter)
 
 	}
 
+	if (model->details->resort_entries != NULL) {
+		g_hash_table_remove (model->details->resort_entries, file_entry);
+	}
+
 	if (file_entry->file != NULL) { /* Don't try to remove dummy row */
 		if (file_entry->parent != NULL) {
 			g_hash_table_remove (file_entry->parent->reverse_map, file_entry->file);
@@ -1345,6 +1749,8 @@ nemo_list_model_clear (NemoListModel *model)
 	g_return_if_fail (model != NULL);
 
 	nemo_list_model_clear_directory (model, model->details->files);
+
+	g_clear_pointer (&model->details->shared_icon_surfaces, g_hash_table_destroy);
 }
 
 NemoFile *
@@ -1680,6 +2086,9 @@ nemo_list_model_finalize (GObject *object)
 		model->details->highlight_files = NULL;
 	}
 
+	g_clear_pointer (&model->details->shared_icon_surfaces, g_hash_table_destroy);
+	g_clear_pointer (&model->details->resort_entries, g_hash_table_destroy);
+
 	g_free (model->details);
 
 	G_OBJECT_CLASS (nemo_list_model_parent_class)->finalize (object);
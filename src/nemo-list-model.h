@@ -77,9 +77,15 @@ GType    nemo_list_model_get_type                          (void);
 gboolean nemo_list_model_add_file                          (NemoListModel          *model,
 								NemoFile         *file,
 								NemoDirectory    *directory);
+void     nemo_list_model_add_files                         (NemoListModel          *model,
+								GList            *files,
+								NemoDirectory    *directory);
 void     nemo_list_model_file_changed                      (NemoListModel          *model,
 								NemoFile         *file,
 								NemoDirectory    *directory);
+void     nemo_list_model_freeze_sort                       (NemoListModel          *model);
+void     nemo_list_model_thaw_sort                         (NemoListModel          *model);
+void     nemo_list_model_apply_pending_sort                (NemoListModel          *model);
 gboolean nemo_list_model_is_empty                          (NemoListModel          *model);
 guint    nemo_list_model_get_length                        (NemoListModel          *model);
 void     nemo_list_model_remove_file                       (NemoListModel          *model,
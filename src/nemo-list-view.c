@@ -96,6 +96,13 @@ struct NemoListViewDetails {
     gint ok_to_load_deferred_attrs;
     guint update_visible_icons_id;
 
+    /* Files added during the current batch of file changes, as
+     * NemoDirectory -> GList of NemoFile, see flush_added_files() */
+    GHashTable *added_files;
+    /* The model is detached from the tree view while a bulk load
+     * is spread over several frames, see flush_added_files() */
+    gboolean model_detached;
+
     gboolean rename_on_release;
 	gboolean drag_started;
 	gboolean ignore_button_release;
@@ -2300,7 +2307,7 @@ static void
 prioritize_visible_files (NemoListView *view)
 {
     NemoFile *last_file;
-    // GList *queue_list, *l;
+    GList *visible_files;
     GdkRectangle vrect;
     GtkTreeIter iter;
     GtkTreePath *path;
@@ -2321,6 +2328,7 @@ prioritize_visible_files (NemoListView *view)
     end_y = bin_y + vrect.height + (vrect.height / 2);
 
     last_file = NULL;
+    visible_files = NULL;
     cy = end_y;
 
     // Images that start out un-thumbnailed end up resolving in reverse
@@ -2349,14 +2357,11 @@ prioritize_visible_files (NemoListView *view)
                     nemo_file_set_load_deferred_attrs (file, NEMO_FILE_LOAD_DEFERRED_ATTRS_YES);
                 }
 
-                if (nemo_file_is_thumbnailing (file)) {
-                    gchar *uri = nemo_file_get_uri (file);
-
-                    nemo_thumbnail_prioritize (uri);
-                    g_free (uri);
-                } else {
+                if (!nemo_file_is_thumbnailing (file)) {
                     nemo_file_invalidate_attributes (file, NEMO_FILE_DEFERRED_ATTRIBUTES);
                 }
+
+                visible_files = g_list_prepend (visible_files, nemo_file_ref (file));
             }
 
             nemo_file_unref (file);
@@ -2364,6 +2369,10 @@ prioritize_visible_files (NemoListView *view)
 
         cy -= stepdown;
     }
+
+    /* Collected bottom-up, so the list runs top-down */
+    nemo_thumbnail_update_viewport (view, visible_files);
+    nemo_file_list_free (visible_files);
 }
 
 static gboolean
@@ -2795,19 +2804,113 @@ create_and_set_up_tree_view (NemoListView *view)
 	g_strfreev (default_column_order);
 }
 
+/* Populating an empty model with at least this many rows detaches it
+ * from the tree view, which then builds its tree in one pass when it's
+ * attached again instead of handling a row-inserted per file. The rows
+ * may arrive over several frames, so this counts the files the view
+ * still has waiting too, and the model stays detached until they are
+ * all in. */
+#define BULK_ADD_DETACH_THRESHOLD 1000
+
+static void
+free_added_files (gpointer data)
+{
+	nemo_file_list_free (data);
+}
+
+static void
+attach_model (NemoListView *list_view)
+{
+	if (list_view->details->model_detached) {
+		list_view->details->model_detached = FALSE;
+		gtk_tree_view_set_model (list_view->details->tree_view,
+					 GTK_TREE_MODEL (list_view->details->model));
+	}
+}
+
+static void
+flush_added_files (NemoListView *list_view)
+{
+	GHashTableIter iter;
+	gpointer directory, files;
+	GHashTable *added_files;
+	guint n_files, n_pending;
+
+	added_files = list_view->details->added_files;
+	if (added_files == NULL || g_hash_table_size (added_files) == 0) {
+		return;
+	}
+
+	/* Steal the batch so nothing queued from signal handlers below
+	 * ends up in it. */
+	list_view->details->added_files = NULL;
+
+	n_files = 0;
+	g_hash_table_iter_init (&iter, added_files);
+	while (g_hash_table_iter_next (&iter, NULL, &files)) {
+		n_files += g_list_length (files);
+	}
+
+	n_pending = nemo_view_get_pending_add_count (NEMO_VIEW (list_view));
+
+	if (!list_view->details->model_detached &&
+	    n_files + n_pending >= BULK_ADD_DETACH_THRESHOLD &&
+	    nemo_list_model_is_empty (list_view->details->model)) {
+		list_view->details->model_detached = TRUE;
+		gtk_tree_view_set_model (list_view->details->tree_view, NULL);
+	}
+
+	g_hash_table_iter_init (&iter, added_files);
+	while (g_hash_table_iter_next (&iter, &directory, &files)) {
+		g_hash_table_iter_steal (&iter);
+
+		/* Keep the arrival order for when sorting is disabled */
+		files = g_list_reverse (files);
+		nemo_list_model_add_files (list_view->details->model, files, directory);
+
+		nemo_file_list_free (files);
+		nemo_directory_unref (directory);
+	}
+
+	if (n_pending == 0) {
+		attach_model (list_view);
+	}
+
+	g_hash_table_destroy (added_files);
+}
+
 static void
 nemo_list_view_add_file (NemoView *view, NemoFile *file, NemoDirectory *directory)
 {
-	NemoListModel *model;
+	NemoListView *list_view;
+	GList *files;
 
     if (nemo_file_has_thumbnail_access_problem (file)) {
         nemo_application_set_cache_flag (nemo_application_get_singleton ());
         nemo_window_slot_check_bad_cache_bar (nemo_view_get_nemo_window_slot (view));
     }
 
-	model = NEMO_LIST_VIEW (view)->details->model;
-	nemo_list_model_add_file (model, file, directory);
-    queue_update_visible_icons (NEMO_LIST_VIEW (view), INITIAL_UPDATE_VISIBLE_DELAY);
+	list_view = NEMO_LIST_VIEW (view);
+
+	/* Added files are only handed to the model at the end of the
+	 * batch, or before anything else in it needs their rows. */
+	if (list_view->details->added_files == NULL) {
+		list_view->details->added_files =
+			g_hash_table_new_full (NULL, NULL,
+					       (GDestroyNotify) nemo_directory_unref,
+					       free_added_files);
+	}
+
+	files = g_hash_table_lookup (list_view->details->added_files, directory);
+	if (files == NULL) {
+		nemo_directory_ref (directory);
+	}
+
+	g_hash_table_steal (list_view->details->added_files, directory);
+	g_hash_table_insert (list_view->details->added_files, directory,
+			     g_list_prepend (files, nemo_file_ref (file)));
+
+    queue_update_visible_icons (list_view, INITIAL_UPDATE_VISIBLE_DELAY);
 }
 
 static char **
@@ -3124,6 +3227,8 @@ nemo_list_view_clear (NemoView *view)
         list_view->details->update_visible_icons_id = 0;
     }
 
+    g_clear_pointer (&list_view->details->added_files, g_hash_table_destroy);
+
     tree_selection = gtk_tree_view_get_selection (list_view->details->tree_view);
 
     g_signal_handlers_block_by_func (tree_selection, list_selection_changed_callback, view);
@@ -3133,6 +3238,8 @@ nemo_list_view_clear (NemoView *view)
 		nemo_list_model_clear (list_view->details->model);
 	}
 
+    attach_model (list_view);
+
     g_signal_handlers_unblock_by_func (tree_selection, list_selection_changed_callback, view);
 }
 
@@ -3172,6 +3279,7 @@ nemo_list_view_file_changed (NemoView *view, NemoFile *file, NemoDirectory *dire
 
 	listview = NEMO_LIST_VIEW (view);
 
+	flush_added_files (listview);
 	nemo_list_model_file_changed (listview->details->model, file, directory);
 
 	if (listview->details->renaming_file != NULL &&
@@ -3181,6 +3289,9 @@ nemo_list_view_file_changed (NemoView *view, NemoFile *file, NemoDirectory *dire
 		 * the tree-view changes above could have resorted the list, so
 		 * scroll to the new position
 		 */
+		attach_model (listview);
+		nemo_list_model_apply_pending_sort (listview->details->model);
+
 		if (nemo_list_model_get_tree_iter_from_file (listview->details->model, file, directory, &iter)) {
 			file_path = gtk_tree_model_get_path (GTK_TREE_MODEL (listview->details->model), &iter);
 			gtk_tree_view_scroll_to_cell (listview->details->tree_view,
@@ -3484,6 +3595,13 @@ nemo_list_view_is_empty (NemoView *view)
 	return nemo_list_model_is_empty (NEMO_LIST_VIEW (view)->details->model);
 }
 
+static void
+nemo_list_view_begin_file_changes (NemoView *view)
+{
+	/* Rows that change in this batch are re-sorted together at the end */
+	nemo_list_model_freeze_sort (NEMO_LIST_VIEW (view)->details->model);
+}
+
 static void
 nemo_list_view_end_file_changes (NemoView *view)
 {
@@ -3491,6 +3609,9 @@ nemo_list_view_end_file_changes (NemoView *view)
 
 	list_view = NEMO_LIST_VIEW (view);
 
+	flush_added_files (list_view);
+	nemo_list_model_thaw_sort (list_view->details->model);
+
 	if (list_view->details->new_selection_path) {
 		gtk_tree_view_set_cursor (list_view->details->tree_view,
 					  list_view->details->new_selection_path,
@@ -3517,6 +3638,10 @@ nemo_list_view_remove_file (NemoView *view, NemoFile *file, NemoDirectory *direc
 	list_view = NEMO_LIST_VIEW (view);
 	tree_model = GTK_TREE_MODEL(list_view->details->model);
 
+	flush_added_files (list_view);
+	/* The selection below works on the tree view's rows */
+	attach_model (list_view);
+
 	if (nemo_list_model_get_tree_iter_from_file (list_view->details->model, file, directory, &iter)) {
 		selection = gtk_tree_view_get_selection (list_view->details->tree_view);
 		file_path = gtk_tree_model_get_path (tree_model, &iter);
@@ -4121,6 +4246,10 @@ nemo_list_view_dispose (GObject *object)
     g_signal_handlers_disconnect_by_func (gtk_settings_get_default (), update_date_fonts, list_view);
     g_signal_handlers_disconnect_by_func (nemo_preferences, update_date_fonts, list_view);
 
+    nemo_thumbnail_remove_viewport (list_view);
+
+    g_clear_pointer (&list_view->details->added_files, g_hash_table_destroy);
+
 	if (list_view->details->model) {
 		stop_cell_editing (list_view);
 		g_object_unref (list_view->details->model);
@@ -4279,6 +4408,39 @@ list_view_scroll_to_file (NemoView *view,
 	}
 }
 
+static gboolean
+list_view_is_file_visible (NemoView *view,
+			   NemoFile *file,
+			   NemoDirectory *directory)
+{
+	NemoListView *list_view;
+	GtkTreePath *path, *start_path, *end_path;
+	GtkTreeIter iter;
+	gboolean visible;
+
+	list_view = NEMO_LIST_VIEW (view);
+
+	if (!nemo_list_model_get_tree_iter_from_file (list_view->details->model,
+						      file, directory, &iter)) {
+		return FALSE;
+	}
+
+	if (!gtk_tree_view_get_visible_range (list_view->details->tree_view,
+					      &start_path, &end_path)) {
+		return FALSE;
+	}
+
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (list_view->details->model), &iter);
+	visible = gtk_tree_path_compare (path, start_path) >= 0 &&
+		gtk_tree_path_compare (path, end_path) <= 0;
+
+	gtk_tree_path_free (path);
+	gtk_tree_path_free (start_path);
+	gtk_tree_path_free (end_path);
+
+	return visible;
+}
+
 static void
 list_view_notify_clipboard_info (NemoClipboardMonitor *monitor,
                                  NemoClipboardInfo *info,
@@ -4305,6 +4467,7 @@ nemo_list_view_end_loading (NemoView *view,
 	NemoClipboardMonitor *monitor;
 	NemoClipboardInfo *info;
 
+    attach_model (NEMO_LIST_VIEW (view));
     set_ok_to_load_deferred_attrs (NEMO_LIST_VIEW (view), TRUE);
 
 	monitor = nemo_clipboard_monitor_get ();
@@ -4362,11 +4525,13 @@ nemo_list_view_class_init (NemoListViewClass *class)
 	nemo_view_class->start_renaming_file = nemo_list_view_start_renaming_file;
 	nemo_view_class->get_zoom_level = nemo_list_view_get_zoom_level;
 	nemo_view_class->zoom_to_level = nemo_list_view_zoom_to_level;
+	nemo_view_class->begin_file_changes = nemo_list_view_begin_file_changes;
 	nemo_view_class->end_file_changes = nemo_list_view_end_file_changes;
 	nemo_view_class->using_manual_layout = nemo_list_view_using_manual_layout;
 	nemo_view_class->get_view_id = nemo_list_view_get_id;
 	nemo_view_class->get_first_visible_file = nemo_list_view_get_first_visible_file;
 	nemo_view_class->scroll_to_file = list_view_scroll_to_file;
+	nemo_view_class->is_file_visible = list_view_is_file_visible;
     nemo_view_class->click_to_rename_mode_changed = nemo_list_view_click_to_rename_mode_changed;
 }
 
@@ -933,6 +933,9 @@ nemo_main_application_continue_startup (NemoApplication *app)
 
     g_signal_connect_swapped (nemo_window_state, "changed::" NEMO_WINDOW_STATE_START_WITH_MENU_BAR,
                               G_CALLBACK (menu_state_changed_callback), self);
+
+    /* Copies and moves the last session didn't get to finish */
+    nemo_file_operations_offer_resume (NULL);
 }
 
 static void
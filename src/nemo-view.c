@@ -95,16 +95,10 @@
 #define DEBUG_FLAG NEMO_DEBUG_DIRECTORY_VIEW
 #include <libnemo-private/nemo-debug.h>
 
-/* Minimum starting update inverval */
+/* Delay for updates that aren't paced by the frame clock, and for menu updates */
 #define UPDATE_INTERVAL_MIN 200
-/* Maximum update interval */
-#define UPDATE_INTERVAL_MAX 2000
-/* Amount of miliseconds the update interval is increased */
-#define UPDATE_INTERVAL_INC 250
-/* Interval at which the update interval is increased */
-#define UPDATE_INTERVAL_TIMEOUT_INTERVAL 500
-/* Milliseconds that have to pass without a change to reset the update interval */
-#define UPDATE_INTERVAL_RESET 1000
+/* Milliseconds per frame that may be spent showing pending files */
+#define UPDATE_FRAME_BUDGET 8
 
 #define SILENT_WINDOW_OPEN_LIMIT 5
 
@@ -222,10 +216,7 @@ struct NemoViewDetails
 	guint reveal_selection_idle_id;
 
 	guint display_pending_source_id;
-	guint changes_timeout_id;
-
-	guint update_interval;
- 	guint64 last_queued;
+	guint display_pending_tick_id;
 
 	guint files_added_handler_id;
 	guint files_changed_handler_id;
@@ -241,7 +232,13 @@ struct NemoViewDetails
 	GHashTable *non_ready_files;
 
 	GList *old_added_files;
+	guint n_old_added_files;
 	GList *old_changed_files;
+	/* Whether old_changed_files was searched for files on screen
+	 * since files were last added to it */
+	gboolean old_changed_files_scanned;
+	/* What END_FILE_CHANGES took per added file last time, in us */
+	gint64 end_changes_cost;
 
 	GList *pending_selection;
 
@@ -341,8 +338,8 @@ static void     schedule_update_menus_callback                 (gpointer
 static void     remove_update_menus_timeout_callback           (NemoView      *view);
 static void     schedule_update_status                          (NemoView      *view);
 static void     remove_update_status_idle_callback             (NemoView *view);
-static void     reset_update_interval                          (NemoView      *view);
 static void     schedule_idle_display_of_pending_files         (NemoView      *view);
+static void     schedule_display_of_pending_files              (NemoView      *view);
 static void     unschedule_display_of_pending_files            (NemoView      *view);
 static void     disconnect_model_handlers                      (NemoView      *view);
 static void     metadata_for_directory_as_file_ready_callback  (NemoFile         *file,
@@ -3333,7 +3330,6 @@ done_loading (NemoView *view,
 
 		schedule_update_menus (view);
 		schedule_update_status (view);
-		reset_update_interval (view);
 
 		selection = view->details->pending_selection;
 		if (selection != NULL && all_files_seen) {
@@ -3639,16 +3635,61 @@ sort_files (NemoView *view, GList **list)
 
 }
 
+/* Sorts @files and merges them into the already sorted @list, so a
+ * backlog left over from earlier frames isn't sorted again.
+ */
+static GList *
+merge_files (NemoView *view, GList *list, GList *files)
+{
+	GList *result, *last, *node;
+
+	sort_files (view, &files);
+
+	result = last = NULL;
+	while (list != NULL && files != NULL) {
+		if (compare_files_cover (list->data, files->data, view) <= 0) {
+			node = list;
+			list = list->next;
+		} else {
+			node = files;
+			files = files->next;
+		}
+
+		node->prev = last;
+		node->next = NULL;
+		if (last != NULL) {
+			last->next = node;
+		} else {
+			result = node;
+		}
+		last = node;
+	}
+
+	/* One of them ran out, the other one is sorted already */
+	node = list != NULL ? list : files;
+	if (node != NULL) {
+		node->prev = last;
+		if (last != NULL) {
+			last->next = node;
+		} else {
+			result = node;
+		}
+	}
+
+	return result;
+}
+
 /* Go through all the new added and changed files.
  * Put any that are not ready to load in the non_ready_files hash table.
- * Add all the rest to the old_added_files and old_changed_files lists.
- * Sort the old_*_files lists if anything was added to them.
+ * Add all the rest to the old_added_files and old_changed_files lists,
+ * keeping those sorted.
  */
 static void
 process_new_files (NemoView *view)
 {
 	GList *new_added_files, *new_changed_files, *old_added_files, *old_changed_files;
 	GHashTable *non_ready_files;
+	guint n_old_added;
 	GList *node, *next;
 	FileAndDirectory *pending;
 	gboolean in_non_ready;
@@ -3660,8 +3701,9 @@ process_new_files (NemoView *view)
 
 	non_ready_files = view->details->non_ready_files;
 
-	old_added_files = view->details->old_added_files;
-	old_changed_files = view->details->old_changed_files;
+	old_added_files = NULL;
+	old_changed_files = NULL;
+	n_old_added = 0;
 
 	/* Newly added files go into the old_added_files list if they're
 	 * ready, and into the hash table if they're not.
@@ -3677,6 +3719,7 @@ process_new_files (NemoView *view)
 				}
 				new_added_files = g_list_delete_link (new_added_files, node);
 				old_added_files = g_list_prepend (old_added_files, pending);
+				n_old_added++;
 			} else {
 				if (!in_non_ready) {
 					new_added_files = g_list_delete_link (new_added_files, node);
@@ -3701,6 +3744,7 @@ process_new_files (NemoView *view)
 				if (still_should_show_file (view, pending->file, pending->directory)) {
 					new_changed_files = g_list_delete_link (new_changed_files, node);
 					old_added_files = g_list_prepend (old_added_files, pending);
+					n_old_added++;
 				}
 			} else if (nemo_view_should_show_file (view, pending->file)) {
 				new_changed_files = g_list_delete_link (new_changed_files, node);
@@ -3710,29 +3754,73 @@ process_new_files (NemoView *view)
 	}
 	file_and_directory_list_free (new_changed_files);
 
-	/* If any files were added to old_added_files, then resort it. */
-	if (old_added_files != view->details->old_added_files) {
-		view->details->old_added_files = old_added_files;
-		sort_files (view, &view->details->old_added_files);
+	if (old_added_files != NULL) {
+		view->details->old_added_files =
+			merge_files (view, view->details->old_added_files, old_added_files);
+		view->details->n_old_added_files += n_old_added;
 	}
 
-	/* Resort old_changed_files too, since file attributes
-	 * relevant to sorting could have changed.
+	/* Changed files are sorted on their new attributes, the ones
+	 * already waiting keep their place.
 	 */
-	if (old_changed_files != view->details->old_changed_files) {
-		view->details->old_changed_files = old_changed_files;
-		sort_files (view, &view->details->old_changed_files);
+	if (old_changed_files != NULL) {
+		view->details->old_changed_files =
+			merge_files (view, view->details->old_changed_files, old_changed_files);
+		view->details->old_changed_files_scanned = FALSE;
 	}
 
 }
 
+static gboolean
+out_of_time (gint64 deadline)
+{
+	return deadline != 0 && g_get_monotonic_time () >= deadline;
+}
+
+/* Subclasses may only queue added files and show them all at
+ * END_FILE_CHANGES, so leave room for that in the frame too.
+ */
+static gboolean
+adding_out_of_time (NemoView *view, gint64 deadline, guint n_added)
+{
+	return deadline != 0 &&
+		g_get_monotonic_time () + (n_added + 1) * view->details->end_changes_cost >= deadline;
+}
+
+static gboolean
+file_is_visible (NemoView *view, FileAndDirectory *pending)
+{
+	NemoViewClass *klass;
+
+	klass = NEMO_VIEW_CLASS (G_OBJECT_GET_CLASS (view));
+
+	return klass->is_file_visible != NULL &&
+		klass->is_file_visible (view, pending->file, pending->directory);
+}
+
 static void
-process_old_files (NemoView *view)
+emit_file_changed (NemoView *view, FileAndDirectory *pending)
+{
+	g_signal_emit (view,
+		       signals[still_should_show_file (view, pending->file, pending->directory)
+			       ? FILE_CHANGED : REMOVE_FILE], 0,
+		       pending->file, pending->directory);
+}
+
+/* Hand the ready files over to the subclass. With a @deadline, stop
+ * once it has passed and leave the rest for later; changes to files on
+ * screen go first then, and the others wait behind the additions.
+ * Returns TRUE if nothing is left.
+ */
+static gboolean
+process_old_files (NemoView *view, gint64 deadline)
 {
-	GList *files_added, *files_changed, *node;
+	GList *files_added, *files_changed, *changed_done, *node, *next;
 	FileAndDirectory *pending;
 	GList *selection, *files;
 	gboolean send_selection_change;
+	guint n_done, n_added;
+	gint64 end_changes_start;
 
 	files_added = view->details->old_added_files;
 	files_changed = view->details->old_changed_files;
@@ -3740,38 +3828,74 @@ process_old_files (NemoView *view)
 	send_selection_change = FALSE;
 
 	if (files_added != NULL || files_changed != NULL) {
+		changed_done = NULL;
+		n_done = 0;
+		n_added = 0;
+
 		g_signal_emit (view, signals[BEGIN_FILE_CHANGES], 0);
 
-		for (node = files_added; node != NULL; node = node->next) {
+		/* Once per batch, the other frames get the files on screen
+		 * out of the way at the start already */
+		if (deadline != 0 && !view->details->old_changed_files_scanned) {
+			for (node = files_changed; node != NULL && !out_of_time (deadline); node = next) {
+				next = node->next;
+				if (file_is_visible (view, node->data)) {
+					emit_file_changed (view, node->data);
+					files_changed = g_list_remove_link (files_changed, node);
+					changed_done = g_list_concat (node, changed_done);
+					n_done++;
+				}
+			}
+			view->details->old_changed_files_scanned = node == NULL;
+		}
+
+		/* Always get at least one file through, however slow */
+		while (files_added != NULL &&
+		       (n_done == 0 || !adding_out_of_time (view, deadline, n_added))) {
+			node = files_added;
+			files_added = g_list_remove_link (files_added, node);
+
 			pending = node->data;
 			g_signal_emit (view,
 				       signals[ADD_FILE], 0, pending->file, pending->directory);
+			file_and_directory_list_free (node);
+			n_done++;
+			n_added++;
+			view->details->n_old_added_files--;
 		}
 
-		for (node = files_changed; node != NULL; node = node->next) {
-			pending = node->data;
-			g_signal_emit (view,
-				       signals[still_should_show_file (view, pending->file, pending->directory)
-					       ? FILE_CHANGED : REMOVE_FILE], 0,
-				       pending->file, pending->directory);
+		while (files_changed != NULL &&
+		       (n_done == 0 || !adding_out_of_time (view, deadline, n_added))) {
+			node = files_changed;
+			files_changed = g_list_remove_link (files_changed, node);
+
+			emit_file_changed (view, node->data);
+			changed_done = g_list_concat (node, changed_done);
+			n_done++;
 		}
 
+		end_changes_start = g_get_monotonic_time ();
 		g_signal_emit (view, signals[END_FILE_CHANGES], 0);
 
-		if (files_changed != NULL) {
+		if (n_added > 0) {
+			view->details->end_changes_cost =
+				(view->details->end_changes_cost +
+				 (g_get_monotonic_time () - end_changes_start) / n_added) / 2;
+		}
+
+		if (changed_done != NULL) {
 			selection = nemo_view_get_selection (view);
-			files = file_and_directory_list_to_files (files_changed);
+			files = file_and_directory_list_to_files (changed_done);
 			send_selection_change = eel_g_lists_sort_and_check_for_intersection
 				(&files, &selection);
 			nemo_file_list_free (files);
 			nemo_file_list_free (selection);
 		}
 
-		file_and_directory_list_free (view->details->old_added_files);
-		view->details->old_added_files = NULL;
+		file_and_directory_list_free (changed_done);
 
-		file_and_directory_list_free (view->details->old_changed_files);
-		view->details->old_changed_files = NULL;
+		view->details->old_added_files = files_added;
+		view->details->old_changed_files = files_changed;
 	}
 
 	if (send_selection_change) {
@@ -3780,25 +3904,33 @@ process_old_files (NemoView *view)
 		 */
 		nemo_view_send_selection_change (view);
 	}
+
+	return view->details->old_added_files == NULL &&
+		view->details->old_changed_files == NULL;
 }
 
-static void
-display_pending_files (NemoView *view)
+/* Returns FALSE if files are left over because @deadline passed. */
+static gboolean
+display_pending_files (NemoView *view, gint64 deadline)
 {
+	gboolean done;
 
 	/* Don't dispatch any updates while the view is frozen. */
 	if (view->details->updates_frozen) {
-		return;
+		return TRUE;
 	}
 
 	process_new_files (view);
-	process_old_files (view);
+	done = process_old_files (view, deadline);
 
-	if (view->details->model != NULL
+	if (done
+	    && view->details->model != NULL
 	    && nemo_directory_are_all_files_seen (view->details->model)
 	    && g_hash_table_size (view->details->non_ready_files) == 0) {
 		done_loading (view, TRUE);
 	}
+
+	return done;
 }
 
 void
@@ -3880,6 +4012,17 @@ update_menus_timeout_callback (gpointer data)
 	return FALSE;
 }
 
+static gint64
+get_display_deadline (NemoView *view)
+{
+	/* Nothing to keep responsive while the view isn't shown */
+	if (!gtk_widget_get_mapped (GTK_WIDGET (view))) {
+		return 0;
+	}
+
+	return g_get_monotonic_time () + UPDATE_FRAME_BUDGET * 1000;
+}
+
 static gboolean
 display_pending_callback (gpointer data)
 {
@@ -3891,13 +4034,37 @@ display_pending_callback (gpointer data)
 
 	view->details->display_pending_source_id = 0;
 
-	display_pending_files (view);
+	if (!display_pending_files (view, get_display_deadline (view))) {
+		schedule_display_of_pending_files (view);
+	}
 
 	g_object_unref (G_OBJECT (view));
 
 	return FALSE;
 }
 
+static gboolean
+display_pending_tick_callback (GtkWidget *widget,
+			       GdkFrameClock *frame_clock,
+			       gpointer data)
+{
+	NemoView *view;
+
+	view = NEMO_VIEW (widget);
+
+	g_object_ref (G_OBJECT (view));
+
+	view->details->display_pending_tick_id = 0;
+
+	if (!display_pending_files (view, get_display_deadline (view))) {
+		schedule_display_of_pending_files (view);
+	}
+
+	g_object_unref (G_OBJECT (view));
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
 schedule_idle_display_of_pending_files (NemoView *view)
 {
@@ -3916,7 +4083,8 @@ static void
 schedule_timeout_display_of_pending_files (NemoView *view, guint interval)
 {
  	/* No need to schedule an update if there's already one pending. */
-	if (view->details->display_pending_source_id != 0) {
+	if (view->details->display_pending_source_id != 0 ||
+	    view->details->display_pending_tick_id != 0) {
  		return;
 	}
 
@@ -3924,6 +4092,29 @@ schedule_timeout_display_of_pending_files (NemoView *view, guint interval)
 		g_timeout_add (interval, display_pending_callback, view);
 }
 
+/* Show pending files at the next frame, at most UPDATE_FRAME_BUDGET
+ * milliseconds' worth of them per frame, however fast they come in.
+ */
+static void
+schedule_display_of_pending_files (NemoView *view)
+{
+	if (view->details->display_pending_source_id != 0 ||
+	    view->details->display_pending_tick_id != 0) {
+		return;
+	}
+
+	/* There are no frames while the view isn't shown */
+	if (!gtk_widget_get_mapped (GTK_WIDGET (view))) {
+		schedule_timeout_display_of_pending_files (view, UPDATE_INTERVAL_MIN);
+		return;
+	}
+
+	view->details->display_pending_tick_id =
+		gtk_widget_add_tick_callback (GTK_WIDGET (view),
+					      display_pending_tick_callback,
+					      NULL, NULL);
+}
+
 static void
 unschedule_display_of_pending_files (NemoView *view)
 {
@@ -3932,6 +4123,12 @@ unschedule_display_of_pending_files (NemoView *view)
 		g_source_remove (view->details->display_pending_source_id);
 		view->details->display_pending_source_id = 0;
 	}
+
+	if (view->details->display_pending_tick_id != 0) {
+		gtk_widget_remove_tick_callback (GTK_WIDGET (view),
+						 view->details->display_pending_tick_id);
+		view->details->display_pending_tick_id = 0;
+	}
 }
 
 static void
@@ -3963,75 +4160,7 @@ queue_pending_files (NemoView *view,
 	*pending_list = g_list_concat (file_and_directory_list_from_files (directory, files),
 				       *pending_list);
 
-    schedule_timeout_display_of_pending_files (view, view->details->update_interval);
-}
-
-static void
-remove_changes_timeout_callback (NemoView *view)
-{
-	if (view->details->changes_timeout_id != 0) {
-		g_source_remove (view->details->changes_timeout_id);
-		view->details->changes_timeout_id = 0;
-	}
-}
-
-static void
-reset_update_interval (NemoView *view)
-{
-	view->details->update_interval = UPDATE_INTERVAL_MIN;
-	remove_changes_timeout_callback (view);
-	/* Reschedule a pending timeout to idle */
-	if (view->details->display_pending_source_id != 0) {
-		schedule_idle_display_of_pending_files (view);
-	}
-}
-
-static gboolean
-changes_timeout_callback (gpointer data)
-{
-	gint64 now;
-	gint64 time_delta;
-	gboolean ret;
-	NemoView *view;
-	view = NEMO_VIEW (data);
-
-	g_object_ref (G_OBJECT (view));
-
-	now = g_get_monotonic_time ();
-	time_delta = now - view->details->last_queued;
-
-	if (time_delta < UPDATE_INTERVAL_RESET*1000) {
-		if (view->details->update_interval < UPDATE_INTERVAL_MAX &&
-		    view->details->loading) {
-			/* Increase */
-			view->details->update_interval += UPDATE_INTERVAL_INC;
-		}
-		ret = TRUE;
-	} else {
-		/* Reset */
-		reset_update_interval (view);
-		ret = FALSE;
-	}
-
-	g_object_unref (G_OBJECT (view));
-
-	return ret;
-}
-
-static void
-schedule_changes (NemoView *view)
-{
-	/* Remember when the change was queued */
-	view->details->last_queued = g_get_monotonic_time ();
-
-	/* No need to schedule if there are already changes pending or during loading */
-	if (view->details->changes_timeout_id != 0 ||
-	    view->details->loading) {
-		return;
-	}
-
-	view->details->changes_timeout_id =
-		g_timeout_add (UPDATE_INTERVAL_TIMEOUT_INTERVAL, changes_timeout_callback, view);
+	schedule_display_of_pending_files (view);
 }
 
 static void
@@ -4051,8 +4180,6 @@ files_added_callback (NemoDirectory *directory,
 		     window, uri ? uri : "(no directory)");
 	g_free (uri);
 
-	schedule_changes (view);
-
 	queue_pending_files (view, directory, files, &view->details->new_added_files);
 
 	/* The number of items could have changed */
@@ -4076,8 +4203,6 @@ files_changed_callback (NemoDirectory *directory,
 		     window, uri ? uri : "(no directory)");
 	g_free (uri);
 
-	schedule_changes (view);
-
 	queue_pending_files (view, directory, files, &view->details->new_changed_files);
 
 	/* The free space or the number of items could have changed */
@@ -4221,6 +4346,14 @@ nemo_view_get_loading (NemoView *view)
 	return view->details->loading;
 }
 
+guint
+nemo_view_get_pending_add_count (NemoView *view)
+{
+	g_return_val_if_fail (NEMO_IS_VIEW (view), 0);
+
+	return view->details->n_old_added_files;
+}
+
 GtkUIManager *
 nemo_view_get_ui_manager (NemoView  *view)
 {
@@ -10279,7 +10412,7 @@ schedule_update_menus (NemoView *view)
 {
     g_assert (NEMO_IS_VIEW (view));
 
-    real_schedule_update_menus (view, view->details->update_interval);
+    real_schedule_update_menus (view, UPDATE_INTERVAL_MIN);
 }
 
 static void
@@ -10389,8 +10522,6 @@ file_changed_callback (NemoFile *file, gpointer callback_data)
 {
 	NemoView *view = NEMO_VIEW (callback_data);
 
-	schedule_changes (view);
-
 	schedule_update_menus (view);
 	schedule_update_status (view);
 }
@@ -10666,7 +10797,6 @@ nemo_view_stop_loading (NemoView *view)
     }
 
 	unschedule_display_of_pending_files (view);
-	reset_update_interval (view);
 
 	/* Free extra undisplayed files */
 	file_and_directory_list_free (view->details->new_added_files);
@@ -10679,6 +10809,7 @@ nemo_view_stop_loading (NemoView *view)
 
 	file_and_directory_list_free (view->details->old_added_files);
 	view->details->old_added_files = NULL;
+	view->details->n_old_added_files = 0;
 
 	file_and_directory_list_free (view->details->old_changed_files);
 	view->details->old_changed_files = NULL;
@@ -11035,6 +11166,23 @@ nemo_view_scroll_event (GtkWidget *widget,
 }
 
 
+static void
+nemo_view_unmap (GtkWidget *widget)
+{
+	NemoView *view;
+
+	view = NEMO_VIEW (widget);
+
+	/* The frame clock stops for hidden widgets, don't leave pending
+	 * files waiting on it. */
+	if (view->details->display_pending_tick_id != 0) {
+		unschedule_display_of_pending_files (view);
+		schedule_timeout_display_of_pending_files (view, UPDATE_INTERVAL_MIN);
+	}
+
+	GTK_WIDGET_CLASS (parent_class)->unmap (widget);
+}
+
 static void
 nemo_view_parent_set (GtkWidget *widget,
 			  GtkWidget *old_parent)
@@ -11085,6 +11233,7 @@ nemo_view_class_init (NemoViewClass *klass)
 	widget_class->destroy = nemo_view_destroy;
 	widget_class->scroll_event = nemo_view_scroll_event;
 	widget_class->parent_set = nemo_view_parent_set;
+	widget_class->unmap = nemo_view_unmap;
 
 	g_type_class_add_private (klass, sizeof (NemoViewDetails));
 
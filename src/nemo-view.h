@@ -312,6 +312,12 @@ struct NemoViewClass {
 	void           (* scroll_to_file)	  (NemoView          *view,
 						   const char            *uri);
 
+	/* Whether the file is on screen, or close to it. Optional; pending
+	   changes to such files are shown before others. */
+	gboolean       (* is_file_visible)	  (NemoView          *view,
+						   NemoFile          *file,
+						   NemoDirectory     *directory);
+
         /* Signals used only for keybindings */
         gboolean (* trash)                         (NemoView *view);
         gboolean (* delete)                        (NemoView *view);
@@ -354,6 +360,8 @@ void                nemo_view_stop_batching_selection_changes  (NemoView  *view)
 void                nemo_view_notify_selection_changed         (NemoView  *view);
 GtkUIManager *      nemo_view_get_ui_manager                   (NemoView  *view);
 NemoDirectory  *nemo_view_get_model                        (NemoView  *view);
+/* Files waiting for a later frame to be handed to add_file */
+guint           nemo_view_get_pending_add_count            (NemoView  *view);
 NemoFile       *nemo_view_get_directory_as_file            (NemoView  *view);
 void            nemo_view_update_actions_and_extensions        (NemoView *view);
 
@@ -0,0 +1,125 @@
+#include <config.h>
+#include <gtk/gtk.h>
+#include <libnemo-private/nemo-directory.h>
+#include <libnemo-private/nemo-file-private.h>
+#include <stdlib.h>
+
+/* mallinfo2 () first shipped in glibc 2.33 */
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#define HAVE_MALLINFO2 1
+#include <malloc.h>
+#endif
+
+/* Reports how much memory a directory's worth of NemoFiles costs.
+ * Run with an optional file count, e.g. test-nemo-file-memory 200000.
+ */
+
+#define DEFAULT_FILE_COUNT 100000
+
+/* Tells meson the benchmark was skipped rather than failed */
+#define EXIT_SKIP 77
+
+#ifdef HAVE_MALLINFO2
+static size_t
+get_heap_in_use (void)
+{
+	struct mallinfo2 info;
+
+	info = mallinfo2 ();
+
+	return info.uordblks + info.hblkhd;
+}
+
+static GFileInfo *
+make_info (guint i)
+{
+	GFileInfo *info;
+	char *name;
+
+	name = g_strdup_printf ("file-%06u.txt", i);
+
+	info = g_file_info_new ();
+	g_file_info_set_name (info, name);
+	g_file_info_set_display_name (info, name);
+	g_file_info_set_file_type (info, G_FILE_TYPE_REGULAR);
+	g_file_info_set_size (info, i * 512);
+	g_file_info_set_content_type (info, "text/plain");
+	g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_MODE, 0100644);
+	g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_UID, 1000);
+	g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_GID, 1000);
+	g_file_info_set_attribute_string (info, G_FILE_ATTRIBUTE_OWNER_USER, "user");
+	g_file_info_set_attribute_string (info, G_FILE_ATTRIBUTE_OWNER_GROUP, "users");
+	g_file_info_set_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED, 1500000000 + i);
+
+	g_free (name);
+
+	return info;
+}
+
+int
+main (int argc, char **argv)
+{
+	NemoDirectory *directory;
+	NemoFile **files;
+	GFileInfo *info;
+	size_t before, after;
+	gint64 start, elapsed;
+	guint n_files, i;
+
+	if (!gtk_init_check (&argc, &argv)) {
+		g_print ("No display available, skipping\n");
+		return EXIT_SKIP;
+	}
+
+	n_files = DEFAULT_FILE_COUNT;
+	if (argc > 1) {
+		n_files = (guint) strtoul (argv[1], NULL, 10);
+	}
+
+	directory = nemo_directory_get_by_uri ("file:///tmp");
+	files = g_new (NemoFile *, n_files);
+
+	before = get_heap_in_use ();
+	start = g_get_monotonic_time ();
+
+	for (i = 0; i < n_files; i++) {
+		info = make_info (i);
+		files[i] = nemo_file_new_from_info (directory, info);
+		g_object_unref (info);
+	}
+
+	elapsed = g_get_monotonic_time () - start;
+	after = get_heap_in_use ();
+
+	g_print ("sizeof (NemoFileDetails): %" G_GSIZE_FORMAT " bytes\n",
+		 sizeof (NemoFileDetails));
+	g_print ("sizeof (NemoFileRareDetails): %" G_GSIZE_FORMAT " bytes\n",
+		 sizeof (NemoFileRareDetails));
+	g_print ("files created: %u in %" G_GINT64_FORMAT " ms\n",
+		 n_files, elapsed / 1000);
+
+	if (after > before && n_files > 0) {
+		g_print ("heap per file: %" G_GSIZE_FORMAT " bytes\n",
+			 (after - before) / n_files);
+	}
+
+	for (i = 0; i < n_files; i++) {
+		nemo_file_unref (files[i]);
+	}
+	g_free (files);
+	nemo_directory_unref (directory);
+
+	return 0;
+}
+
+#else
+
+int
+main (int argc, char **argv)
+{
+	g_print ("mallinfo2 () is not available, skipping\n");
+
+	return EXIT_SKIP;
+}
+
+#endif /* HAVE_MALLINFO2 */